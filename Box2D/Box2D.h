@@ -32,6 +32,7 @@ For discussion please visit http://box2d.org/forum
 // These include files constitute the main Box2D API
 
 #include <Common/b2Settings.h>
+#include <Common/b2Allocator.h>
 #include <Common/b2Draw.h>
 #include <Common/b2Timer.h>
 
@@ -39,6 +40,7 @@ For discussion please visit http://box2d.org/forum
 #include <Collision/Shapes/b2EdgeShape.h>
 #include <Collision/Shapes/b2ChainShape.h>
 #include <Collision/Shapes/b2PolygonShape.h>
+#include <Collision/Shapes/b2CapsuleShape.h>
 
 #include <Collision/b2BroadPhase.h>
 #include <Collision/b2Distance.h>
@@ -47,6 +49,8 @@ For discussion please visit http://box2d.org/forum
 
 #include <Dynamics/b2Body.h>
 #include <Dynamics/b2Fixture.h>
+#include <Dynamics/b2Id.h>
+#include <Dynamics/b2Scene.h>
 #include <Dynamics/b2WorldCallbacks.h>
 #include <Dynamics/b2TimeStep.h>
 #include <Dynamics/b2World.h>
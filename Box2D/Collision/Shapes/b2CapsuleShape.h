@@ -0,0 +1,68 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_CAPSULE_SHAPE_H
+#define B2_CAPSULE_SHAPE_H
+
+#include <Collision/Shapes/b2Shape.h>
+
+/// A capsule is a line segment with a radius. It is the set of points
+/// within the radius of the segment, so the ends are half circles. Capsules
+/// are much cheaper to collide than polygons approximating rounded parts.
+class b2CapsuleShape : public b2Shape
+{
+public:
+	b2CapsuleShape();
+
+	/// Set the core segment and radius. The segment must be longer than b2_linearSlop.
+	/// Use a circle shape if you need a disc.
+	void Set(const b2Vec2& v1, const b2Vec2& v2, float32 radius);
+
+	/// Implement b2Shape.
+	b2Shape* Clone(b2BlockAllocator* allocator) const;
+
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const;
+
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const;
+
+	/// Implement b2Shape.
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+				const b2Transform& transform, int32 childIndex) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const;
+
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// These are the segment vertices. They must stay adjacent, the distance
+	/// proxy reads them as an array.
+	b2Vec2 m_vertex1, m_vertex2;
+};
+
+inline b2CapsuleShape::b2CapsuleShape()
+{
+	m_type = e_capsule;
+	m_radius = 0.0f;
+	m_vertex1.SetZero();
+	m_vertex2.SetZero();
+}
+
+#endif
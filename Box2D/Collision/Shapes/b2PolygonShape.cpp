@@ -39,6 +39,7 @@ void b2PolygonShape::SetAsBox(float32 hx, float32 hy)
 	m_normals[2].Set(0.0f, 1.0f);
 	m_normals[3].Set(-1.0f, 0.0f);
 	m_centroid.SetZero();
+	ComputeBox();
 }
 
 void b2PolygonShape::SetAsBox(float32 hx, float32 hy, const b2Vec2& center, float32 angle)
@@ -64,6 +65,8 @@ void b2PolygonShape::SetAsBox(float32 hx, float32 hy, const b2Vec2& center, floa
 		m_vertices[i] = b2Mul(xf, m_vertices[i]);
 		m_normals[i] = b2Mul(xf.q, m_normals[i]);
 	}
+
+	ComputeBox();
 }
 
 int32 b2PolygonShape::GetChildCount() const
@@ -238,12 +241,51 @@ void b2PolygonShape::Set(const b2Vec2* vertices, int32 count)
 
 	// Compute the polygon centroid.
 	m_centroid = ComputeCentroid(m_vertices, m);
+
+	ComputeBox();
+}
+
+void b2PolygonShape::ComputeBox()
+{
+	m_isBox = false;
+
+	if (m_count != 4)
+	{
+		return;
+	}
+
+	// Every edge must be exactly horizontal or vertical.
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		int32 i2 = i + 1 < m_count ? i + 1 : 0;
+		b2Vec2 edge = m_vertices[i2] - m_vertices[i];
+		if ((edge.x == 0.0f) == (edge.y == 0.0f))
+		{
+			return;
+		}
+	}
+
+	m_box.lowerBound = m_vertices[0];
+	m_box.upperBound = m_vertices[0];
+	for (int32 i = 1; i < m_count; ++i)
+	{
+		m_box.lowerBound = b2Min(m_box.lowerBound, m_vertices[i]);
+		m_box.upperBound = b2Max(m_box.upperBound, m_vertices[i]);
+	}
+
+	m_isBox = true;
 }
 
 bool b2PolygonShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
 {
 	b2Vec2 pLocal = b2MulT(xf.q, p - xf.p);
 
+	if (m_isBox)
+	{
+		return m_box.lowerBound.x <= pLocal.x && pLocal.x <= m_box.upperBound.x &&
+			   m_box.lowerBound.y <= pLocal.y && pLocal.y <= m_box.upperBound.y;
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		float32 dot = b2Dot(m_normals[i], pLocal - m_vertices[i]);
@@ -264,6 +306,26 @@ bool b2PolygonShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& inpu
 	// Put the ray into the polygon's frame of reference.
 	b2Vec2 p1 = b2MulT(xf.q, input.p1 - xf.p);
 	b2Vec2 p2 = b2MulT(xf.q, input.p2 - xf.p);
+
+	// Boxes use a slab test against the local bounds.
+	if (m_isBox)
+	{
+		b2RayCastInput localInput;
+		localInput.p1 = p1;
+		localInput.p2 = p2;
+		localInput.maxFraction = input.maxFraction;
+
+		b2RayCastOutput localOutput;
+		if (m_box.RayCast(&localOutput, localInput) == false)
+		{
+			return false;
+		}
+
+		output->fraction = localOutput.fraction;
+		output->normal = b2Mul(xf.q, localOutput.normal);
+		return true;
+	}
+
 	b2Vec2 d = p2 - p1;
 
 	float32 lower = 0.0f, upper = input.maxFraction;
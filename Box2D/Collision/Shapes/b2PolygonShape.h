@@ -78,10 +78,21 @@ public:
 	/// @returns true if valid
 	bool Validate() const;
 
+	/// Detect if the polygon is a rectangle whose edges are parallel to the local axes.
+	/// Set and SetAsBox call this, so you only need it after editing the vertices directly.
+	void ComputeBox();
+
 	b2Vec2 m_centroid;
 	b2Vec2 m_vertices[b2_maxPolygonVertices];
 	b2Vec2 m_normals[b2_maxPolygonVertices];
 	int32 m_count;
+
+	/// True if this polygon is a rectangle aligned with the local axes. Boxes use
+	/// dedicated collision and ray cast routines.
+	bool m_isBox;
+
+	/// The local bounds of the box. Only valid if m_isBox is true.
+	b2AABB m_box;
 };
 
 inline b2PolygonShape::b2PolygonShape()
@@ -90,6 +101,7 @@ inline b2PolygonShape::b2PolygonShape()
 	m_radius = b2_polygonRadius;
 	m_count = 0;
 	m_centroid.SetZero();
+	m_isBox = false;
 }
 
 inline const b2Vec2& b2PolygonShape::GetVertex(int32 index) const
@@ -49,7 +49,8 @@ public:
 		e_edge = 1,
 		e_polygon = 2,
 		e_chain = 3,
-		e_typeCount = 4
+		e_capsule = 4,
+		e_typeCount = 5
 	};
 
 	virtual ~b2Shape() {}
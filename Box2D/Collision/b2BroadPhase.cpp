@@ -18,23 +18,47 @@
 
 #include <Box2D/Collision/b2BroadPhase.h>
 
-b2BroadPhase::b2BroadPhase()
+b2BroadPhase::b2BroadPhase(b2Allocator* allocator)
+	: m_allocator(allocator ? allocator : b2GetDefaultAllocator()), m_tree(m_allocator)
 {
 	m_proxyCount = 0;
 
 	m_pairCapacity = 16;
 	m_pairCount = 0;
-	m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+	m_pairBuffer = (b2Pair*)m_allocator->Allocate(m_pairCapacity * sizeof(b2Pair), b2_pairMemory);
 
 	m_moveCapacity = 16;
 	m_moveCount = 0;
-	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	m_moveBuffer = (int32*)m_allocator->Allocate(m_moveCapacity * sizeof(int32), b2_pairMemory);
 }
 
 b2BroadPhase::~b2BroadPhase()
 {
-	b2Free(m_moveBuffer);
-	b2Free(m_pairBuffer);
+	m_allocator->Free(m_moveBuffer, m_moveCapacity * sizeof(int32), b2_pairMemory);
+	m_allocator->Free(m_pairBuffer, m_pairCapacity * sizeof(b2Pair), b2_pairMemory);
+}
+
+void b2BroadPhase::Reserve(int32 proxyCount, int32 pairCount)
+{
+	m_tree.Reserve(proxyCount);
+
+	if (proxyCount > m_moveCapacity)
+	{
+		int32* oldBuffer = m_moveBuffer;
+		m_moveBuffer = (int32*)m_allocator->Allocate(proxyCount * sizeof(int32), b2_pairMemory);
+		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
+		m_allocator->Free(oldBuffer, m_moveCapacity * sizeof(int32), b2_pairMemory);
+		m_moveCapacity = proxyCount;
+	}
+
+	if (pairCount > m_pairCapacity)
+	{
+		b2Pair* oldBuffer = m_pairBuffer;
+		m_pairBuffer = (b2Pair*)m_allocator->Allocate(pairCount * sizeof(b2Pair), b2_pairMemory);
+		memcpy(m_pairBuffer, oldBuffer, m_pairCount * sizeof(b2Pair));
+		m_allocator->Free(oldBuffer, m_pairCapacity * sizeof(b2Pair), b2_pairMemory);
+		m_pairCapacity = pairCount;
+	}
 }
 
 int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
@@ -45,6 +69,16 @@ int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
 	return proxyId;
 }
 
+void b2BroadPhase::CreateProxies(const b2AABB* aabbs, void* const* userData, int32 count, int32* proxyIds)
+{
+	m_tree.CreateProxies(aabbs, userData, count, proxyIds);
+	m_proxyCount += count;
+	for (int32 i = 0; i < count; ++i)
+	{
+		BufferMove(proxyIds[i]);
+	}
+}
+
 void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	UnBufferMove(proxyId);
@@ -72,9 +106,9 @@ void b2BroadPhase::BufferMove(int32 proxyId)
 	{
 		int32* oldBuffer = m_moveBuffer;
 		m_moveCapacity *= 2;
-		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+		m_moveBuffer = (int32*)m_allocator->Allocate(m_moveCapacity * sizeof(int32), b2_pairMemory);
 		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
-		b2Free(oldBuffer);
+		m_allocator->Free(oldBuffer, m_moveCount * sizeof(int32), b2_pairMemory);
 	}
 
 	m_moveBuffer[m_moveCount] = proxyId;
@@ -106,9 +140,9 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 	{
 		b2Pair* oldBuffer = m_pairBuffer;
 		m_pairCapacity *= 2;
-		m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+		m_pairBuffer = (b2Pair*)m_allocator->Allocate(m_pairCapacity * sizeof(b2Pair), b2_pairMemory);
 		memcpy(m_pairBuffer, oldBuffer, m_pairCount * sizeof(b2Pair));
-		b2Free(oldBuffer);
+		m_allocator->Free(oldBuffer, m_pairCount * sizeof(b2Pair), b2_pairMemory);
 	}
 
 	m_pairBuffer[m_pairCount].proxyIdA = b2Min(proxyId, m_queryProxyId);
@@ -42,13 +42,22 @@ public:
 		e_nullProxy = -1
 	};
 
-	b2BroadPhase();
+	/// The tree and the pair and move buffers are taken from the given
+	/// allocator, or from the default allocator if it is NULL.
+	b2BroadPhase(b2Allocator* allocator = NULL);
 	~b2BroadPhase();
 
+	/// Size the tree and the move buffer for the given number of proxies and
+	/// the pair buffer for the given number of pairs.
+	void Reserve(int32 proxyCount, int32 pairCount);
+
 	/// Create a proxy with an initial AABB. Pairs are not reported until
 	/// UpdatePairs is called.
 	int32 CreateProxy(const b2AABB& aabb, void* userData);
 
+	/// Create many proxies at once, see b2DynamicTree::CreateProxies.
+	void CreateProxies(const b2AABB* aabbs, void* const* userData, int32 count, int32* proxyIds);
+
 	/// Destroy a proxy. It is up to the client to remove any pairs.
 	void DestroyProxy(int32 proxyId);
 
@@ -113,6 +122,7 @@ private:
 
 	bool QueryCallback(int32 proxyId);
 
+	b2Allocator* m_allocator;
 	b2DynamicTree m_tree;
 
 	int32 m_proxyCount;
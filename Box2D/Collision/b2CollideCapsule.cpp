@@ -0,0 +1,235 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Collision/b2Distance.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+
+// Build a two sided polygon from the core segment of a capsule. The polygon
+// clipper handles rounded face contacts through the polygon radius.
+static void b2MakeCapsulePolygon(b2PolygonShape* polygon, const b2CapsuleShape* capsule)
+{
+	polygon->m_count = 2;
+	polygon->m_vertices[0] = capsule->m_vertex1;
+	polygon->m_vertices[1] = capsule->m_vertex2;
+	polygon->m_normals[0] = b2Cross(capsule->m_vertex2 - capsule->m_vertex1, 1.0f);
+	polygon->m_normals[0].Normalize();
+	polygon->m_normals[1] = -polygon->m_normals[0];
+	polygon->m_centroid = 0.5f * (capsule->m_vertex1 + capsule->m_vertex2);
+	polygon->m_radius = capsule->m_radius;
+}
+
+// Both closest features are vertices: the normal points from one vertex to
+// the other, like two circles.
+static void b2SetVertexContact(b2Manifold* manifold,
+							   const b2Vec2& localPointA, int32 indexA,
+							   const b2Vec2& localPointB, int32 indexB)
+{
+	manifold->type = b2Manifold::e_circles;
+	manifold->localPoint = localPointA;
+	manifold->localNormal.SetZero();
+	manifold->pointCount = 1;
+
+	manifold->points[0].localPoint = localPointB;
+	manifold->points[0].id.key = 0;
+	manifold->points[0].id.cf.indexA = (uint8)indexA;
+	manifold->points[0].id.cf.typeA = b2ContactFeature::e_vertex;
+	manifold->points[0].id.cf.indexB = (uint8)indexB;
+	manifold->points[0].id.cf.typeB = b2ContactFeature::e_vertex;
+}
+
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB,
+							   float32 margin)
+{
+	manifold->pointCount = 0;
+
+	// Compute circle in frame of capsule
+	b2Vec2 Q = b2MulT(xfA, b2Mul(xfB, circleB->m_p));
+
+	b2Vec2 A = capsuleA->m_vertex1, B = capsuleA->m_vertex2;
+	b2Vec2 e = B - A;
+	float32 radius = capsuleA->m_radius + circleB->m_radius + margin;
+
+	// Closest point on the segment.
+	float32 t = b2Dot(Q - A, e) / b2Dot(e, e);
+	t = b2Clamp(t, 0.0f, 1.0f);
+	b2Vec2 P = A + t * e;
+
+	if (b2DistanceSquared(P, Q) > radius * radius)
+	{
+		return;
+	}
+
+	// Region A or B
+	if (t == 0.0f || t == 1.0f)
+	{
+		int32 index = t == 0.0f ? 0 : 1;
+		b2SetVertexContact(manifold, P, index, circleB->m_p, 0);
+		return;
+	}
+
+	// Region AB
+	b2Vec2 n(-e.y, e.x);
+	if (b2Dot(n, Q - A) < 0.0f)
+	{
+		n.Set(-n.x, -n.y);
+	}
+	n.Normalize();
+
+	manifold->type = b2Manifold::e_faceA;
+	manifold->localNormal = n;
+	manifold->localPoint = A;
+	manifold->pointCount = 1;
+	manifold->points[0].localPoint = circleB->m_p;
+	manifold->points[0].id.key = 0;
+	manifold->points[0].id.cf.indexA = 0;
+	manifold->points[0].id.cf.typeA = b2ContactFeature::e_face;
+	manifold->points[0].id.cf.indexB = 0;
+	manifold->points[0].id.cf.typeB = b2ContactFeature::e_vertex;
+}
+
+// Closest points between segments p1-q1 and p2-q2, as fractions along each.
+// From Real-Time Collision Detection by Christer Ericson, Section 5.1.9.
+// Both segments must have non-zero length.
+static float32 b2SegmentDistanceSquared(float32* s, float32* t,
+										const b2Vec2& p1, const b2Vec2& q1,
+										const b2Vec2& p2, const b2Vec2& q2)
+{
+	b2Vec2 d1 = q1 - p1;
+	b2Vec2 d2 = q2 - p2;
+	b2Vec2 r = p1 - p2;
+	float32 a = b2Dot(d1, d1);
+	float32 e = b2Dot(d2, d2);
+	float32 f = b2Dot(d2, r);
+	float32 c = b2Dot(d1, r);
+	float32 b = b2Dot(d1, d2);
+	float32 denominator = a * e - b * b;
+
+	// Parallel segments pick an arbitrary point on the first.
+	float32 sc = 0.0f;
+	if (denominator != 0.0f)
+	{
+		sc = b2Clamp((b * f - c * e) / denominator, 0.0f, 1.0f);
+	}
+
+	float32 tc = (b * sc + f) / e;
+	if (tc < 0.0f)
+	{
+		tc = 0.0f;
+		sc = b2Clamp(-c / a, 0.0f, 1.0f);
+	}
+	else if (tc > 1.0f)
+	{
+		tc = 1.0f;
+		sc = b2Clamp((b - c) / a, 0.0f, 1.0f);
+	}
+
+	*s = sc;
+	*t = tc;
+	return b2DistanceSquared(p1 + sc * d1, p2 + tc * d2);
+}
+
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB,
+					   float32 margin)
+{
+	manifold->pointCount = 0;
+
+	// Put capsule B into the frame of capsule A.
+	b2Transform xf = b2MulT(xfA, xfB);
+	b2Vec2 p2 = b2Mul(xf, capsuleB->m_vertex1);
+	b2Vec2 q2 = b2Mul(xf, capsuleB->m_vertex2);
+
+	float32 s, t;
+	float32 distanceSquared = b2SegmentDistanceSquared(&s, &t, capsuleA->m_vertex1, capsuleA->m_vertex2, p2, q2);
+
+	float32 maxSeparation = capsuleA->m_radius + capsuleB->m_radius + margin;
+	if (distanceSquared > maxSeparation * maxSeparation)
+	{
+		return;
+	}
+
+	// Cores closer than the tolerance are treated as overlapping, so the
+	// vertex-vertex normal can be normalized safely.
+	const float32 k_tol = 0.1f * b2_linearSlop;
+	bool vertexA = s == 0.0f || s == 1.0f;
+	bool vertexB = t == 0.0f || t == 1.0f;
+	if (vertexA && vertexB && distanceSquared > k_tol * k_tol)
+	{
+		int32 indexA = s == 0.0f ? 0 : 1;
+		int32 indexB = t == 0.0f ? 0 : 1;
+		const b2Vec2& localPointA = indexA == 0 ? capsuleA->m_vertex1 : capsuleA->m_vertex2;
+		const b2Vec2& localPointB = indexB == 0 ? capsuleB->m_vertex1 : capsuleB->m_vertex2;
+		b2SetVertexContact(manifold, localPointA, indexA, localPointB, indexB);
+		return;
+	}
+
+	// A face is involved or the cores overlap. Clip the segments.
+	b2PolygonShape polygonA, polygonB;
+	b2MakeCapsulePolygon(&polygonA, capsuleA);
+	b2MakeCapsulePolygon(&polygonB, capsuleB);
+	b2CollidePolygons(manifold, &polygonA, xfA, &polygonB, xfB, margin);
+}
+
+void b2CollidePolygonAndCapsule(b2Manifold* manifold,
+								const b2PolygonShape* polygonA, const b2Transform& xfA,
+								const b2CapsuleShape* capsuleB, const b2Transform& xfB,
+								float32 margin)
+{
+	manifold->pointCount = 0;
+
+	b2PolygonShape polygonB;
+	b2MakeCapsulePolygon(&polygonB, capsuleB);
+
+	// Find the closest features of the cores.
+	b2DistanceInput input;
+	input.proxyA.Set(polygonA, 0);
+	input.proxyB.Set(&polygonB, 0);
+	input.transformA = xfA;
+	input.transformB = xfB;
+	input.useRadii = false;
+
+	b2SimplexCache cache;
+	cache.count = 0;
+
+	b2DistanceOutput output;
+	b2Distance(&output, &cache, &input);
+
+	float32 maxSeparation = polygonA->m_radius + capsuleB->m_radius + margin;
+	if (output.distance > maxSeparation)
+	{
+		return;
+	}
+
+	// A single simplex vertex means both closest features are vertices.
+	const float32 k_tol = 0.1f * b2_linearSlop;
+	if (cache.count == 1 && output.distance > k_tol)
+	{
+		int32 indexA = cache.indexA[0];
+		int32 indexB = cache.indexB[0];
+		b2SetVertexContact(manifold, polygonA->m_vertices[indexA], indexA, polygonB.m_vertices[indexB], indexB);
+		return;
+	}
+
+	b2CollidePolygons(manifold, polygonA, xfA, &polygonB, xfB, margin);
+}
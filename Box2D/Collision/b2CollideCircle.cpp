@@ -20,10 +20,16 @@
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 void b2CollideCircles(
 	b2Manifold* manifold,
 	const b2CircleShape* circleA, const b2Transform& xfA,
-	const b2CircleShape* circleB, const b2Transform& xfB)
+	const b2CircleShape* circleB, const b2Transform& xfB,
+	float32 margin)
 {
 	manifold->pointCount = 0;
 
@@ -33,7 +39,7 @@ void b2CollideCircles(
 	b2Vec2 d = pB - pA;
 	float32 distSqr = b2Dot(d, d);
 	float32 rA = circleA->m_radius, rB = circleB->m_radius;
-	float32 radius = rA + rB;
+	float32 radius = rA + rB + margin;
 	if (distSqr > radius * radius)
 	{
 		return;
@@ -48,42 +54,105 @@ void b2CollideCircles(
 	manifold->points[0].id.key = 0;
 }
 
-void b2CollidePolygonAndCircle(
+// Collide a box with a circle whose center is given in the box frame. The
+// closest point on the box picks the face or corner region directly, so no
+// separating edge search is needed.
+static void b2CollideBoxAndCircle(
 	b2Manifold* manifold,
-	const b2PolygonShape* polygonA, const b2Transform& xfA,
-	const b2CircleShape* circleB, const b2Transform& xfB)
+	const b2PolygonShape* boxA, const b2Vec2& localPointB,
+	const b2Vec2& cLocal, float32 radius)
 {
-	manifold->pointCount = 0;
+	const b2Vec2& lower = boxA->m_box.lowerBound;
+	const b2Vec2& upper = boxA->m_box.upperBound;
+	b2Vec2 closest = b2Clamp(cLocal, lower, upper);
+	b2Vec2 center = 0.5f * (lower + upper);
 
-	// Compute circle position in the frame of the polygon.
-	b2Vec2 c = b2Mul(xfB, circleB->m_p);
-	b2Vec2 cLocal = b2MulT(xfA, c);
+	bool clampedX = closest.x != cLocal.x;
+	bool clampedY = closest.y != cLocal.y;
 
-	// Find the min separating edge.
-	int32 normalIndex = 0;
-	float32 separation = -b2_maxFloat;
-	float32 radius = polygonA->m_radius + circleB->m_radius;
-	int32 vertexCount = polygonA->m_count;
-	const b2Vec2* vertices = polygonA->m_vertices;
-	const b2Vec2* normals = polygonA->m_normals;
+	if (clampedX == false && clampedY == false)
+	{
+		// The center is inside the box. Push out through the closest face.
+		float32 left = cLocal.x - lower.x;
+		float32 right = upper.x - cLocal.x;
+		float32 bottom = cLocal.y - lower.y;
+		float32 top = upper.y - cLocal.y;
 
-	for (int32 i = 0; i < vertexCount; ++i)
+		b2Vec2 normal(-1.0f, 0.0f);
+		b2Vec2 facePoint(lower.x, center.y);
+		float32 depth = left;
+		if (right < depth)
+		{
+			depth = right;
+			normal.Set(1.0f, 0.0f);
+			facePoint.Set(upper.x, center.y);
+		}
+		if (bottom < depth)
+		{
+			depth = bottom;
+			normal.Set(0.0f, -1.0f);
+			facePoint.Set(center.x, lower.y);
+		}
+		if (top < depth)
+		{
+			normal.Set(0.0f, 1.0f);
+			facePoint.Set(center.x, upper.y);
+		}
+
+		manifold->localNormal = normal;
+		manifold->localPoint = facePoint;
+	}
+	else if (clampedX && clampedY)
 	{
-		float32 s = b2Dot(normals[i], cLocal - vertices[i]);
+		// Corner region.
+		if (b2DistanceSquared(cLocal, closest) > radius * radius)
+		{
+			return;
+		}
 
-		if (s > radius)
+		manifold->localNormal = cLocal - closest;
+		manifold->localNormal.Normalize();
+		manifold->localPoint = closest;
+	}
+	else if (clampedX)
+	{
+		// Left or right face.
+		if (b2Abs(cLocal.x - closest.x) > radius)
 		{
-			// Early out.
 			return;
 		}
 
-		if (s > separation)
+		manifold->localNormal.Set(cLocal.x > upper.x ? 1.0f : -1.0f, 0.0f);
+		manifold->localPoint.Set(closest.x, center.y);
+	}
+	else
+	{
+		// Bottom or top face.
+		if (b2Abs(cLocal.y - closest.y) > radius)
 		{
-			separation = s;
-			normalIndex = i;
+			return;
 		}
+
+		manifold->localNormal.Set(0.0f, cLocal.y > upper.y ? 1.0f : -1.0f);
+		manifold->localPoint.Set(center.x, closest.y);
 	}
 
+	manifold->pointCount = 1;
+	manifold->type = b2Manifold::e_faceA;
+	manifold->points[0].localPoint = localPointB;
+	manifold->points[0].id.key = 0;
+}
+
+// Build the polygon/circle manifold once the separating edge is known.
+static void b2FinishPolygonAndCircle(
+	b2Manifold* manifold,
+	const b2PolygonShape* polygonA, const b2Vec2& localPointB,
+	const b2Vec2& cLocal, float32 separation, int32 normalIndex, float32 radius)
+{
+	int32 vertexCount = polygonA->m_count;
+	const b2Vec2* vertices = polygonA->m_vertices;
+	const b2Vec2* normals = polygonA->m_normals;
+
 	// Vertices that subtend the incident face.
 	int32 vertIndex1 = normalIndex;
 	int32 vertIndex2 = vertIndex1 + 1 < vertexCount ? vertIndex1 + 1 : 0;
@@ -97,7 +166,7 @@ void b2CollidePolygonAndCircle(
 		manifold->type = b2Manifold::e_faceA;
 		manifold->localNormal = normals[normalIndex];
 		manifold->localPoint = 0.5f * (v1 + v2);
-		manifold->points[0].localPoint = circleB->m_p;
+		manifold->points[0].localPoint = localPointB;
 		manifold->points[0].id.key = 0;
 		return;
 	}
@@ -117,7 +186,7 @@ void b2CollidePolygonAndCircle(
 		manifold->localNormal = cLocal - v1;
 		manifold->localNormal.Normalize();
 		manifold->localPoint = v1;
-		manifold->points[0].localPoint = circleB->m_p;
+		manifold->points[0].localPoint = localPointB;
 		manifold->points[0].id.key = 0;
 	}
 	else if (u2 <= 0.0f)
@@ -132,7 +201,7 @@ void b2CollidePolygonAndCircle(
 		manifold->localNormal = cLocal - v2;
 		manifold->localNormal.Normalize();
 		manifold->localPoint = v2;
-		manifold->points[0].localPoint = circleB->m_p;
+		manifold->points[0].localPoint = localPointB;
 		manifold->points[0].id.key = 0;
 	}
 	else
@@ -148,7 +217,271 @@ void b2CollidePolygonAndCircle(
 		manifold->type = b2Manifold::e_faceA;
 		manifold->localNormal = normals[vertIndex1];
 		manifold->localPoint = faceCenter;
-		manifold->points[0].localPoint = circleB->m_p;
+		manifold->points[0].localPoint = localPointB;
+		manifold->points[0].id.key = 0;
+	}
+}
+
+void b2CollidePolygonAndCircle(
+	b2Manifold* manifold,
+	const b2PolygonShape* polygonA, const b2Transform& xfA,
+	const b2CircleShape* circleB, const b2Transform& xfB,
+	float32 margin)
+{
+	manifold->pointCount = 0;
+
+	// Compute circle position in the frame of the polygon.
+	b2Vec2 c = b2Mul(xfB, circleB->m_p);
+	b2Vec2 cLocal = b2MulT(xfA, c);
+	float32 radius = polygonA->m_radius + circleB->m_radius + margin;
+
+	if (polygonA->m_isBox)
+	{
+		b2CollideBoxAndCircle(manifold, polygonA, circleB->m_p, cLocal, radius);
+		return;
+	}
+
+	// Find the min separating edge.
+	int32 normalIndex = 0;
+	float32 separation = -b2_maxFloat;
+	int32 vertexCount = polygonA->m_count;
+	const b2Vec2* vertices = polygonA->m_vertices;
+	const b2Vec2* normals = polygonA->m_normals;
+
+	for (int32 i = 0; i < vertexCount; ++i)
+	{
+		float32 s = b2Dot(normals[i], cLocal - vertices[i]);
+
+		if (s > radius)
+		{
+			// Early out.
+			return;
+		}
+
+		if (s > separation)
+		{
+			separation = s;
+			normalIndex = i;
+		}
+	}
+
+	b2FinishPolygonAndCircle(manifold, polygonA, circleB->m_p, cLocal, separation, normalIndex, radius);
+}
+
+// The wide kernels below follow the scalar routines operation by operation so
+// that every lane produces exactly the same manifold as the scalar code.
+
+void b2CollideCirclesWide(
+	b2Manifold* const manifolds[b2_simdLanes],
+	const b2CircleLanes& circlesA, const b2TransformLanes& xfA,
+	const b2CircleLanes& circlesB, const b2TransformLanes& xfB,
+	const float32 margins[b2_simdLanes])
+{
+	float32 distSqr[b2_simdLanes];
+	float32 radiusSqr[b2_simdLanes];
+
+#if defined(B2_USE_SSE2)
+	__m128 qcA = _mm_loadu_ps(xfA.c), qsA = _mm_loadu_ps(xfA.s);
+	__m128 qcB = _mm_loadu_ps(xfB.c), qsB = _mm_loadu_ps(xfB.s);
+	__m128 lxA = _mm_loadu_ps(circlesA.px), lyA = _mm_loadu_ps(circlesA.py);
+	__m128 lxB = _mm_loadu_ps(circlesB.px), lyB = _mm_loadu_ps(circlesB.py);
+
+	// pA = b2Mul(xfA, circleA->m_p)
+	__m128 pxA = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(qcA, lxA), _mm_mul_ps(qsA, lyA)), _mm_loadu_ps(xfA.px));
+	__m128 pyA = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qsA, lxA), _mm_mul_ps(qcA, lyA)), _mm_loadu_ps(xfA.py));
+
+	// pB = b2Mul(xfB, circleB->m_p)
+	__m128 pxB = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(qcB, lxB), _mm_mul_ps(qsB, lyB)), _mm_loadu_ps(xfB.px));
+	__m128 pyB = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qsB, lxB), _mm_mul_ps(qcB, lyB)), _mm_loadu_ps(xfB.py));
+
+	__m128 dx = _mm_sub_ps(pxB, pxA);
+	__m128 dy = _mm_sub_ps(pyB, pyA);
+	__m128 radius = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(circlesA.radius), _mm_loadu_ps(circlesB.radius)), _mm_loadu_ps(margins));
+
+	_mm_storeu_ps(distSqr, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+	_mm_storeu_ps(radiusSqr, _mm_mul_ps(radius, radius));
+#else
+	for (int32 i = 0; i < b2_simdLanes; ++i)
+	{
+		b2Transform tA, tB;
+		tA.p.Set(xfA.px[i], xfA.py[i]);
+		tA.q.s = xfA.s[i];
+		tA.q.c = xfA.c[i];
+		tB.p.Set(xfB.px[i], xfB.py[i]);
+		tB.q.s = xfB.s[i];
+		tB.q.c = xfB.c[i];
+
+		b2Vec2 pA = b2Mul(tA, b2Vec2(circlesA.px[i], circlesA.py[i]));
+		b2Vec2 pB = b2Mul(tB, b2Vec2(circlesB.px[i], circlesB.py[i]));
+		b2Vec2 d = pB - pA;
+		float32 radius = circlesA.radius[i] + circlesB.radius[i] + margins[i];
+		distSqr[i] = b2Dot(d, d);
+		radiusSqr[i] = radius * radius;
+	}
+#endif
+
+	for (int32 i = 0; i < b2_simdLanes; ++i)
+	{
+		b2Manifold* manifold = manifolds[i];
+		manifold->pointCount = 0;
+
+		if (distSqr[i] > radiusSqr[i])
+		{
+			continue;
+		}
+
+		manifold->type = b2Manifold::e_circles;
+		manifold->localPoint.Set(circlesA.px[i], circlesA.py[i]);
+		manifold->localNormal.SetZero();
+		manifold->pointCount = 1;
+
+		manifold->points[0].localPoint.Set(circlesB.px[i], circlesB.py[i]);
 		manifold->points[0].id.key = 0;
 	}
 }
+
+void b2CollidePolygonAndCircleWide(
+	b2Manifold* const manifolds[b2_simdLanes],
+	const b2PolygonShape* const polygonsA[b2_simdLanes], const b2TransformLanes& xfA,
+	const b2CircleLanes& circlesB, const b2TransformLanes& xfB,
+	const float32 margins[b2_simdLanes])
+{
+	float32 cLocalX[b2_simdLanes], cLocalY[b2_simdLanes];
+	float32 radius[b2_simdLanes];
+	float32 separation[b2_simdLanes];
+	int32 normalIndex[b2_simdLanes];
+	bool separated[b2_simdLanes];
+
+	int32 maxCount = 0;
+	for (int32 i = 0; i < b2_simdLanes; ++i)
+	{
+		radius[i] = polygonsA[i]->m_radius + circlesB.radius[i] + margins[i];
+		maxCount = b2Max(maxCount, polygonsA[i]->m_count);
+	}
+
+#if defined(B2_USE_SSE2)
+	__m128 qcA = _mm_loadu_ps(xfA.c), qsA = _mm_loadu_ps(xfA.s);
+	__m128 qcB = _mm_loadu_ps(xfB.c), qsB = _mm_loadu_ps(xfB.s);
+	__m128 lxB = _mm_loadu_ps(circlesB.px), lyB = _mm_loadu_ps(circlesB.py);
+
+	// c = b2Mul(xfB, circleB->m_p)
+	__m128 cx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(qcB, lxB), _mm_mul_ps(qsB, lyB)), _mm_loadu_ps(xfB.px));
+	__m128 cy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qsB, lxB), _mm_mul_ps(qcB, lyB)), _mm_loadu_ps(xfB.py));
+
+	// cLocal = b2MulT(xfA, c)
+	__m128 px = _mm_sub_ps(cx, _mm_loadu_ps(xfA.px));
+	__m128 py = _mm_sub_ps(cy, _mm_loadu_ps(xfA.py));
+	__m128 negQsA = _mm_sub_ps(_mm_setzero_ps(), qsA);
+	__m128 clx = _mm_add_ps(_mm_mul_ps(qcA, px), _mm_mul_ps(qsA, py));
+	__m128 cly = _mm_add_ps(_mm_mul_ps(negQsA, px), _mm_mul_ps(qcA, py));
+	_mm_storeu_ps(cLocalX, clx);
+	_mm_storeu_ps(cLocalY, cly);
+
+	// Find the min separating edge in all lanes. A lane is done once it
+	// runs out of vertices or finds a separating axis (early out).
+	__m128 radiusV = _mm_loadu_ps(radius);
+	__m128 separationV = _mm_set1_ps(-b2_maxFloat);
+	__m128i normalIndexV = _mm_setzero_si128();
+	__m128 separatedV = _mm_setzero_ps();
+
+	for (int32 k = 0; k < maxCount; ++k)
+	{
+		float32 nx[b2_simdLanes], ny[b2_simdLanes], vx[b2_simdLanes], vy[b2_simdLanes];
+		int32 active[b2_simdLanes];
+		for (int32 i = 0; i < b2_simdLanes; ++i)
+		{
+			const b2PolygonShape* polygon = polygonsA[i];
+			int32 j = k < polygon->m_count ? k : 0;
+			nx[i] = polygon->m_normals[j].x;
+			ny[i] = polygon->m_normals[j].y;
+			vx[i] = polygon->m_vertices[j].x;
+			vy[i] = polygon->m_vertices[j].y;
+			active[i] = k < polygon->m_count ? -1 : 0;
+		}
+
+		// s = b2Dot(normals[k], cLocal - vertices[k])
+		__m128 s = _mm_add_ps(
+			_mm_mul_ps(_mm_loadu_ps(nx), _mm_sub_ps(clx, _mm_loadu_ps(vx))),
+			_mm_mul_ps(_mm_loadu_ps(ny), _mm_sub_ps(cly, _mm_loadu_ps(vy))));
+
+		__m128 live = _mm_andnot_ps(separatedV, _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)active)));
+		separatedV = _mm_or_ps(separatedV, _mm_and_ps(live, _mm_cmpgt_ps(s, radiusV)));
+		live = _mm_andnot_ps(separatedV, live);
+
+		__m128 better = _mm_and_ps(live, _mm_cmpgt_ps(s, separationV));
+		separationV = _mm_or_ps(_mm_and_ps(better, s), _mm_andnot_ps(better, separationV));
+		__m128i betterI = _mm_castps_si128(better);
+		normalIndexV = _mm_or_si128(_mm_and_si128(betterI, _mm_set1_epi32(k)), _mm_andnot_si128(betterI, normalIndexV));
+	}
+
+	int32 separatedMask[b2_simdLanes];
+	_mm_storeu_ps(separation, separationV);
+	_mm_storeu_si128((__m128i*)normalIndex, normalIndexV);
+	_mm_storeu_si128((__m128i*)separatedMask, _mm_castps_si128(separatedV));
+	for (int32 i = 0; i < b2_simdLanes; ++i)
+	{
+		separated[i] = separatedMask[i] != 0;
+	}
+#else
+	B2_NOT_USED(maxCount);
+	for (int32 i = 0; i < b2_simdLanes; ++i)
+	{
+		b2Transform tA, tB;
+		tA.p.Set(xfA.px[i], xfA.py[i]);
+		tA.q.s = xfA.s[i];
+		tA.q.c = xfA.c[i];
+		tB.p.Set(xfB.px[i], xfB.py[i]);
+		tB.q.s = xfB.s[i];
+		tB.q.c = xfB.c[i];
+
+		b2Vec2 c = b2Mul(tB, b2Vec2(circlesB.px[i], circlesB.py[i]));
+		b2Vec2 cLocal = b2MulT(tA, c);
+		cLocalX[i] = cLocal.x;
+		cLocalY[i] = cLocal.y;
+
+		separation[i] = -b2_maxFloat;
+		normalIndex[i] = 0;
+		separated[i] = false;
+
+		const b2PolygonShape* polygon = polygonsA[i];
+		for (int32 k = 0; k < polygon->m_count; ++k)
+		{
+			float32 s = b2Dot(polygon->m_normals[k], cLocal - polygon->m_vertices[k]);
+
+			if (s > radius[i])
+			{
+				separated[i] = true;
+				break;
+			}
+
+			if (s > separation[i])
+			{
+				separation[i] = s;
+				normalIndex[i] = k;
+			}
+		}
+	}
+#endif
+
+	for (int32 i = 0; i < b2_simdLanes; ++i)
+	{
+		b2Manifold* manifold = manifolds[i];
+		manifold->pointCount = 0;
+
+		// Box lanes ride along in the wide search but use the box routine.
+		if (polygonsA[i]->m_isBox)
+		{
+			b2CollideBoxAndCircle(manifold, polygonsA[i], b2Vec2(circlesB.px[i], circlesB.py[i]),
+				b2Vec2(cLocalX[i], cLocalY[i]), radius[i]);
+			continue;
+		}
+
+		if (separated[i])
+		{
+			continue;
+		}
+
+		b2FinishPolygonAndCircle(manifold, polygonsA[i], b2Vec2(circlesB.px[i], circlesB.py[i]),
+			b2Vec2(cLocalX[i], cLocalY[i]), separation[i], normalIndex[i], radius[i]);
+	}
+}
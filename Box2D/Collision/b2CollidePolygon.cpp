@@ -61,6 +61,115 @@ static float32 b2FindMaxSeparation(int32* edgeIndex,
 	return maxSeparation;
 }
 
+// Same as b2FindMaxSeparation when poly1 is a box. The faces of a box are the
+// local axes, so only the extents of poly2 in the frame of poly1 are needed.
+static float32 b2FindMaxSeparationBox1(int32* edgeIndex,
+									 const b2PolygonShape* box1, const b2Transform& xf1,
+									 const b2PolygonShape* poly2, const b2Transform& xf2)
+{
+	int32 count2 = poly2->m_count;
+	const b2Vec2* v2s = poly2->m_vertices;
+	b2Transform xf = b2MulT(xf1, xf2);
+
+	b2Vec2 lower = b2Mul(xf, v2s[0]);
+	b2Vec2 upper = lower;
+	for (int32 j = 1; j < count2; ++j)
+	{
+		b2Vec2 v = b2Mul(xf, v2s[j]);
+		lower = b2Min(lower, v);
+		upper = b2Max(upper, v);
+	}
+
+	const b2Vec2* n1s = box1->m_normals;
+	const b2Vec2& boxLower = box1->m_box.lowerBound;
+	const b2Vec2& boxUpper = box1->m_box.upperBound;
+
+	int32 bestIndex = 0;
+	float32 maxSeparation = -b2_maxFloat;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		float32 si;
+		if (n1s[i].x > 0.0f)
+		{
+			si = lower.x - boxUpper.x;
+		}
+		else if (n1s[i].x < 0.0f)
+		{
+			si = boxLower.x - upper.x;
+		}
+		else if (n1s[i].y > 0.0f)
+		{
+			si = lower.y - boxUpper.y;
+		}
+		else
+		{
+			si = boxLower.y - upper.y;
+		}
+
+		if (si > maxSeparation)
+		{
+			maxSeparation = si;
+			bestIndex = i;
+		}
+	}
+
+	*edgeIndex = bestIndex;
+	return maxSeparation;
+}
+
+// Same as b2FindMaxSeparation when poly2 is a box. The deepest point of a box
+// along a normal is the corner picked by the signs of the normal.
+static float32 b2FindMaxSeparationBox2(int32* edgeIndex,
+									 const b2PolygonShape* poly1, const b2Transform& xf1,
+									 const b2PolygonShape* box2, const b2Transform& xf2)
+{
+	int32 count1 = poly1->m_count;
+	const b2Vec2* n1s = poly1->m_normals;
+	const b2Vec2* v1s = poly1->m_vertices;
+	const b2Vec2& boxLower = box2->m_box.lowerBound;
+	const b2Vec2& boxUpper = box2->m_box.upperBound;
+	b2Transform xf = b2MulT(xf2, xf1);
+
+	int32 bestIndex = 0;
+	float32 maxSeparation = -b2_maxFloat;
+	for (int32 i = 0; i < count1; ++i)
+	{
+		// Get poly1 normal in frame2.
+		b2Vec2 n = b2Mul(xf.q, n1s[i]);
+		b2Vec2 v1 = b2Mul(xf, v1s[i]);
+
+		b2Vec2 deepest(n.x > 0.0f ? boxLower.x : boxUpper.x, n.y > 0.0f ? boxLower.y : boxUpper.y);
+		float32 si = b2Dot(n, deepest - v1);
+
+		if (si > maxSeparation)
+		{
+			maxSeparation = si;
+			bestIndex = i;
+		}
+	}
+
+	*edgeIndex = bestIndex;
+	return maxSeparation;
+}
+
+// Pick the separation routine that fits the pair of shapes.
+static float32 b2FindSeparation(int32* edgeIndex,
+								const b2PolygonShape* poly1, const b2Transform& xf1,
+								const b2PolygonShape* poly2, const b2Transform& xf2)
+{
+	if (poly1->m_isBox)
+	{
+		return b2FindMaxSeparationBox1(edgeIndex, poly1, xf1, poly2, xf2);
+	}
+
+	if (poly2->m_isBox)
+	{
+		return b2FindMaxSeparationBox2(edgeIndex, poly1, xf1, poly2, xf2);
+	}
+
+	return b2FindMaxSeparation(edgeIndex, poly1, xf1, poly2, xf2);
+}
+
 static void b2FindIncidentEdge(b2ClipVertex c[2],
 							 const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
 							 const b2PolygonShape* poly2, const b2Transform& xf2)
@@ -115,19 +224,21 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 // The normal points from 1 to 2
 void b2CollidePolygons(b2Manifold* manifold,
 					  const b2PolygonShape* polyA, const b2Transform& xfA,
-					  const b2PolygonShape* polyB, const b2Transform& xfB)
+					  const b2PolygonShape* polyB, const b2Transform& xfB,
+					  float32 margin)
 {
 	manifold->pointCount = 0;
 	float32 totalRadius = polyA->m_radius + polyB->m_radius;
+	float32 maxSeparation = totalRadius + margin;
 
 	int32 edgeA = 0;
-	float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
-	if (separationA > totalRadius)
+	float32 separationA = b2FindSeparation(&edgeA, polyA, xfA, polyB, xfB);
+	if (separationA > maxSeparation)
 		return;
 
 	int32 edgeB = 0;
-	float32 separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
-	if (separationB > totalRadius)
+	float32 separationB = b2FindSeparation(&edgeB, polyB, xfB, polyA, xfA);
+	if (separationB > maxSeparation)
 		return;
 
 	const b2PolygonShape* poly1;	// reference polygon
@@ -217,7 +328,7 @@ void b2CollidePolygons(b2Manifold* manifold,
 	{
 		float32 separation = b2Dot(normal, clipPoints2[i].v) - frontOffset;
 
-		if (separation <= totalRadius)
+		if (separation <= maxSeparation)
 		{
 			b2ManifoldPoint* cp = manifold->points + pointCount;
 			cp->localPoint = b2MulT(xf2, clipPoints2[i].v);
@@ -30,6 +30,7 @@ class b2Shape;
 class b2CircleShape;
 class b2EdgeShape;
 class b2PolygonShape;
+class b2CapsuleShape;
 
 const uint8 b2_nullFeature = UCHAR_MAX;
 
@@ -215,30 +216,108 @@ struct b2AABB
 	b2Vec2 upperBound;	///< the upper vertex
 };
 
+/// Transforms for b2_simdLanes contact pairs stored as a structure of arrays.
+/// This is the input layout of the wide collision kernels.
+struct b2TransformLanes
+{
+	/// Store the transform of one lane.
+	void Set(int32 lane, const b2Transform& xf)
+	{
+		px[lane] = xf.p.x;
+		py[lane] = xf.p.y;
+		c[lane] = xf.q.c;
+		s[lane] = xf.q.s;
+	}
+
+	float32 px[b2_simdLanes];
+	float32 py[b2_simdLanes];
+	float32 c[b2_simdLanes];
+	float32 s[b2_simdLanes];
+};
+
+/// Circle centers (in body coordinates) and radii for b2_simdLanes contact pairs.
+struct b2CircleLanes
+{
+	/// Store the circle of one lane.
+	void Set(int32 lane, const b2Vec2& p, float32 radius)
+	{
+		this->px[lane] = p.x;
+		this->py[lane] = p.y;
+		this->radius[lane] = radius;
+	}
+
+	float32 px[b2_simdLanes];
+	float32 py[b2_simdLanes];
+	float32 radius[b2_simdLanes];
+};
+
+// The narrow-phase functions below also report the points of shapes that are
+// separated by less than margin. These points have a positive separation and
+// are used by speculative contacts. Use a zero margin for touching shapes only.
+
 /// Compute the collision manifold between two circles.
 void b2CollideCircles(b2Manifold* manifold,
 					  const b2CircleShape* circleA, const b2Transform& xfA,
-					  const b2CircleShape* circleB, const b2Transform& xfB);
+					  const b2CircleShape* circleB, const b2Transform& xfB,
+					  float32 margin);
 
 /// Compute the collision manifold between a polygon and a circle.
 void b2CollidePolygonAndCircle(b2Manifold* manifold,
 							   const b2PolygonShape* polygonA, const b2Transform& xfA,
-							   const b2CircleShape* circleB, const b2Transform& xfB);
+							   const b2CircleShape* circleB, const b2Transform& xfB,
+							   float32 margin);
+
+/// Compute the collision manifolds of b2_simdLanes circle pairs at once. The
+/// result is identical to calling b2CollideCircles for each lane with the
+/// margin of that lane.
+void b2CollideCirclesWide(b2Manifold* const manifolds[b2_simdLanes],
+						  const b2CircleLanes& circlesA, const b2TransformLanes& xfA,
+						  const b2CircleLanes& circlesB, const b2TransformLanes& xfB,
+						  const float32 margins[b2_simdLanes]);
+
+/// Compute the collision manifolds of b2_simdLanes polygon/circle pairs at once. The
+/// result is identical to calling b2CollidePolygonAndCircle for each lane with
+/// the margin of that lane.
+void b2CollidePolygonAndCircleWide(b2Manifold* const manifolds[b2_simdLanes],
+								   const b2PolygonShape* const polygonsA[b2_simdLanes], const b2TransformLanes& xfA,
+								   const b2CircleLanes& circlesB, const b2TransformLanes& xfB,
+								   const float32 margins[b2_simdLanes]);
+
+/// Compute the collision manifold between a capsule and a circle.
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB,
+							   float32 margin);
+
+/// Compute the collision manifold between two capsules.
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB,
+					   float32 margin);
+
+/// Compute the collision manifold between a polygon and a capsule.
+void b2CollidePolygonAndCapsule(b2Manifold* manifold,
+								const b2PolygonShape* polygonA, const b2Transform& xfA,
+								const b2CapsuleShape* capsuleB, const b2Transform& xfB,
+								float32 margin);
 
 /// Compute the collision manifold between two polygons.
 void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygonA, const b2Transform& xfA,
-					   const b2PolygonShape* polygonB, const b2Transform& xfB);
+					   const b2PolygonShape* polygonB, const b2Transform& xfB,
+					   float32 margin);
 
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndCircle(b2Manifold* manifold,
 							   const b2EdgeShape* polygonA, const b2Transform& xfA,
-							   const b2CircleShape* circleB, const b2Transform& xfB);
+							   const b2CircleShape* circleB, const b2Transform& xfB,
+							   float32 margin);
 
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 							   const b2EdgeShape* edgeA, const b2Transform& xfA,
-							   const b2PolygonShape* circleB, const b2Transform& xfB);
+							   const b2PolygonShape* circleB, const b2Transform& xfB,
+							   float32 margin);
 
 /// Clipping for contact manifolds.
 int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
@@ -274,4 +353,26 @@ inline bool b2TestOverlap(const b2AABB& a, const b2AABB& b)
 	return true;
 }
 
+/// Compute an AABB that bounds a box after it is moved by a transform.
+inline void b2TransformAABB(b2AABB* out, const b2Transform& xf, const b2AABB& aabb)
+{
+	b2Vec2 center = b2Mul(xf, aabb.GetCenter());
+	b2Vec2 extents = aabb.GetExtents();
+	float32 c = b2Abs(xf.q.c), s = b2Abs(xf.q.s);
+	b2Vec2 r(c * extents.x + s * extents.y, s * extents.x + c * extents.y);
+	out->lowerBound = center - r;
+	out->upperBound = center + r;
+}
+
+/// Compute an AABB that bounds a box after it is moved by the inverse of a transform.
+inline void b2InvTransformAABB(b2AABB* out, const b2Transform& xf, const b2AABB& aabb)
+{
+	b2Vec2 center = b2MulT(xf, aabb.GetCenter());
+	b2Vec2 extents = aabb.GetExtents();
+	float32 c = b2Abs(xf.q.c), s = b2Abs(xf.q.s);
+	b2Vec2 r(c * extents.x + s * extents.y, s * extents.x + c * extents.y);
+	out->lowerBound = center - r;
+	out->upperBound = center + r;
+}
+
 #endif
@@ -90,6 +90,9 @@ void b2Distance(b2DistanceOutput* output,
 				b2SimplexCache* cache,
 				const b2DistanceInput* input);
 
+/// GJK statistics of the calling thread.
+extern b2_threadLocal int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+
 
 //////////////////////////////////////////////////////////////////////////
 
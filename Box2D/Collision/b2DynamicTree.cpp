@@ -18,14 +18,17 @@
 
 #include <Box2D/Collision/b2DynamicTree.h>
 #include <memory.h>
+#include <algorithm>
 
-b2DynamicTree::b2DynamicTree()
+b2DynamicTree::b2DynamicTree(b2Allocator* allocator)
 {
+	m_allocator = allocator ? allocator : b2GetDefaultAllocator();
+
 	m_root = b2_nullNode;
 
 	m_nodeCapacity = 16;
 	m_nodeCount = 0;
-	m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+	m_nodes = (b2TreeNode*)m_allocator->Allocate(m_nodeCapacity * sizeof(b2TreeNode), b2_treeMemory);
 	memset(m_nodes, 0, m_nodeCapacity * sizeof(b2TreeNode));
 
 	// Build a linked list for the free list.
@@ -46,7 +49,7 @@ b2DynamicTree::b2DynamicTree()
 b2DynamicTree::~b2DynamicTree()
 {
 	// This frees the entire tree in one shot.
-	b2Free(m_nodes);
+	m_allocator->Free(m_nodes, m_nodeCapacity * sizeof(b2TreeNode), b2_treeMemory);
 }
 
 // Allocate a node from the pool. Grow the pool if necessary.
@@ -58,22 +61,7 @@ int32 b2DynamicTree::AllocateNode()
 		b2Assert(m_nodeCount == m_nodeCapacity);
 
 		// The free list is empty. Rebuild a bigger pool.
-		b2TreeNode* oldNodes = m_nodes;
-		m_nodeCapacity *= 2;
-		m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
-		memcpy(m_nodes, oldNodes, m_nodeCount * sizeof(b2TreeNode));
-		b2Free(oldNodes);
-
-		// Build a linked list for the free list. The parent
-		// pointer becomes the "next" pointer.
-		for (int32 i = m_nodeCount; i < m_nodeCapacity - 1; ++i)
-		{
-			m_nodes[i].next = i + 1;
-			m_nodes[i].height = -1;
-		}
-		m_nodes[m_nodeCapacity-1].next = b2_nullNode;
-		m_nodes[m_nodeCapacity-1].height = -1;
-		m_freeList = m_nodeCount;
+		GrowNodes(2 * m_nodeCapacity);
 	}
 
 	// Peel a node off the free list.
@@ -88,6 +76,40 @@ int32 b2DynamicTree::AllocateNode()
 	return nodeId;
 }
 
+// Grow the node pool. The new nodes go to the front of the free list.
+void b2DynamicTree::GrowNodes(int32 capacity)
+{
+	b2Assert(capacity > m_nodeCapacity);
+
+	b2TreeNode* oldNodes = m_nodes;
+	int32 oldCapacity = m_nodeCapacity;
+	m_nodeCapacity = capacity;
+	m_nodes = (b2TreeNode*)m_allocator->Allocate(m_nodeCapacity * sizeof(b2TreeNode), b2_treeMemory);
+	memcpy(m_nodes, oldNodes, oldCapacity * sizeof(b2TreeNode));
+	m_allocator->Free(oldNodes, oldCapacity * sizeof(b2TreeNode), b2_treeMemory);
+
+	// Build a linked list for the free list. The parent
+	// pointer becomes the "next" pointer.
+	for (int32 i = oldCapacity; i < m_nodeCapacity - 1; ++i)
+	{
+		m_nodes[i].next = i + 1;
+		m_nodes[i].height = -1;
+	}
+	m_nodes[m_nodeCapacity-1].next = m_freeList;
+	m_nodes[m_nodeCapacity-1].height = -1;
+	m_freeList = oldCapacity;
+}
+
+void b2DynamicTree::Reserve(int32 proxyCount)
+{
+	// A tree of n leaves has n - 1 internal nodes.
+	int32 capacity = 2 * proxyCount - 1;
+	if (capacity > m_nodeCapacity)
+	{
+		GrowNodes(capacity);
+	}
+}
+
 // Return a node to the pool.
 void b2DynamicTree::FreeNode(int32 nodeId)
 {
@@ -118,6 +140,96 @@ int32 b2DynamicTree::CreateProxy(const b2AABB& aabb, void* userData)
 	return proxyId;
 }
 
+void b2DynamicTree::CreateProxies(const b2AABB* aabbs, void* const* userData, int32 count, int32* proxyIds)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// A subtree of n leaves has n - 1 internal nodes and one more joins it to the tree.
+	if (m_nodeCount + 2 * count > m_nodeCapacity)
+	{
+		GrowNodes(b2Max(m_nodeCount + 2 * count, 2 * m_nodeCapacity));
+	}
+
+	int32* leaves = (int32*)m_allocator->Allocate(count * sizeof(int32), b2_treeMemory);
+
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = AllocateNode();
+
+		// Fatten the aabb.
+		m_nodes[proxyId].aabb.lowerBound = aabbs[i].lowerBound - r;
+		m_nodes[proxyId].aabb.upperBound = aabbs[i].upperBound + r;
+		m_nodes[proxyId].userData = userData[i];
+		m_nodes[proxyId].height = 0;
+
+		proxyIds[i] = proxyId;
+		leaves[i] = proxyId;
+	}
+
+	int32 subtree = BuildSubtree(leaves, count);
+	InsertLeaf(subtree);
+
+	m_allocator->Free(leaves, count * sizeof(int32), b2_treeMemory);
+}
+
+// Orders leaves by the center of their AABB along one axis.
+struct b2LeafCenterLessThan
+{
+	bool operator()(int32 a, int32 b) const
+	{
+		const b2AABB& aabbA = nodes[a].aabb;
+		const b2AABB& aabbB = nodes[b].aabb;
+		return aabbA.lowerBound(axis) + aabbA.upperBound(axis) < aabbB.lowerBound(axis) + aabbB.upperBound(axis);
+	}
+
+	const b2TreeNode* nodes;
+	int32 axis;
+};
+
+// Build a subtree top down, splitting the leaves at the median of their centers
+// along the longer axis of the center bounds. Returns the subtree root.
+int32 b2DynamicTree::BuildSubtree(int32* leaves, int32 count)
+{
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	b2Vec2 lower = m_nodes[leaves[0]].aabb.GetCenter();
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2Vec2 c = m_nodes[leaves[i]].aabb.GetCenter();
+		lower = b2Min(lower, c);
+		upper = b2Max(upper, c);
+	}
+
+	b2LeafCenterLessThan lessThan;
+	lessThan.nodes = m_nodes;
+	lessThan.axis = upper.x - lower.x >= upper.y - lower.y ? 0 : 1;
+
+	int32 half = count / 2;
+	std::nth_element(leaves, leaves + half, leaves + count, lessThan);
+
+	int32 child1 = BuildSubtree(leaves, half);
+	int32 child2 = BuildSubtree(leaves + half, count - half);
+
+	int32 parent = AllocateNode();
+	m_nodes[parent].child1 = child1;
+	m_nodes[parent].child2 = child2;
+	m_nodes[parent].userData = NULL;
+	m_nodes[parent].height = 1 + b2Max(m_nodes[child1].height, m_nodes[child2].height);
+	m_nodes[parent].aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	m_nodes[child1].parent = parent;
+	m_nodes[child2].parent = parent;
+
+	return parent;
+}
+
 void b2DynamicTree::DestroyProxy(int32 proxyId)
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
@@ -693,7 +805,8 @@ int32 b2DynamicTree::GetMaxBalance() const
 
 void b2DynamicTree::RebuildBottomUp()
 {
-	int32* nodes = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	int32 nodeSpace = m_nodeCount;
+	int32* nodes = (int32*)m_allocator->Allocate(nodeSpace * sizeof(int32), b2_treeMemory);
 	int32 count = 0;
 
 	// Build array of leaves. Free the rest.
@@ -762,7 +875,7 @@ void b2DynamicTree::RebuildBottomUp()
 	}
 
 	m_root = nodes[0];
-	b2Free(nodes);
+	m_allocator->Free(nodes, nodeSpace * sizeof(int32), b2_treeMemory);
 
 	Validate();
 }
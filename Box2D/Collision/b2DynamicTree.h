@@ -21,6 +21,7 @@
 
 #include <Collision/b2Collision.h>
 #include <Common/b2GrowableStack.h>
+#include <Common/b2Allocator.h>
 
 #define b2_nullNode (-1)
 
@@ -61,15 +62,28 @@ struct b2TreeNode
 class b2DynamicTree
 {
 public:
-	/// Constructing the tree initializes the node pool.
-	b2DynamicTree();
+	/// Constructing the tree initializes the node pool. Nodes are taken from the
+	/// given allocator, or from the default allocator if it is NULL.
+	b2DynamicTree(b2Allocator* allocator = NULL);
 
 	/// Destroy the tree, freeing the node pool.
 	~b2DynamicTree();
 
+	/// Grow the node pool to hold the given number of proxies.
+	void Reserve(int32 proxyCount);
+
 	/// Create a proxy. Provide a tight fitting AABB and a userData pointer.
 	int32 CreateProxy(const b2AABB& aabb, void* userData);
 
+	/// Create many proxies at once. The proxies are built into a balanced subtree
+	/// that is inserted as a whole. This is faster than creating them one by one
+	/// and gives a better tree for proxies that are close together.
+	/// @param aabbs tight fitting AABBs, one per proxy.
+	/// @param userData the user data, one per proxy.
+	/// @param count the number of proxies.
+	/// @param proxyIds receives the proxy ids in the order of the AABBs.
+	void CreateProxies(const b2AABB* aabbs, void* const* userData, int32 count, int32* proxyIds);
+
 	/// Destroy a proxy. This asserts if the id is invalid.
 	void DestroyProxy(int32 proxyId);
 
@@ -91,6 +105,12 @@ public:
 	template <typename T>
 	void Query(T* callback, const b2AABB& aabb) const;
 
+	/// Query the pairs of proxies of this tree and another tree that overlap. The
+	/// other tree is placed in the frame of this tree by xf. The callback class is
+	/// called with the proxy of this tree first and the proxy of the other tree second.
+	template <typename T>
+	void QueryPairs(T* callback, const b2DynamicTree* tree, const b2Transform& xf) const;
+
 	/// Ray-cast against the proxies in the tree. This relies on the callback
 	/// to perform a exact ray-cast in the case were the proxy contains a shape.
 	/// The callback also performs the any collision filtering. This has performance
@@ -127,6 +147,9 @@ private:
 
 	int32 AllocateNode();
 	void FreeNode(int32 node);
+	void GrowNodes(int32 capacity);
+
+	int32 BuildSubtree(int32* leaves, int32 count);
 
 	void InsertLeaf(int32 node);
 	void RemoveLeaf(int32 node);
@@ -139,6 +162,8 @@ private:
 	void ValidateStructure(int32 index) const;
 	void ValidateMetrics(int32 index) const;
 
+	b2Allocator* m_allocator;
+
 	int32 m_root;
 
 	b2TreeNode* m_nodes;
@@ -200,6 +225,63 @@ inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 	}
 }
 
+template <typename T>
+inline void b2DynamicTree::QueryPairs(T* callback, const b2DynamicTree* tree, const b2Transform& xf) const
+{
+	if (m_root == b2_nullNode || tree->m_root == b2_nullNode)
+	{
+		return;
+	}
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(m_root);
+	stack.Push(tree->m_root);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeIdB = stack.Pop();
+		int32 nodeIdA = stack.Pop();
+
+		const b2TreeNode* nodeA = m_nodes + nodeIdA;
+		const b2TreeNode* nodeB = tree->m_nodes + nodeIdB;
+
+		b2AABB aabbB;
+		b2TransformAABB(&aabbB, xf, nodeB->aabb);
+
+		if (b2TestOverlap(nodeA->aabb, aabbB) == false)
+		{
+			continue;
+		}
+
+		bool leafA = nodeA->IsLeaf();
+		bool leafB = nodeB->IsLeaf();
+
+		if (leafA && leafB)
+		{
+			bool proceed = callback->QueryCallback(nodeIdA, nodeIdB);
+			if (proceed == false)
+			{
+				return;
+			}
+		}
+		else if (leafB || (leafA == false && nodeA->aabb.GetPerimeter() >= nodeB->aabb.GetPerimeter()))
+		{
+			// Descend into the larger node.
+			stack.Push(nodeA->child1);
+			stack.Push(nodeIdB);
+			stack.Push(nodeA->child2);
+			stack.Push(nodeIdB);
+		}
+		else
+		{
+			stack.Push(nodeIdA);
+			stack.Push(nodeB->child1);
+			stack.Push(nodeIdA);
+			stack.Push(nodeB->child2);
+		}
+	}
+}
+
 template <typename T>
 inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) const
 {
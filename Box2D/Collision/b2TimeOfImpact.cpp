@@ -25,9 +25,9 @@
 
 #include <stdio.h>
 
-float32 b2_toiTime, b2_toiMaxTime;
-int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-int32 b2_toiRootIters, b2_toiMaxRootIters;
+b2_threadLocal float32 b2_toiTime, b2_toiMaxTime;
+b2_threadLocal int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
+b2_threadLocal int32 b2_toiRootIters, b2_toiMaxRootIters;
 
 //
 struct b2SeparationFunction
@@ -55,4 +55,9 @@ struct b2TOIOutput
 /// Note: use b2Distance to compute the contact point and normal at the time of impact.
 void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input);
 
+/// Time of impact statistics of the calling thread.
+extern b2_threadLocal float32 b2_toiTime, b2_toiMaxTime;
+extern b2_threadLocal int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
+extern b2_threadLocal int32 b2_toiRootIters, b2_toiMaxRootIters;
+
 #endif
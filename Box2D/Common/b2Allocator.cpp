@@ -0,0 +1,143 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2Allocator.h>
+#include <memory.h>
+
+void* b2DefaultAllocator::Allocate(int32 size, b2MemoryCategory category)
+{
+	B2_NOT_USED(category);
+	return b2Alloc(size);
+}
+
+void b2DefaultAllocator::Free(void* mem, int32 size, b2MemoryCategory category)
+{
+	B2_NOT_USED(size);
+	B2_NOT_USED(category);
+	b2Free(mem);
+}
+
+b2Allocator* b2GetDefaultAllocator()
+{
+	static b2DefaultAllocator s_allocator;
+	return &s_allocator;
+}
+
+// Allocations are aligned to this many bytes.
+static const int32 b2_arenaAlignment = 16;
+
+b2ArenaAllocator::b2ArenaAllocator(int32 blockSize, b2Allocator* base)
+{
+	b2Assert(blockSize > 0);
+	m_base = base ? base : b2GetDefaultAllocator();
+	m_blocks = NULL;
+	m_cursor = NULL;
+	m_end = NULL;
+	m_blockSize = blockSize;
+	m_usedBytes = 0;
+	m_reservedBytes = 0;
+}
+
+b2ArenaAllocator::~b2ArenaAllocator()
+{
+	while (m_blocks)
+	{
+		b2ArenaBlock* block = m_blocks;
+		m_blocks = block->next;
+		m_base->Free(block, block->size, b2_generalMemory);
+	}
+}
+
+void* b2ArenaAllocator::Allocate(int32 size, b2MemoryCategory category)
+{
+	B2_NOT_USED(category);
+
+	size = (size + b2_arenaAlignment - 1) & ~(b2_arenaAlignment - 1);
+	if (m_cursor == NULL || m_end - m_cursor < size)
+	{
+		// The block header takes one aligned slot.
+		int32 blockSize = b2_arenaAlignment + (size > m_blockSize ? size : m_blockSize);
+		b2ArenaBlock* block = (b2ArenaBlock*)m_base->Allocate(blockSize, b2_generalMemory);
+		block->next = m_blocks;
+		block->size = blockSize;
+		m_blocks = block;
+		m_reservedBytes += blockSize;
+
+		char* data = (char*)block + b2_arenaAlignment;
+		if (size > m_blockSize)
+		{
+			// Keep filling the current block.
+			m_usedBytes += size;
+			return data;
+		}
+
+		m_cursor = data;
+		m_end = (char*)block + blockSize;
+	}
+
+	void* mem = m_cursor;
+	m_cursor += size;
+	m_usedBytes += size;
+	return mem;
+}
+
+void b2ArenaAllocator::Free(void* mem, int32 size, b2MemoryCategory category)
+{
+	B2_NOT_USED(mem);
+	B2_NOT_USED(size);
+	B2_NOT_USED(category);
+}
+
+b2TrackingAllocator::b2TrackingAllocator(b2Allocator* base)
+{
+	m_base = base ? base : b2GetDefaultAllocator();
+	memset(&m_stats, 0, sizeof(b2MemoryStats));
+}
+
+b2TrackingAllocator::~b2TrackingAllocator()
+{
+	// Everything must be freed through this allocator before it goes away.
+	b2Assert(m_stats.totalBytes == 0);
+}
+
+void* b2TrackingAllocator::Allocate(int32 size, b2MemoryCategory category)
+{
+	b2Assert(0 <= category && category < b2_memoryCategoryCount);
+	m_stats.bytes[category] += size;
+	m_stats.totalBytes += size;
+	if (m_stats.totalBytes > m_stats.peakBytes)
+	{
+		m_stats.peakBytes = m_stats.totalBytes;
+	}
+	++m_stats.allocationCount;
+	return m_base->Allocate(size, category);
+}
+
+void b2TrackingAllocator::Free(void* mem, int32 size, b2MemoryCategory category)
+{
+	if (mem == NULL)
+	{
+		return;
+	}
+
+	b2Assert(0 <= category && category < b2_memoryCategoryCount);
+	m_stats.bytes[category] -= size;
+	m_stats.totalBytes -= size;
+	b2Assert(m_stats.bytes[category] >= 0);
+	m_base->Free(mem, size, category);
+}
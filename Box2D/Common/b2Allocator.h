@@ -0,0 +1,137 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_ALLOCATOR_H
+#define B2_ALLOCATOR_H
+
+#include <Common/b2Settings.h>
+
+/// The kinds of memory a world takes from its allocator.
+enum b2MemoryCategory
+{
+	b2_generalMemory,		///< bodies, joints, shapes and body state
+	b2_treeMemory,			///< dynamic tree nodes
+	b2_contactMemory,		///< contacts and contact bookkeeping
+	b2_fixtureMemory,		///< fixtures, their shapes and proxies
+	b2_pairMemory,			///< broad-phase pair and move buffers
+	b2_solverMemory,		///< solver scratch memory
+	b2_userDataMemory,		///< user data owned by the world
+	b2_memoryCategoryCount
+};
+
+/// Memory held and allocations made through an allocator.
+struct b2MemoryStats
+{
+	int32 bytes[b2_memoryCategoryCount];	///< bytes held per category
+	int32 totalBytes;						///< bytes held in all categories
+	int32 peakBytes;						///< the most bytes held at once
+	int32 allocationCount;					///< allocations made so far
+};
+
+/// Heap memory of a world is taken from an allocator. Frees pass the size and
+/// category of the allocation, so implementations need no block headers.
+class b2Allocator
+{
+public:
+	virtual ~b2Allocator() {}
+
+	/// Allocate memory of the given size in bytes.
+	virtual void* Allocate(int32 size, b2MemoryCategory category) = 0;
+
+	/// Free memory allocated by this allocator.
+	virtual void Free(void* mem, int32 size, b2MemoryCategory category) = 0;
+};
+
+/// Allocates with b2Alloc and b2Free.
+class b2DefaultAllocator : public b2Allocator
+{
+public:
+	void* Allocate(int32 size, b2MemoryCategory category);
+	void Free(void* mem, int32 size, b2MemoryCategory category);
+};
+
+/// The allocator used where none is given.
+b2Allocator* b2GetDefaultAllocator();
+
+/// Hands out memory from large blocks and never frees single allocations. All
+/// memory is released when the arena is destroyed. This suits worlds that are
+/// built and destroyed as a whole, such as scenes that are loaded once.
+/// Memory freed by the world is not reused, so growing buffers leave their old
+/// storage behind.
+class b2ArenaAllocator : public b2Allocator
+{
+public:
+	/// Blocks of blockSize bytes are taken from the base allocator, or from the
+	/// default allocator if base is NULL. Larger allocations get their own block.
+	b2ArenaAllocator(int32 blockSize = 256 * 1024, b2Allocator* base = NULL);
+	~b2ArenaAllocator();
+
+	void* Allocate(int32 size, b2MemoryCategory category);
+	void Free(void* mem, int32 size, b2MemoryCategory category);
+
+	/// Get the bytes handed out so far.
+	int32 GetUsedBytes() const { return m_usedBytes; }
+
+	/// Get the bytes taken from the base allocator.
+	int32 GetReservedBytes() const { return m_reservedBytes; }
+
+private:
+
+	struct b2ArenaBlock
+	{
+		b2ArenaBlock* next;
+		int32 size;
+	};
+
+	b2Allocator* m_base;
+	b2ArenaBlock* m_blocks;
+	char* m_cursor;
+	char* m_end;
+	int32 m_blockSize;
+	int32 m_usedBytes;
+	int32 m_reservedBytes;
+};
+
+/// Counts the memory held per category and the number of allocations. The
+/// memory itself comes from the base allocator, or from the default allocator
+/// if base is NULL. Each world tracks its memory this way.
+class b2TrackingAllocator : public b2Allocator
+{
+public:
+	b2TrackingAllocator(b2Allocator* base = NULL);
+	~b2TrackingAllocator();
+
+	void* Allocate(int32 size, b2MemoryCategory category);
+	void Free(void* mem, int32 size, b2MemoryCategory category);
+
+	/// Get the allocator the memory comes from.
+	b2Allocator* GetBase() const { return m_base; }
+
+	/// Get the bytes currently held in a category.
+	int32 GetBytes(b2MemoryCategory category) const { return m_stats.bytes[category]; }
+
+	/// Get the memory statistics.
+	const b2MemoryStats& GetStats() const { return m_stats; }
+
+private:
+
+	b2Allocator* m_base;
+	b2MemoryStats m_stats;
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include <limits.h>
 #include <memory.h>
 #include <stddef.h>
+#include <algorithm>
 
 int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] = 
 {
@@ -45,6 +46,9 @@ struct b2Chunk
 {
 	int32 blockSize;
 	b2Block* blocks;
+
+	// Free blocks, only counted while trimming.
+	int32 freeCount;
 };
 
 struct b2Block
@@ -52,16 +56,26 @@ struct b2Block
 	b2Block* next;
 };
 
-b2BlockAllocator::b2BlockAllocator()
+b2BlockAllocator::b2BlockAllocator(b2Allocator* allocator, b2MemoryCategory category)
 {
 	b2Assert(b2_blockSizes < UCHAR_MAX);
 
+	m_heapAllocator = allocator ? allocator : b2GetDefaultAllocator();
+	m_category = category;
+
 	m_chunkSpace = b2_chunkArrayIncrement;
 	m_chunkCount = 0;
-	m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+	m_chunks = (b2Chunk*)m_heapAllocator->Allocate(m_chunkSpace * sizeof(b2Chunk), m_category);
 	
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_chunkCounts, 0, sizeof(m_chunkCounts));
+	memset(m_liveCounts, 0, sizeof(m_liveCounts));
+	memset(m_reservedCounts, 0, sizeof(m_reservedCounts));
+	m_liveBytes = 0;
+
+	m_trimThreshold = 0;
+	m_trimmedIdleBytes = 0;
 
 	if (s_blockSizeLookupInitialized == false)
 	{
@@ -88,10 +102,10 @@ b2BlockAllocator::~b2BlockAllocator()
 {
 	for (int32 i = 0; i < m_chunkCount; ++i)
 	{
-		b2Free(m_chunks[i].blocks);
+		m_heapAllocator->Free(m_chunks[i].blocks, b2_chunkSize, m_category);
 	}
 
-	b2Free(m_chunks);
+	m_heapAllocator->Free(m_chunks, m_chunkSpace * sizeof(b2Chunk), m_category);
 }
 
 void* b2BlockAllocator::Allocate(int32 size)
@@ -103,52 +117,79 @@ void* b2BlockAllocator::Allocate(int32 size)
 
 	if (size > b2_maxBlockSize)
 	{
-		return b2Alloc(size);
+		return m_heapAllocator->Allocate(size, m_category);
 	}
 
 	int32 index = s_blockSizeLookup[size];
 	b2Assert(0 <= index && index < b2_blockSizes);
 
-	if (m_freeLists[index])
+	++m_liveCounts[index];
+	m_liveBytes += s_blockSizes[index];
+
+	if (m_freeLists[index] == NULL)
 	{
-		b2Block* block = m_freeLists[index];
-		m_freeLists[index] = block->next;
-		return block;
+		AddChunk(index);
 	}
-	else
+
+	b2Block* block = m_freeLists[index];
+	m_freeLists[index] = block->next;
+	return block;
+}
+
+// Add a chunk of blocks to the front of the free list of a size class.
+void b2BlockAllocator::AddChunk(int32 index)
+{
+	if (m_chunkCount == m_chunkSpace)
 	{
-		if (m_chunkCount == m_chunkSpace)
-		{
-			b2Chunk* oldChunks = m_chunks;
-			m_chunkSpace += b2_chunkArrayIncrement;
-			m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
-			memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
-			memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
-			b2Free(oldChunks);
-		}
+		b2Chunk* oldChunks = m_chunks;
+		m_chunkSpace += b2_chunkArrayIncrement;
+		m_chunks = (b2Chunk*)m_heapAllocator->Allocate(m_chunkSpace * sizeof(b2Chunk), m_category);
+		memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
+		memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
+		m_heapAllocator->Free(oldChunks, m_chunkCount * sizeof(b2Chunk), m_category);
+	}
 
-		b2Chunk* chunk = m_chunks + m_chunkCount;
-		chunk->blocks = (b2Block*)b2Alloc(b2_chunkSize);
+	b2Chunk* chunk = m_chunks + m_chunkCount;
+	chunk->blocks = (b2Block*)m_heapAllocator->Allocate(b2_chunkSize, m_category);
 #if defined(_DEBUG)
-		memset(chunk->blocks, 0xcd, b2_chunkSize);
+	memset(chunk->blocks, 0xcd, b2_chunkSize);
 #endif
-		int32 blockSize = s_blockSizes[index];
-		chunk->blockSize = blockSize;
-		int32 blockCount = b2_chunkSize / blockSize;
-		b2Assert(blockCount * blockSize <= b2_chunkSize);
-		for (int32 i = 0; i < blockCount - 1; ++i)
-		{
-			b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * i);
-			b2Block* next = (b2Block*)((int8*)chunk->blocks + blockSize * (i + 1));
-			block->next = next;
-		}
-		b2Block* last = (b2Block*)((int8*)chunk->blocks + blockSize * (blockCount - 1));
-		last->next = NULL;
+	int32 blockSize = s_blockSizes[index];
+	chunk->blockSize = blockSize;
+	int32 blockCount = b2_chunkSize / blockSize;
+	b2Assert(blockCount * blockSize <= b2_chunkSize);
+	for (int32 i = 0; i < blockCount - 1; ++i)
+	{
+		b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * i);
+		b2Block* next = (b2Block*)((int8*)chunk->blocks + blockSize * (i + 1));
+		block->next = next;
+	}
+	b2Block* last = (b2Block*)((int8*)chunk->blocks + blockSize * (blockCount - 1));
+	last->next = m_freeLists[index];
+
+	m_freeLists[index] = chunk->blocks;
+	++m_chunkCount;
+	++m_chunkCounts[index];
+}
 
-		m_freeLists[index] = chunk->blocks->next;
-		++m_chunkCount;
+void b2BlockAllocator::Reserve(int32 size, int32 count)
+{
+	b2Assert(0 < size && size <= b2_maxBlockSize);
 
-		return chunk->blocks;
+	int32 index = s_blockSizeLookup[size];
+	int32 blockCount = b2_chunkSize / s_blockSizes[index];
+	int32 freeCount = m_chunkCounts[index] * blockCount - m_liveCounts[index];
+	while (freeCount < count)
+	{
+		AddChunk(index);
+		freeCount += blockCount;
+	}
+
+	// Trim keeps enough chunks for the live blocks and the reservation.
+	int32 reservedCount = (m_liveCounts[index] + count + blockCount - 1) / blockCount;
+	if (reservedCount > m_reservedCounts[index])
+	{
+		m_reservedCounts[index] = reservedCount;
 	}
 }
 
@@ -163,7 +204,7 @@ void b2BlockAllocator::Free(void* p, int32 size)
 
 	if (size > b2_maxBlockSize)
 	{
-		b2Free(p);
+		m_heapAllocator->Free(p, size, m_category);
 		return;
 	}
 
@@ -199,17 +240,219 @@ void b2BlockAllocator::Free(void* p, int32 size)
 	b2Block* block = (b2Block*)p;
 	block->next = m_freeLists[index];
 	m_freeLists[index] = block;
+
+	--m_liveCounts[index];
+	m_liveBytes -= s_blockSizes[index];
+	b2Assert(m_liveCounts[index] >= 0);
 }
 
 void b2BlockAllocator::Clear()
 {
 	for (int32 i = 0; i < m_chunkCount; ++i)
 	{
-		b2Free(m_chunks[i].blocks);
+		m_heapAllocator->Free(m_chunks[i].blocks, b2_chunkSize, m_category);
 	}
 
 	m_chunkCount = 0;
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_chunkCounts, 0, sizeof(m_chunkCounts));
+	memset(m_liveCounts, 0, sizeof(m_liveCounts));
+	memset(m_reservedCounts, 0, sizeof(m_reservedCounts));
+	m_liveBytes = 0;
+	m_trimmedIdleBytes = 0;
+}
+
+static bool b2ChunkLessThan(const b2Chunk& chunk1, const b2Chunk& chunk2)
+{
+	return chunk1.blocks < chunk2.blocks;
+}
+
+// Find the chunk that holds a block. The chunks must be sorted by address.
+static int32 b2FindChunk(const b2Chunk* chunks, int32 count, const b2Block* block)
+{
+	int32 low = 0;
+	int32 high = count - 1;
+	while (low < high)
+	{
+		int32 mid = (low + high + 1) >> 1;
+		if (chunks[mid].blocks <= block)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	b2Assert(chunks[low].blocks <= block && (const int8*)block < (const int8*)chunks[low].blocks + b2_chunkSize);
+	return low;
+}
+
+int32 b2BlockAllocator::Trim()
+{
+	if (m_chunkCount == 0)
+	{
+		return 0;
+	}
+
+	// Count the free blocks of each chunk. The chunk order does not matter, so
+	// the chunks are sorted in place to find the chunk of a block quickly.
+	std::sort(m_chunks, m_chunks + m_chunkCount, b2ChunkLessThan);
+
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		m_chunks[i].freeCount = 0;
+	}
+
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		for (b2Block* block = m_freeLists[i]; block; block = block->next)
+		{
+			++m_chunks[b2FindChunk(m_chunks, m_chunkCount, block)].freeCount;
+		}
+	}
+
+	// Chunks with every block free are idle. Idle chunks needed for a reservation
+	// are counted as in use and kept.
+	int32 keepCounts[b2_blockSizes];
+	memcpy(keepCounts, m_reservedCounts, sizeof(keepCounts));
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		const b2Chunk* chunk = m_chunks + i;
+		if (chunk->freeCount < b2_chunkSize / chunk->blockSize)
+		{
+			--keepCounts[s_blockSizeLookup[chunk->blockSize]];
+		}
+	}
+
+	bool trimmed = false;
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		b2Chunk* chunk = m_chunks + i;
+		if (chunk->freeCount == b2_chunkSize / chunk->blockSize)
+		{
+			int32 index = s_blockSizeLookup[chunk->blockSize];
+			if (keepCounts[index] > 0)
+			{
+				--keepCounts[index];
+				chunk->freeCount = 0;
+				continue;
+			}
+
+			trimmed = true;
+		}
+	}
+
+	// The blocks of the idle chunks are dropped from the free lists, keeping the
+	// order of the remaining blocks.
+	if (trimmed)
+	{
+		for (int32 i = 0; i < b2_blockSizes; ++i)
+		{
+			b2Block** link = m_freeLists + i;
+			while (*link)
+			{
+				b2Block* block = *link;
+				const b2Chunk* chunk = m_chunks + b2FindChunk(m_chunks, m_chunkCount, block);
+				if (chunk->freeCount == b2_chunkSize / chunk->blockSize)
+				{
+					*link = block->next;
+				}
+				else
+				{
+					link = &block->next;
+				}
+			}
+		}
+	}
+
+	int32 released = 0;
+	int32 count = 0;
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		b2Chunk* chunk = m_chunks + i;
+		if (chunk->freeCount == b2_chunkSize / chunk->blockSize)
+		{
+			--m_chunkCounts[s_blockSizeLookup[chunk->blockSize]];
+			m_heapAllocator->Free(chunk->blocks, b2_chunkSize, m_category);
+			released += b2_chunkSize;
+			continue;
+		}
+
+		m_chunks[count] = *chunk;
+		++count;
+	}
+
+	memset(m_chunks + count, 0, (m_chunkCount - count) * sizeof(b2Chunk));
+	m_chunkCount = count;
+
+	m_trimmedIdleBytes = GetTrimmableBytes();
+	return released;
+}
+
+void b2BlockAllocator::SetTrimThreshold(int32 bytes)
+{
+	b2Assert(bytes >= 0);
+	m_trimThreshold = bytes;
+}
+
+int32 b2BlockAllocator::AutoTrim()
+{
+	if (m_trimThreshold == 0)
+	{
+		return 0;
+	}
+
+	// The baseline follows the idle bytes down, so memory that was put to use
+	// again since the last trim does not count toward the threshold.
+	int32 idleBytes = GetTrimmableBytes();
+	if (idleBytes < m_trimmedIdleBytes)
+	{
+		m_trimmedIdleBytes = idleBytes;
+	}
+
+	if (idleBytes <= m_trimmedIdleBytes + m_trimThreshold)
+	{
+		return 0;
+	}
+
+	return Trim();
+}
+
+int32 b2BlockAllocator::GetTrimmableBytes() const
+{
+	int32 idleBytes = m_chunkCount * b2_chunkSize - m_liveBytes;
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		int32 blockCount = b2_chunkSize / s_blockSizes[i];
+		int32 reservedFree = m_reservedCounts[i] * blockCount - m_liveCounts[i];
+		if (reservedFree > 0)
+		{
+			idleBytes -= reservedFree * s_blockSizes[i];
+		}
+	}
+
+	return idleBytes > 0 ? idleBytes : 0;
+}
+
+b2BlockAllocatorStats b2BlockAllocator::GetStats() const
+{
+	b2BlockAllocatorStats stats;
+	stats.chunkCount = m_chunkCount;
+	stats.chunkBytes = m_chunkCount * b2_chunkSize;
+	stats.liveBytes = m_liveBytes;
+	memcpy(stats.chunks, m_chunkCounts, sizeof(m_chunkCounts));
+	memcpy(stats.liveBlocks, m_liveCounts, sizeof(m_liveCounts));
+	if (stats.chunkBytes > 0)
+	{
+		stats.fragmentation = 1.0f - float32(m_liveBytes) / float32(stats.chunkBytes);
+	}
+	else
+	{
+		stats.fragmentation = 0.0f;
+	}
+	return stats;
 }
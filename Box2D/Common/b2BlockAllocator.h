@@ -19,7 +19,7 @@
 #ifndef B2_BLOCK_ALLOCATOR_H
 #define B2_BLOCK_ALLOCATOR_H
 
-#include <Common/b2Settings.h>
+#include <Common/b2Allocator.h>
 
 const int32 b2_chunkSize = 16 * 1024;
 const int32 b2_maxBlockSize = 640;
@@ -29,31 +29,84 @@ const int32 b2_chunkArrayIncrement = 128;
 struct b2Block;
 struct b2Chunk;
 
+/// Statistics of a block allocator.
+struct b2BlockAllocatorStats
+{
+	int32 chunkCount;						///< chunks held
+	int32 chunkBytes;						///< bytes held in chunks
+	int32 liveBytes;						///< bytes of the blocks in use
+	int32 chunks[b2_blockSizes];			///< chunks held per size class
+	int32 liveBlocks[b2_blockSizes];		///< blocks in use per size class
+	float32 fragmentation;					///< fraction of the chunk bytes not in use
+};
+
 /// This is a small object allocator used for allocating small
 /// objects that persist for more than one time step.
 /// See: http://www.codeproject.com/useritems/Small_Block_Allocator.asp
 class b2BlockAllocator
 {
 public:
-	b2BlockAllocator();
+	/// Chunks and large blocks are taken from the given allocator, or from the
+	/// default allocator if it is NULL, and are counted in the given category.
+	b2BlockAllocator(b2Allocator* allocator = NULL, b2MemoryCategory category = b2_generalMemory);
 	~b2BlockAllocator();
 
-	/// Allocate memory. This will use b2Alloc if the size is larger than b2_maxBlockSize.
+	/// Allocate memory. This will use the heap allocator if the size is larger than b2_maxBlockSize.
 	void* Allocate(int32 size);
 
-	/// Free memory. This will use b2Free if the size is larger than b2_maxBlockSize.
+	/// Free memory. This will use the heap allocator if the size is larger than b2_maxBlockSize.
 	void Free(void* p, int32 size);
 
 	void Clear();
 
+	/// Make sure that count blocks of the given size can be allocated without
+	/// taking memory from the heap allocator. The size must not be larger than
+	/// b2_maxBlockSize. The reserved chunks are kept by Trim, and their idle
+	/// bytes do not count toward the trim threshold.
+	void Reserve(int32 size, int32 count);
+
+	/// Release the chunks that have no block in use, except those held for a
+	/// reservation. The other chunks keep their free blocks. Returns the number
+	/// of bytes released.
+	int32 Trim();
+
+	/// Let AutoTrim release memory once the chunks hold this many more idle bytes
+	/// than the least they held since the last trim. Zero disables this, which is
+	/// the default.
+	void SetTrimThreshold(int32 bytes);
+
+	/// Trim if the idle bytes exceed the trim threshold. This is meant to be called
+	/// at a quiet point, such as the end of a time step. Returns the number of bytes
+	/// released.
+	int32 AutoTrim();
+
+	/// Get the allocator statistics.
+	b2BlockAllocatorStats GetStats() const;
+
 private:
 
+	void AddChunk(int32 index);
+
+	// Idle bytes in chunks, less those held for reservations.
+	int32 GetTrimmableBytes() const;
+
+	b2Allocator* m_heapAllocator;
+	b2MemoryCategory m_category;
+
 	b2Chunk* m_chunks;
 	int32 m_chunkCount;
 	int32 m_chunkSpace;
 
 	b2Block* m_freeLists[b2_blockSizes];
 
+	int32 m_chunkCounts[b2_blockSizes];
+	int32 m_liveCounts[b2_blockSizes];
+	int32 m_reservedCounts[b2_blockSizes];
+	int32 m_liveBytes;
+
+	int32 m_trimThreshold;
+	int32 m_trimmedIdleBytes;
+
 	static int32 s_blockSizes[b2_blockSizes];
 	static uint8 s_blockSizeLookup[b2_maxBlockSize + 1];
 	static bool s_blockSizeLookupInitialized;
@@ -0,0 +1,98 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2HandleTable.h>
+#include <Box2D/Common/b2Math.h>
+#include <memory.h>
+
+b2HandleTable::b2HandleTable(b2Allocator* allocator)
+{
+	m_allocator = allocator ? allocator : b2GetDefaultAllocator();
+	m_entries = NULL;
+	m_count = 0;
+	m_capacity = 0;
+	m_freeList = b2_nullHandle;
+}
+
+b2HandleTable::~b2HandleTable()
+{
+	m_allocator->Free(m_entries, m_capacity * sizeof(b2HandleEntry), b2_generalMemory);
+}
+
+int32 b2HandleTable::Create(void* object)
+{
+	b2Assert(object != NULL);
+
+	if (m_freeList == b2_nullHandle)
+	{
+		Reserve(b2Max(16, 2 * m_capacity));
+	}
+
+	int32 index = m_freeList;
+	b2HandleEntry* entry = m_entries + index;
+	m_freeList = entry->next;
+	entry->object = object;
+	entry->next = b2_nullHandle;
+	++m_count;
+	return index;
+}
+
+void b2HandleTable::Destroy(int32 index)
+{
+	b2Assert(0 <= index && index < m_capacity);
+	b2HandleEntry* entry = m_entries + index;
+	b2Assert(entry->object != NULL);
+
+	// Generation zero is never live, so that a zeroed handle is always stale.
+	++entry->generation;
+	if (entry->generation == 0)
+	{
+		entry->generation = 1;
+	}
+
+	entry->object = NULL;
+	entry->next = m_freeList;
+	m_freeList = index;
+	--m_count;
+}
+
+void b2HandleTable::Reserve(int32 capacity)
+{
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	b2HandleEntry* oldEntries = m_entries;
+	m_entries = (b2HandleEntry*)m_allocator->Allocate(capacity * sizeof(b2HandleEntry), b2_generalMemory);
+	if (m_capacity > 0)
+	{
+		memcpy(m_entries, oldEntries, m_capacity * sizeof(b2HandleEntry));
+	}
+	m_allocator->Free(oldEntries, m_capacity * sizeof(b2HandleEntry), b2_generalMemory);
+
+	// New entries go to the front of the free list, lowest index first.
+	for (int32 i = capacity - 1; i >= m_capacity; --i)
+	{
+		m_entries[i].object = NULL;
+		m_entries[i].generation = 1;
+		m_entries[i].next = i == capacity - 1 ? m_freeList : i + 1;
+	}
+	m_freeList = m_capacity;
+	m_capacity = capacity;
+}
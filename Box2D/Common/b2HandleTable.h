@@ -0,0 +1,107 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_HANDLE_TABLE_H
+#define B2_HANDLE_TABLE_H
+
+#include <Common/b2Allocator.h>
+
+#define b2_nullHandle (-1)
+
+/// A handle entry. A free entry has no object and links to the next free entry.
+struct b2HandleEntry
+{
+	void* object;
+	uint32 generation;
+	int32 next;
+};
+
+/// A table of generational handles. A handle is an index into the table and
+/// the generation of the entry. An index is reused once its object is gone,
+/// but the generation is bumped first, so old handles no longer resolve.
+/// Looking up a handle is a bounds check and a compare.
+/// The table does not care where an object lives, so an object may be moved
+/// as long as its entry is updated.
+class b2HandleTable
+{
+public:
+	b2HandleTable(b2Allocator* allocator);
+	~b2HandleTable();
+
+	/// Create a handle for an object.
+	/// @return the handle index.
+	int32 Create(void* object);
+
+	/// Destroy a handle. The index may be reused by a later Create.
+	void Destroy(int32 index);
+
+	/// Get the object of a handle, or NULL if the handle is stale or null.
+	void* GetObject(int32 index, uint32 generation) const;
+
+	/// Get the generation of a live handle.
+	uint32 GetGeneration(int32 index) const;
+
+	/// Update the object of a handle after the object has been moved.
+	void SetObject(int32 index, void* object);
+
+	/// Make room for this many live handles.
+	void Reserve(int32 capacity);
+
+	/// Get the number of live handles.
+	int32 GetCount() const;
+
+private:
+
+	b2Allocator* m_allocator;
+	b2HandleEntry* m_entries;
+	int32 m_count;
+	int32 m_capacity;
+	int32 m_freeList;
+};
+
+inline void* b2HandleTable::GetObject(int32 index, uint32 generation) const
+{
+	if ((uint32)index >= (uint32)m_capacity)
+	{
+		return NULL;
+	}
+
+	const b2HandleEntry* entry = m_entries + index;
+	return entry->generation == generation ? entry->object : NULL;
+}
+
+inline uint32 b2HandleTable::GetGeneration(int32 index) const
+{
+	b2Assert(0 <= index && index < m_capacity);
+	b2Assert(m_entries[index].object != NULL);
+	return m_entries[index].generation;
+}
+
+inline void b2HandleTable::SetObject(int32 index, void* object)
+{
+	b2Assert(0 <= index && index < m_capacity);
+	b2Assert(m_entries[index].object != NULL && object != NULL);
+	m_entries[index].object = object;
+}
+
+inline int32 b2HandleTable::GetCount() const
+{
+	return m_count;
+}
+
+#endif
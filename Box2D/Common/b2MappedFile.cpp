@@ -0,0 +1,207 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2MappedFile.h>
+
+#if defined(_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+b2MappedFile::b2MappedFile()
+{
+	m_data = NULL;
+	m_size = 0;
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = NULL;
+}
+
+bool b2MappedFile::Open(const char* path)
+{
+	Close();
+
+	m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(m_file, &size) == 0 || size.QuadPart == 0 || size.QuadPart > 0x7fffffff)
+	{
+		Close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mapping == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_data == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	m_size = int32(size.QuadPart);
+	return true;
+}
+
+void b2MappedFile::Close()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+	}
+
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_file);
+	}
+
+	m_data = NULL;
+	m_size = 0;
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = NULL;
+}
+
+#elif defined(__linux__) || defined (__APPLE__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+b2MappedFile::b2MappedFile()
+{
+	m_data = NULL;
+	m_size = 0;
+}
+
+bool b2MappedFile::Open(const char* path)
+{
+	Close();
+
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0 || info.st_size > 0x7fffffff)
+	{
+		close(file);
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	void* data = mmap(NULL, size_t(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	m_data = data;
+	m_size = int32(info.st_size);
+	return true;
+}
+
+void b2MappedFile::Close()
+{
+	if (m_data)
+	{
+		munmap(const_cast<void*>(m_data), size_t(m_size));
+	}
+
+	m_data = NULL;
+	m_size = 0;
+}
+
+#else
+
+#include <stdio.h>
+
+b2MappedFile::b2MappedFile()
+{
+	m_data = NULL;
+	m_size = 0;
+}
+
+bool b2MappedFile::Open(const char* path)
+{
+	Close();
+
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size <= 0 || size > 0x7fffffff)
+	{
+		fclose(file);
+		return false;
+	}
+
+	void* data = b2Alloc(int32(size));
+	if (fread(data, 1, size_t(size), file) != size_t(size))
+	{
+		b2Free(data);
+		fclose(file);
+		return false;
+	}
+
+	fclose(file);
+
+	m_data = data;
+	m_size = int32(size);
+	return true;
+}
+
+void b2MappedFile::Close()
+{
+	if (m_data)
+	{
+		b2Free(const_cast<void*>(m_data));
+	}
+
+	m_data = NULL;
+	m_size = 0;
+}
+
+#endif
+
+b2MappedFile::~b2MappedFile()
+{
+	Close();
+}
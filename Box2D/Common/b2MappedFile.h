@@ -0,0 +1,67 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_MAPPED_FILE_H
+#define B2_MAPPED_FILE_H
+
+#include <Common/b2Settings.h>
+
+/// A whole file mapped read-only into memory. The pages are loaded by the
+/// operating system on first touch, so opening a large file is cheap. This has
+/// platform specific code. On other platforms the file is read into memory.
+class b2MappedFile
+{
+public:
+	b2MappedFile();
+	~b2MappedFile();
+
+	/// Map a file. Any file that is already open is closed first.
+	/// @return false if the file cannot be opened or is empty.
+	bool Open(const char* path);
+
+	/// Unmap the file. The data is no longer valid after this.
+	void Close();
+
+	/// Get the file contents, or NULL if no file is open.
+	const void* GetData() const;
+
+	/// Get the file size in bytes.
+	int32 GetSize() const;
+
+private:
+
+	const void* m_data;
+	int32 m_size;
+
+#if defined(_WIN32)
+	void* m_file;
+	void* m_mapping;
+#endif
+};
+
+inline const void* b2MappedFile::GetData() const
+{
+	return m_data;
+}
+
+inline int32 b2MappedFile::GetSize() const
+{
+	return m_size;
+}
+
+#endif
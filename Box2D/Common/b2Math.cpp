@@ -18,6 +18,11 @@
 
 #include <Box2D/Common/b2Math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 const b2Vec2 b2Vec2_zero(0.0f, 0.0f);
 
 /// Solve A * x = b, where b is a column vector. This is more efficient
@@ -92,3 +97,98 @@ void b2Mat33::GetSymInverse33(b2Mat33* M) const
 	M->ez.y = M->ey.z;
 	M->ez.z = det * (a11 * a22 - a12 * a12);
 }
+
+// The angle is reduced by a multiple of pi / 2 that is subtracted in three parts,
+// so the product with the first parts is exact. The sine and cosine of the
+// remainder in [-pi / 4, pi / 4] are polynomials and the quadrant selects and
+// negates them.
+static const float32 b2_twoOverPi = 0.636619772f;
+static const float32 b2_halfPi1 = 1.5703125f;
+static const float32 b2_halfPi2 = 4.837512969970703125e-4f;
+static const float32 b2_halfPi3 = 7.54978995489188216e-8f;
+
+static const float32 b2_sin1 = -1.6666654611e-1f;
+static const float32 b2_sin2 = 8.3321608736e-3f;
+static const float32 b2_sin3 = -1.9515295891e-4f;
+static const float32 b2_cos1 = 4.166664568298827e-2f;
+static const float32 b2_cos2 = -1.388731625493765e-3f;
+static const float32 b2_cos3 = 2.443315711809948e-5f;
+
+void b2SinCos(const float32* angles, b2Rot* rotations, int32 count)
+{
+	for (int32 i = 0; i < count; i += b2_simdLanes)
+	{
+		int32 laneCount = b2Min(count - i, b2_simdLanes);
+
+		float32 x[b2_simdLanes];
+		for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+		{
+			x[lane] = lane < laneCount ? angles[i + lane] : 0.0f;
+		}
+
+		float32 s[b2_simdLanes], c[b2_simdLanes];
+
+#if defined(B2_USE_SSE2)
+		__m128 angle = _mm_loadu_ps(x);
+		__m128i k = _mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(b2_twoOverPi)));
+		__m128 kf = _mm_cvtepi32_ps(k);
+
+		__m128 r = _mm_sub_ps(angle, _mm_mul_ps(kf, _mm_set1_ps(b2_halfPi1)));
+		r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(b2_halfPi2)));
+		r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(b2_halfPi3)));
+		__m128 z = _mm_mul_ps(r, r);
+
+		__m128 sr = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(b2_sin3), z), _mm_set1_ps(b2_sin2));
+		sr = _mm_add_ps(_mm_mul_ps(sr, z), _mm_set1_ps(b2_sin1));
+		sr = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sr, z), r), r);
+
+		__m128 cr = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(b2_cos3), z), _mm_set1_ps(b2_cos2));
+		cr = _mm_add_ps(_mm_mul_ps(cr, z), _mm_set1_ps(b2_cos1));
+		cr = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(cr, z), z), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.0f));
+
+		// Odd quadrants swap sine and cosine. The sine is negated in quadrants 2
+		// and 3, the cosine in quadrants 1 and 2.
+		__m128i one = _mm_set1_epi32(1);
+		__m128i two = _mm_set1_epi32(2);
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(k, one), one));
+		__m128 sine = _mm_or_ps(_mm_and_ps(swap, cr), _mm_andnot_ps(swap, sr));
+		__m128 cosine = _mm_or_ps(_mm_and_ps(swap, sr), _mm_andnot_ps(swap, cr));
+		__m128 signS = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(k, two), 30));
+		__m128 signC = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(k, one), two), 30));
+
+		_mm_storeu_ps(s, _mm_xor_ps(sine, signS));
+		_mm_storeu_ps(c, _mm_xor_ps(cosine, signC));
+#else
+		for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+		{
+			float32 kf = floorf(x[lane] * b2_twoOverPi + 0.5f);
+			int32 k = int32(kf);
+
+			float32 r = x[lane] - kf * b2_halfPi1;
+			r -= kf * b2_halfPi2;
+			r -= kf * b2_halfPi3;
+			float32 z = r * r;
+
+			float32 sr = ((b2_sin3 * z + b2_sin2) * z + b2_sin1) * z * r + r;
+			float32 cr = ((b2_cos3 * z + b2_cos2) * z + b2_cos1) * z * z - 0.5f * z + 1.0f;
+
+			s[lane] = (k & 1) ? cr : sr;
+			c[lane] = (k & 1) ? sr : cr;
+			if (k & 2)
+			{
+				s[lane] = -s[lane];
+			}
+			if ((k + 1) & 2)
+			{
+				c[lane] = -c[lane];
+			}
+		}
+#endif
+
+		for (int32 lane = 0; lane < laneCount; ++lane)
+		{
+			rotations[i + lane].s = s[lane];
+			rotations[i + lane].c = c[lane];
+		}
+	}
+}
@@ -689,6 +689,37 @@ inline bool b2IsPowerOfTwo(uint32 x)
 	return result;
 }
 
+/// Rotate q by a small angle without evaluating sine and cosine. The sine and
+/// cosine of the angle are expanded in series and the result is normalized
+/// again. Angles beyond half a radian use the trigonometric functions.
+inline b2Rot b2IntegrateRotation(const b2Rot& q, float32 angle)
+{
+	b2Rot dq;
+	if (b2Abs(angle) <= 0.5f)
+	{
+		float32 x2 = angle * angle;
+		dq.s = angle * (1.0f - x2 * (1.0f / 6.0f) * (1.0f - x2 * (1.0f / 20.0f) * (1.0f - x2 * (1.0f / 42.0f))));
+		dq.c = 1.0f - x2 * 0.5f * (1.0f - x2 * (1.0f / 12.0f) * (1.0f - x2 * (1.0f / 30.0f) * (1.0f - x2 * (1.0f / 56.0f))));
+	}
+	else
+	{
+		dq.Set(angle);
+	}
+
+	b2Rot qr = b2Mul(q, dq);
+
+	// One Newton step towards unit length is exact to rounding here.
+	float32 scale = 0.5f * (3.0f - qr.s * qr.s - qr.c * qr.c);
+	qr.s *= scale;
+	qr.c *= scale;
+	return qr;
+}
+
+/// Compute the rotations of many angles at once. This uses SIMD lanes where
+/// available and is accurate to a few units in the last place for angles of
+/// up to about 10^4 radians.
+void b2SinCos(const float32* angles, b2Rot* rotations, int32 count);
+
 inline void b2Sweep::GetTransform(b2Transform* xf, float32 beta) const
 {
 	xf->p = (1.0f - beta) * c0 + beta * c;
@@ -26,6 +26,16 @@
 #define B2_NOT_USED(x) ((void)(x))
 #define b2Assert(A) assert(A)
 
+/// Storage class of the collision statistics. Collision routines may run on the
+/// worker threads of a b2TaskScheduler, so each thread keeps its own counts.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define b2_threadLocal __declspec(thread)
+#elif defined(__GNUC__) && __cplusplus < 201103L
+#define b2_threadLocal __thread
+#else
+#define b2_threadLocal thread_local
+#endif
+
 typedef signed char	int8;
 typedef signed short int16;
 typedef signed int int32;
@@ -53,6 +63,10 @@ typedef double float64;
 /// this too much because b2BlockAllocator has a maximum object size.
 #define b2_maxPolygonVertices	8
 
+/// The number of contact pairs handled together by the wide (SIMD) collision
+/// kernels. This matches the width of an SSE register.
+#define b2_simdLanes			4
+
 /// This is used to fatten AABBs in the dynamic tree. This allows proxies
 /// to move by a small amount without triggering a tree adjustment.
 /// This is in meters.
@@ -79,6 +93,10 @@ typedef double float64;
 /// Maximum number of sub-steps per contact in continuous physics simulation.
 #define b2_maxSubSteps			8
 
+/// The smallest margin of speculative contacts. Their margin grows with the speed
+/// of the bodies. This is in meters.
+#define b2_speculativeDistance	(4.0f * b2_linearSlop)
+
 
 // Dynamics
 
@@ -89,6 +107,14 @@ typedef double float64;
 /// velocity below this threshold will be treated as inelastic.
 #define b2_velocityThreshold		1.0f
 
+/// The stiffness of contacts in the soft step solver, in cycles per second. It is
+/// limited to a quarter of the substep rate.
+#define b2_contactHertz				30.0f
+
+/// The damping ratio of contacts in the soft step solver. Contacts are heavily
+/// overdamped so that pushing shapes apart does not add energy.
+#define b2_contactDampingRatio		10.0f
+
 /// The maximum linear position correction used when solving constraints. This helps to
 /// prevent overshoot.
 #define b2_maxLinearCorrection		0.2f
@@ -113,6 +139,34 @@ typedef double float64;
 #define b2_baumgarte				0.2f
 #define b2_toiBaugarte				0.75f
 
+/// The velocity solver may stop iterating once an iteration changes no body velocity
+/// by more than this tolerance.
+#define b2_linearVelocityTolerance	0.001f
+
+/// The velocity solver may stop iterating once an iteration changes no body angular
+/// velocity by more than this tolerance.
+#define b2_angularVelocityTolerance	(0.2f / 180.0f * b2_pi)
+
+/// The number of buckets in the per-island velocity iteration histogram of b2Profile.
+/// The last bucket also counts islands that used more iterations.
+#define b2_iterationHistogramSize	16
+
+/// The direct joint solver takes an island only if its joints produce at most this
+/// many velocity rows.
+#define b2_maxDirectJointRows		32
+
+/// Revolute joints are solved in batches of b2_simdLanes once an island has at least
+/// this many of them. Fewer joints are solved one at a time.
+#define b2_minJointBatchCount		16
+
+/// The number of colors used to group batched joints. Joints beyond that are solved
+/// one at a time. This must not exceed 32.
+#define b2_maxJointColors			32
+
+/// With rotation integration the body rotations are set from the body angles again
+/// after this many steps.
+#define b2_rotationSyncInterval		64
+
 
 // Sleep
 
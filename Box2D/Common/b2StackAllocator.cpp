@@ -18,12 +18,22 @@
 
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Math.h>
+#include <memory.h>
 
-b2StackAllocator::b2StackAllocator()
+b2StackAllocator::b2StackAllocator(b2Allocator* allocator)
 {
+	m_heapAllocator = allocator ? allocator : b2GetDefaultAllocator();
+
+	m_capacity = b2_stackSize;
+	m_data = (char*)m_heapAllocator->Allocate(m_capacity, b2_solverMemory);
 	m_index = 0;
+
 	m_allocation = 0;
 	m_maxAllocation = 0;
+	m_fallbackCount = 0;
+
+	m_entryCapacity = b2_maxStackEntries;
+	m_entries = (b2StackEntry*)m_heapAllocator->Allocate(m_entryCapacity * sizeof(b2StackEntry), b2_solverMemory);
 	m_entryCount = 0;
 }
 
@@ -31,18 +41,33 @@ b2StackAllocator::~b2StackAllocator()
 {
 	b2Assert(m_index == 0);
 	b2Assert(m_entryCount == 0);
+
+	m_heapAllocator->Free(m_entries, m_entryCapacity * sizeof(b2StackEntry), b2_solverMemory);
+	m_heapAllocator->Free(m_data, m_capacity, b2_solverMemory);
 }
 
 void* b2StackAllocator::Allocate(int32 size)
 {
-	b2Assert(m_entryCount < b2_maxStackEntries);
+	// Entries only describe the allocations, so they can move at any time.
+	if (m_entryCount == m_entryCapacity)
+	{
+		b2StackEntry* oldEntries = m_entries;
+		m_entryCapacity *= 2;
+		m_entries = (b2StackEntry*)m_heapAllocator->Allocate(m_entryCapacity * sizeof(b2StackEntry), b2_solverMemory);
+		memcpy(m_entries, oldEntries, m_entryCount * sizeof(b2StackEntry));
+		m_heapAllocator->Free(oldEntries, m_entryCount * sizeof(b2StackEntry), b2_solverMemory);
+	}
+
+	// Round up so every block stays aligned for pointers.
+	size = (size + 7) & ~7;
 
 	b2StackEntry* entry = m_entries + m_entryCount;
 	entry->size = size;
-	if (m_index + size > b2_stackSize)
+	if (m_index + size > m_capacity)
 	{
-		entry->data = (char*)b2Alloc(size);
+		entry->data = (char*)m_heapAllocator->Allocate(size, b2_solverMemory);
 		entry->usedMalloc = true;
+		++m_fallbackCount;
 	}
 	else
 	{
@@ -65,7 +90,7 @@ void b2StackAllocator::Free(void* p)
 	b2Assert(p == entry->data);
 	if (entry->usedMalloc)
 	{
-		b2Free(p);
+		m_heapAllocator->Free(p, entry->size, b2_solverMemory);
 	}
 	else
 	{
@@ -74,10 +99,39 @@ void b2StackAllocator::Free(void* p)
 	m_allocation -= entry->size;
 	--m_entryCount;
 
+	// Nothing points into the stack now, so it can grow to what was needed.
+	if (m_entryCount == 0 && m_maxAllocation > m_capacity)
+	{
+		Reserve(b2Max(m_maxAllocation, m_capacity + m_capacity / 2));
+	}
+
 	p = NULL;
 }
 
+void b2StackAllocator::Reserve(int32 size)
+{
+	b2Assert(m_entryCount == 0);
+	if (size <= m_capacity)
+	{
+		return;
+	}
+
+	m_heapAllocator->Free(m_data, m_capacity, b2_solverMemory);
+	m_capacity = size;
+	m_data = (char*)m_heapAllocator->Allocate(m_capacity, b2_solverMemory);
+}
+
 int32 b2StackAllocator::GetMaxAllocation() const
 {
 	return m_maxAllocation;
 }
+
+int32 b2StackAllocator::GetFallbackCount() const
+{
+	return m_fallbackCount;
+}
+
+int32 b2StackAllocator::GetCapacity() const
+{
+	return m_capacity;
+}
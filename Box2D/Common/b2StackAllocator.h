@@ -19,10 +19,10 @@
 #ifndef B2_STACK_ALLOCATOR_H
 #define B2_STACK_ALLOCATOR_H
 
-#include <Common/b2Settings.h>
+#include <Common/b2Allocator.h>
 
-const int32 b2_stackSize = 100 * 1024;	// 100k
-const int32 b2_maxStackEntries = 32;
+const int32 b2_stackSize = 100 * 1024;	// 100k, initial size
+const int32 b2_maxStackEntries = 32;	// initial entry capacity
 
 struct b2StackEntry
 {
@@ -34,27 +34,48 @@ struct b2StackEntry
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+// Allocations that do not fit fall back to the heap allocator. Once the stack
+// is empty again it grows to the largest allocation seen, so that a steady
+// workload stops falling back after the first step that needs more memory.
 class b2StackAllocator
 {
 public:
-	b2StackAllocator();
+	/// Memory is taken from the given allocator, or from the default allocator
+	/// if it is NULL.
+	b2StackAllocator(b2Allocator* allocator = NULL);
 	~b2StackAllocator();
 
 	void* Allocate(int32 size);
 	void Free(void* p);
 
+	/// Grow the stack to hold at least the given number of bytes. The stack must
+	/// be empty.
+	void Reserve(int32 size);
+
+	/// Get the most bytes allocated at once.
 	int32 GetMaxAllocation() const;
 
+	/// Get the number of allocations that did not fit and used the heap allocator.
+	int32 GetFallbackCount() const;
+
+	/// Get the size of the stack in bytes.
+	int32 GetCapacity() const;
+
 private:
 
-	char m_data[b2_stackSize];
+	b2Allocator* m_heapAllocator;
+
+	char* m_data;
+	int32 m_capacity;
 	int32 m_index;
 
 	int32 m_allocation;
 	int32 m_maxAllocation;
+	int32 m_fallbackCount;
 
-	b2StackEntry m_entries[b2_maxStackEntries];
+	b2StackEntry* m_entries;
 	int32 m_entryCount;
+	int32 m_entryCapacity;
 };
 
 #endif
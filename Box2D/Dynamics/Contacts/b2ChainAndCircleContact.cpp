@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h>
 #include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
@@ -45,9 +46,22 @@ b2ChainAndCircleContact::b2ChainAndCircleContact(b2Fixture* fixtureA, int32 inde
 
 void b2ChainAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
 {
-	b2ChainShape* chain = (b2ChainShape*)m_fixtureA->GetShape();
+	const b2ChainShape* chain = (const b2ChainShape*)GetShapeA();
 	b2EdgeShape edge;
 	chain->GetChildEdge(&edge, m_indexA);
 	b2CollideEdgeAndCircle(	manifold, &edge, xfA,
-							(b2CircleShape*)m_fixtureB->GetShape(), xfB);
+							(const b2CircleShape*)GetShapeB(), xfB, m_speculativeMargin);
+}
+
+void b2ChainAndCircleContact::EvaluateBatch(b2Contact** contacts, int32 count)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2ChainAndCircleContact* contact = (b2ChainAndCircleContact*)contacts[i];
+		const b2Transform& xfA = contact->m_fixtureA->GetBody()->GetTransform();
+		const b2Transform& xfB = contact->m_fixtureB->GetBody()->GetTransform();
+
+		// Qualified call, so there is no virtual dispatch inside the batch.
+		contact->b2ChainAndCircleContact::Evaluate(&contact->m_manifold, xfA, xfB);
+	}
 }
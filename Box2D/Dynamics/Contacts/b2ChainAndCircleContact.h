@@ -29,6 +29,7 @@ public:
 	static b2Contact* Create(	b2Fixture* fixtureA, int32 indexA,
 								b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
+	static void EvaluateBatch(b2Contact** contacts, int32 count);
 
 	b2ChainAndCircleContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
 	~b2ChainAndCircleContact() {}
@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/Contacts/b2ChainAndPolygonContact.h>
 #include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
@@ -45,9 +46,22 @@ b2ChainAndPolygonContact::b2ChainAndPolygonContact(b2Fixture* fixtureA, int32 in
 
 void b2ChainAndPolygonContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
 {
-	b2ChainShape* chain = (b2ChainShape*)m_fixtureA->GetShape();
+	const b2ChainShape* chain = (const b2ChainShape*)GetShapeA();
 	b2EdgeShape edge;
 	chain->GetChildEdge(&edge, m_indexA);
 	b2CollideEdgeAndPolygon(	manifold, &edge, xfA,
-								(b2PolygonShape*)m_fixtureB->GetShape(), xfB);
+								(const b2PolygonShape*)GetShapeB(), xfB, m_speculativeMargin);
+}
+
+void b2ChainAndPolygonContact::EvaluateBatch(b2Contact** contacts, int32 count)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2ChainAndPolygonContact* contact = (b2ChainAndPolygonContact*)contacts[i];
+		const b2Transform& xfA = contact->m_fixtureA->GetBody()->GetTransform();
+		const b2Transform& xfB = contact->m_fixtureB->GetBody()->GetTransform();
+
+		// Qualified call, so there is no virtual dispatch inside the batch.
+		contact->b2ChainAndPolygonContact::Evaluate(&contact->m_manifold, xfA, xfB);
+	}
 }
@@ -22,6 +22,7 @@
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
 
 #include <new>
 
@@ -47,6 +48,47 @@ b2CircleContact::b2CircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
 void b2CircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
 {
 	b2CollideCircles(manifold,
-					(b2CircleShape*)m_fixtureA->GetShape(), xfA,
-					(b2CircleShape*)m_fixtureB->GetShape(), xfB);
+					(const b2CircleShape*)GetShapeA(), xfA,
+					(const b2CircleShape*)GetShapeB(), xfB, m_speculativeMargin);
+}
+
+void b2CircleContact::EvaluateBatch(b2Contact** contacts, int32 count)
+{
+	int32 i = 0;
+
+	// Full groups of lanes go through the wide kernel.
+	for (; i + b2_simdLanes <= count; i += b2_simdLanes)
+	{
+		b2Manifold* manifolds[b2_simdLanes];
+		b2CircleLanes circlesA, circlesB;
+		b2TransformLanes xfA, xfB;
+		float32 margins[b2_simdLanes];
+
+		for (int32 j = 0; j < b2_simdLanes; ++j)
+		{
+			b2CircleContact* contact = (b2CircleContact*)contacts[i + j];
+			const b2CircleShape* circleA = (const b2CircleShape*)contact->GetShapeA();
+			const b2CircleShape* circleB = (const b2CircleShape*)contact->GetShapeB();
+
+			manifolds[j] = &contact->m_manifold;
+			circlesA.Set(j, circleA->m_p, circleA->m_radius);
+			circlesB.Set(j, circleB->m_p, circleB->m_radius);
+			margins[j] = contact->m_speculativeMargin;
+			xfA.Set(j, contact->m_fixtureA->GetBody()->GetTransform());
+			xfB.Set(j, contact->m_fixtureB->GetBody()->GetTransform());
+		}
+
+		b2CollideCirclesWide(manifolds, circlesA, xfA, circlesB, xfB, margins);
+	}
+
+	// Handle the remainder one at a time.
+	for (; i < count; ++i)
+	{
+		b2CircleContact* contact = (b2CircleContact*)contacts[i];
+		const b2Transform& xfA = contact->m_fixtureA->GetBody()->GetTransform();
+		const b2Transform& xfB = contact->m_fixtureB->GetBody()->GetTransform();
+
+		// Qualified call, so there is no virtual dispatch inside the batch.
+		contact->b2CircleContact::Evaluate(&contact->m_manifold, xfA, xfB);
+	}
 }
@@ -24,6 +24,9 @@
 #include <Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndPolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2CapsuleAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2CapsuleContact.h>
+#include <Box2D/Dynamics/Contacts/b2PolygonAndCapsuleContact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 
 #include <Box2D/Collision/b2Collision.h>
@@ -39,16 +42,20 @@ bool b2Contact::s_initialized = false;
 
 void b2Contact::InitializeRegisters()
 {
-	AddType(b2CircleContact::Create, b2CircleContact::Destroy, b2Shape::e_circle, b2Shape::e_circle);
-	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, b2Shape::e_polygon, b2Shape::e_circle);
-	AddType(b2PolygonContact::Create, b2PolygonContact::Destroy, b2Shape::e_polygon, b2Shape::e_polygon);
-	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, b2Shape::e_edge, b2Shape::e_circle);
-	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
-	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
-	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2CircleContact::Create, b2CircleContact::Destroy, b2CircleContact::EvaluateBatch, b2Shape::e_circle, b2Shape::e_circle);
+	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, b2PolygonAndCircleContact::EvaluateBatch, b2Shape::e_polygon, b2Shape::e_circle);
+	AddType(b2PolygonContact::Create, b2PolygonContact::Destroy, b2PolygonContact::EvaluateBatch, b2Shape::e_polygon, b2Shape::e_polygon);
+	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, b2EdgeAndCircleContact::EvaluateBatch, b2Shape::e_edge, b2Shape::e_circle);
+	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2EdgeAndPolygonContact::EvaluateBatch, b2Shape::e_edge, b2Shape::e_polygon);
+	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2ChainAndCircleContact::EvaluateBatch, b2Shape::e_chain, b2Shape::e_circle);
+	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2ChainAndPolygonContact::EvaluateBatch, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2CapsuleAndCircleContact::Create, b2CapsuleAndCircleContact::Destroy, b2CapsuleAndCircleContact::EvaluateBatch, b2Shape::e_capsule, b2Shape::e_circle);
+	AddType(b2CapsuleContact::Create, b2CapsuleContact::Destroy, b2CapsuleContact::EvaluateBatch, b2Shape::e_capsule, b2Shape::e_capsule);
+	AddType(b2PolygonAndCapsuleContact::Create, b2PolygonAndCapsuleContact::Destroy, b2PolygonAndCapsuleContact::EvaluateBatch, b2Shape::e_polygon, b2Shape::e_capsule);
 }
 
 void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
+						b2ContactEvaluateFcn* evaluateFcn,
 						b2Shape::Type type1, b2Shape::Type type2)
 {
 	b2Assert(0 <= type1 && type1 < b2Shape::e_typeCount);
@@ -56,12 +63,14 @@ void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* dest
 	
 	s_registers[type1][type2].createFcn = createFcn;
 	s_registers[type1][type2].destroyFcn = destoryFcn;
+	s_registers[type1][type2].evaluateFcn = evaluateFcn;
 	s_registers[type1][type2].primary = true;
 
 	if (type1 != type2)
 	{
 		s_registers[type2][type1].createFcn = createFcn;
 		s_registers[type2][type1].destroyFcn = destoryFcn;
+		s_registers[type2][type1].evaluateFcn = evaluateFcn;
 		s_registers[type2][type1].primary = false;
 	}
 }
@@ -133,7 +142,10 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_indexA = indexA;
 	m_indexB = indexB;
 
+	m_batchIndex = -1;
+
 	m_manifold.pointCount = 0;
+	m_speculativeMargin = 0.0f;
 
 	m_prev = NULL;
 	m_next = NULL;
@@ -149,6 +161,8 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_nodeB.other = NULL;
 
 	m_toiCount = 0;
+	m_toiIndex = -1;
+	m_creationStamp = 0;
 
 	m_friction = b2MixFriction(m_fixtureA->m_friction, m_fixtureB->m_friction);
 	m_restitution = b2MixRestitution(m_fixtureA->m_restitution, m_fixtureB->m_restitution);
@@ -162,11 +176,26 @@ void b2Contact::Update(b2ContactListener* listener)
 {
 	b2Manifold oldManifold = m_manifold;
 
+	// Sensors don't generate manifolds.
+	if (m_fixtureA->IsSensor() == false && m_fixtureB->IsSensor() == false)
+	{
+		const b2Transform& xfA = m_fixtureA->GetBody()->GetTransform();
+		const b2Transform& xfB = m_fixtureB->GetBody()->GetTransform();
+		Evaluate(&m_manifold, xfA, xfB);
+	}
+
+	FinishUpdate(oldManifold, listener);
+}
+
+void b2Contact::FinishUpdate(const b2Manifold& oldManifold, b2ContactListener* listener)
+{
 	// Re-enable this contact.
 	m_flags |= e_enabledFlag;
 
 	bool touching = false;
+	bool speculative = false;
 	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
+	bool wasSolid = (m_flags & (e_touchingFlag | e_speculativeFlag)) != 0;
 
 	bool sensorA = m_fixtureA->IsSensor();
 	bool sensorB = m_fixtureB->IsSensor();
@@ -174,14 +203,14 @@ void b2Contact::Update(b2ContactListener* listener)
 
 	b2Body* bodyA = m_fixtureA->GetBody();
 	b2Body* bodyB = m_fixtureB->GetBody();
-	const b2Transform& xfA = bodyA->GetTransform();
-	const b2Transform& xfB = bodyB->GetTransform();
 
 	// Is this contact a sensor?
 	if (sensor)
 	{
-		const b2Shape* shapeA = m_fixtureA->GetShape();
-		const b2Shape* shapeB = m_fixtureB->GetShape();
+		const b2Shape* shapeA = GetShapeA();
+		const b2Shape* shapeB = GetShapeB();
+		const b2Transform& xfA = bodyA->GetTransform();
+		const b2Transform& xfB = bodyB->GetTransform();
 		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
 
 		// Sensors don't generate manifolds.
@@ -189,9 +218,29 @@ void b2Contact::Update(b2ContactListener* listener)
 	}
 	else
 	{
-		Evaluate(&m_manifold, xfA, xfB);
+		// The manifold has already been evaluated.
 		touching = m_manifold.pointCount > 0;
 
+		// Speculative points can belong to shapes that are still apart. These
+		// go to the solver but do not count as touching.
+		if (touching && m_speculativeMargin > 0.0f)
+		{
+			b2WorldManifold worldManifold;
+			worldManifold.Initialize(&m_manifold, bodyA->GetTransform(), GetShapeA()->m_radius,
+									 bodyB->GetTransform(), GetShapeB()->m_radius);
+
+			touching = false;
+			for (int32 i = 0; i < m_manifold.pointCount; ++i)
+			{
+				if (worldManifold.separations[i] <= 0.0f)
+				{
+					touching = true;
+				}
+			}
+
+			speculative = touching == false;
+		}
+
 		// Match old contact ids to new contact ids and copy the
 		// stored impulses to warm start the solver.
 		for (int32 i = 0; i < m_manifold.pointCount; ++i)
@@ -203,7 +252,7 @@ void b2Contact::Update(b2ContactListener* listener)
 
 			for (int32 j = 0; j < oldManifold.pointCount; ++j)
 			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
+				const b2ManifoldPoint* mp1 = oldManifold.points + j;
 
 				if (mp1->id.key == id2.key)
 				{
@@ -214,7 +263,7 @@ void b2Contact::Update(b2ContactListener* listener)
 			}
 		}
 
-		if (touching != wasTouching)
+		if ((touching || speculative) != wasSolid)
 		{
 			bodyA->SetAwake(true);
 			bodyB->SetAwake(true);
@@ -230,6 +279,15 @@ void b2Contact::Update(b2ContactListener* listener)
 		m_flags &= ~e_touchingFlag;
 	}
 
+	if (speculative)
+	{
+		m_flags |= e_speculativeFlag;
+	}
+	else
+	{
+		m_flags &= ~e_speculativeFlag;
+	}
+
 	if (wasTouching == false && touching == true && listener)
 	{
 		listener->BeginContact(this);
@@ -240,7 +298,7 @@ void b2Contact::Update(b2ContactListener* listener)
 		listener->EndContact(this);
 	}
 
-	if (sensor == false && touching && listener)
+	if (sensor == false && (touching || speculative) && listener)
 	{
 		listener->PreSolve(this, &oldManifold);
 	}
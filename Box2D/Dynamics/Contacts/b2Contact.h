@@ -51,10 +51,15 @@ typedef b2Contact* b2ContactCreateFcn(	b2Fixture* fixtureA, int32 indexA,
 										b2BlockAllocator* allocator);
 typedef void b2ContactDestroyFcn(b2Contact* contact, b2BlockAllocator* allocator);
 
+/// Batch narrow-phase kernel. Updates the manifolds of a homogeneous array of
+/// contacts that all share the same shape type pair.
+typedef void b2ContactEvaluateFcn(b2Contact** contacts, int32 count);
+
 struct b2ContactRegister
 {
 	b2ContactCreateFcn* createFcn;
 	b2ContactDestroyFcn* destroyFcn;
+	b2ContactEvaluateFcn* evaluateFcn;
 	bool primary;
 };
 
@@ -150,6 +155,7 @@ protected:
 	friend class b2ContactSolver;
 	friend class b2Body;
 	friend class b2Fixture;
+	friend class b2TOIQueue;
 
 	// Flags stored in m_flags
 	enum
@@ -170,13 +176,17 @@ protected:
 		e_bulletHitFlag		= 0x0010,
 
 		// This contact has a valid TOI in m_toi
-		e_toiFlag			= 0x0020
+		e_toiFlag			= 0x0020,
+
+		// Set when the manifold has points but the shapes are not touching yet.
+		e_speculativeFlag	= 0x0040
 	};
 
 	/// Flag this contact for filtering. Filtering will occur the next time step.
 	void FlagForFiltering();
 
 	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn,
+						b2ContactEvaluateFcn* evaluateFcn,
 						b2Shape::Type typeA, b2Shape::Type typeB);
 	static void InitializeRegisters();
 	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
@@ -189,6 +199,15 @@ protected:
 
 	void Update(b2ContactListener* listener);
 
+	// Update the touching state and report listener events once the manifold
+	// has been evaluated. This is split from Update so the contact manager can
+	// evaluate manifolds in per-type batches.
+	void FinishUpdate(const b2Manifold& oldManifold, b2ContactListener* listener);
+
+	// The shapes of the fixtures. They may be shared, so they are read only.
+	const b2Shape* GetShapeA() const;
+	const b2Shape* GetShapeB() const;
+
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
 
@@ -208,11 +227,24 @@ protected:
 	int32 m_indexA;
 	int32 m_indexB;
 
+	// Index into the contact manager's batch for this shape type pair.
+	int32 m_batchIndex;
+
 	b2Manifold m_manifold;
 
+	// The manifold includes points of shapes that are up to this far apart.
+	// Zero unless the world uses speculative contacts.
+	float32 m_speculativeMargin;
+
 	int32 m_toiCount;
 	float32 m_toi;
 
+	// Index into the world's TOI queue, or -1.
+	int32 m_toiIndex;
+
+	// Increases with creation order.
+	uint32 m_creationStamp;
+
 	float32 m_friction;
 	float32 m_restitution;
 
@@ -229,12 +261,22 @@ inline const b2Manifold* b2Contact::GetManifold() const
 	return &m_manifold;
 }
 
+inline const b2Shape* b2Contact::GetShapeA() const
+{
+	return m_fixtureA->m_shape;
+}
+
+inline const b2Shape* b2Contact::GetShapeB() const
+{
+	return m_fixtureB->m_shape;
+}
+
 inline void b2Contact::GetWorldManifold(b2WorldManifold* worldManifold) const
 {
 	const b2Body* bodyA = m_fixtureA->GetBody();
 	const b2Body* bodyB = m_fixtureB->GetBody();
-	const b2Shape* shapeA = m_fixtureA->GetShape();
-	const b2Shape* shapeB = m_fixtureB->GetShape();
+	const b2Shape* shapeA = GetShapeA();
+	const b2Shape* shapeB = GetShapeB();
 
 	worldManifold->Initialize(&m_manifold, bodyA->GetTransform(), shapeA->m_radius, bodyB->GetTransform(), shapeB->m_radius);
 }
@@ -59,8 +59,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 		b2Fixture* fixtureA = contact->m_fixtureA;
 		b2Fixture* fixtureB = contact->m_fixtureB;
-		b2Shape* shapeA = fixtureA->GetShape();
-		b2Shape* shapeB = fixtureB->GetShape();
+		const b2Shape* shapeA = contact->GetShapeA();
+		const b2Shape* shapeB = contact->GetShapeB();
 		float32 radiusA = shapeA->m_radius;
 		float32 radiusB = shapeB->m_radius;
 		b2Body* bodyA = fixtureA->GetBody();
@@ -74,8 +74,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		vc->friction = contact->m_friction;
 		vc->restitution = contact->m_restitution;
 		vc->tangentSpeed = contact->m_tangentSpeed;
-		vc->indexA = bodyA->m_islandIndex;
-		vc->indexB = bodyB->m_islandIndex;
+		vc->indexA = bodyA->m_slot;
+		vc->indexB = bodyB->m_slot;
 		vc->invMassA = bodyA->m_invMass;
 		vc->invMassB = bodyB->m_invMass;
 		vc->invIA = bodyA->m_invI;
@@ -86,12 +86,12 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		vc->normalMass.SetZero();
 
 		b2ContactPositionConstraint* pc = m_positionConstraints + i;
-		pc->indexA = bodyA->m_islandIndex;
-		pc->indexB = bodyB->m_islandIndex;
+		pc->indexA = bodyA->m_slot;
+		pc->indexB = bodyB->m_slot;
 		pc->invMassA = bodyA->m_invMass;
 		pc->invMassB = bodyB->m_invMass;
-		pc->localCenterA = bodyA->m_sweep.localCenter;
-		pc->localCenterB = bodyB->m_sweep.localCenter;
+		pc->localCenterA = bodyA->m_sweep->localCenter;
+		pc->localCenterB = bodyB->m_sweep->localCenter;
 		pc->invIA = bodyA->m_invI;
 		pc->invIB = bodyB->m_invI;
 		pc->localNormal = manifold->localNormal;
@@ -144,7 +144,9 @@ void b2ContactSolver::InitializeVelocityConstraints()
 
 		float32 radiusA = pc->radiusA;
 		float32 radiusB = pc->radiusB;
-		b2Manifold* manifold = m_contacts[vc->contactIndex]->GetManifold();
+		b2Contact* contact = m_contacts[vc->contactIndex];
+		b2Manifold* manifold = contact->GetManifold();
+		bool speculative = contact->m_speculativeMargin > 0.0f;
 
 		int32 indexA = vc->indexA;
 		int32 indexB = vc->indexB;
@@ -178,6 +180,8 @@ void b2ContactSolver::InitializeVelocityConstraints()
 		worldManifold.Initialize(manifold, xfA, radiusA, xfB, radiusB);
 
 		vc->normal = worldManifold.normal;
+		vc->angleA = aA;
+		vc->angleB = aB;
 
 		int32 pointCount = vc->pointCount;
 		for (int32 j = 0; j < pointCount; ++j)
@@ -206,7 +210,13 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			// Setup a velocity bias for restitution.
 			vcp->velocityBias = 0.0f;
 			float32 vRel = b2Dot(vc->normal, vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA));
-			if (vRel < -b2_velocityThreshold)
+			vcp->separation = worldManifold.separations[j];
+			if (speculative && worldManifold.separations[j] > 0.0f)
+			{
+				// Let the shapes close the gap within this step, but no more.
+				vcp->velocityBias = -m_step.inv_dt * worldManifold.separations[j];
+			}
+			else if (vRel < -b2_velocityThreshold)
 			{
 				vcp->velocityBias = -vc->restitution * vRel;
 			}
@@ -286,8 +296,12 @@ void b2ContactSolver::WarmStart()
 	}
 }
 
-void b2ContactSolver::SolveVelocityConstraints()
+// Returns true if no body velocity changed by more than the velocity tolerances.
+bool b2ContactSolver::SolveVelocityConstraints()
 {
+	float32 maxLinearDeltaSqr = 0.0f;
+	float32 maxAngularDelta = 0.0f;
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -309,6 +323,9 @@ void b2ContactSolver::SolveVelocityConstraints()
 		b2Vec2 tangent = b2Cross(normal, 1.0f);
 		float32 friction = vc->friction;
 
+		b2Vec2 vA0 = vA, vB0 = vB;
+		float32 wA0 = wA, wB0 = wB;
+
 		b2Assert(pointCount == 1 || pointCount == 2);
 
 		// Solve tangent constraints first because non-penetration is more important
@@ -589,11 +606,17 @@ void b2ContactSolver::SolveVelocityConstraints()
 			}
 		}
 
+		maxLinearDeltaSqr = b2Max(maxLinearDeltaSqr, b2Max(b2DistanceSquared(vA, vA0), b2DistanceSquared(vB, vB0)));
+		maxAngularDelta = b2Max(maxAngularDelta, b2Max(b2Abs(wA - wA0), b2Abs(wB - wB0)));
+
 		m_velocities[indexA].v = vA;
 		m_velocities[indexA].w = wA;
 		m_velocities[indexB].v = vB;
 		m_velocities[indexB].w = wB;
 	}
+
+	return maxLinearDeltaSqr <= b2_linearVelocityTolerance * b2_linearVelocityTolerance &&
+		maxAngularDelta <= b2_angularVelocityTolerance;
 }
 
 void b2ContactSolver::StoreImpulses()
@@ -611,6 +634,197 @@ void b2ContactSolver::StoreImpulses()
 	}
 }
 
+void b2ContactSolver::InitializeSoftConstraints(float32 h)
+{
+	// A substep cannot resolve contacts that are stiffer than a quarter of its rate.
+	float32 hertz = b2Min(b2_contactHertz, 0.25f / h);
+	m_softness = b2MakeSoft(hertz, b2_contactDampingRatio, h);
+	m_inv_h = 1.0f / h;
+	m_maxBiasVelocity = b2_maxLinearCorrection * m_step.inv_dt;
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			vc->points[j].maxNormalImpulse = 0.0f;
+		}
+	}
+}
+
+// One iteration of the soft step solver. The contact anchors stay fixed for the
+// step, the separation is tracked from the motion of the bodies since the
+// constraints were initialized. With useBias, overlap is pushed out through a
+// soft constraint. Without it, the iteration only removes approaching velocity.
+bool b2ContactSolver::SolveSoftConstraints(bool useBias)
+{
+	float32 minSeparation = 0.0f;
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float32 mA = vc->invMassA;
+		float32 iA = vc->invIA;
+		float32 mB = vc->invMassB;
+		float32 iB = vc->invIB;
+		int32 pointCount = vc->pointCount;
+
+		b2Vec2 vA = m_velocities[indexA].v;
+		float32 wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float32 wB = m_velocities[indexB].w;
+
+		// Rotation of the bodies since the constraint was initialized.
+		b2Rot qA(m_positions[indexA].a - vc->angleA);
+		b2Rot qB(m_positions[indexB].a - vc->angleB);
+		b2Vec2 dc = m_positions[indexB].c - m_positions[indexA].c;
+
+		b2Vec2 normal = vc->normal;
+		b2Vec2 tangent = b2Cross(normal, 1.0f);
+		float32 friction = vc->friction;
+
+		// Solve tangent constraints first because non-penetration is more important
+		// than friction.
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+
+			float32 vt = b2Dot(dv, tangent) - vc->tangentSpeed;
+			float32 lambda = vcp->tangentMass * (-vt);
+
+			float32 maxFriction = friction * vcp->normalImpulse;
+			float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+			lambda = newImpulse - vcp->tangentImpulse;
+			vcp->tangentImpulse = newImpulse;
+
+			b2Vec2 P = lambda * tangent;
+
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			// The anchors coincided when the constraint was initialized.
+			b2Vec2 d = dc + b2Mul(qB, vcp->rB) - b2Mul(qA, vcp->rA);
+			float32 s = b2Dot(d, normal) + vcp->separation;
+			minSeparation = b2Min(minSeparation, s);
+
+			float32 bias = 0.0f;
+			float32 massScale = 1.0f;
+			float32 impulseScale = 0.0f;
+			if (s > 0.0f)
+			{
+				// The shapes are apart. Allow them to close the gap.
+				bias = s * m_inv_h;
+			}
+			else if (useBias)
+			{
+				bias = b2Max(m_softness.biasRate * b2Min(s + b2_linearSlop, 0.0f), -m_maxBiasVelocity);
+				massScale = m_softness.massScale;
+				impulseScale = m_softness.impulseScale;
+			}
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float32 vn = b2Dot(dv, normal);
+
+			float32 lambda = -vcp->normalMass * massScale * (vn + bias) - impulseScale * vcp->normalImpulse;
+
+			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+			vcp->maxNormalImpulse = b2Max(vcp->maxNormalImpulse, lambda);
+
+			b2Vec2 P = lambda * normal;
+
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+
+	// The same tolerance as SolvePositionConstraints.
+	return minSeparation >= -3.0f * b2_linearSlop;
+}
+
+// Restitution of the soft step solver. Points that were approaching fast enough
+// at the start of the step and pushed during it bounce with the velocity bias
+// set up by InitializeVelocityConstraints.
+void b2ContactSolver::ApplyRestitution()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		if (vc->restitution == 0.0f)
+		{
+			continue;
+		}
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float32 mA = vc->invMassA;
+		float32 iA = vc->invIA;
+		float32 mB = vc->invMassB;
+		float32 iB = vc->invIB;
+		int32 pointCount = vc->pointCount;
+
+		b2Vec2 vA = m_velocities[indexA].v;
+		float32 wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float32 wB = m_velocities[indexB].w;
+
+		b2Vec2 normal = vc->normal;
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+			if (vcp->velocityBias <= 0.0f || vcp->maxNormalImpulse == 0.0f)
+			{
+				continue;
+			}
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float32 vn = b2Dot(dv, normal);
+
+			float32 lambda = -vcp->normalMass * (vn - vcp->velocityBias);
+
+			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+
+			b2Vec2 P = lambda * normal;
+
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
+
 struct b2PositionSolverManifold
 {
 	void Initialize(b2ContactPositionConstraint* pc, const b2Transform& xfA, const b2Transform& xfB, int32 index)
@@ -37,6 +37,8 @@ struct b2VelocityConstraintPoint
 	float32 normalMass;
 	float32 tangentMass;
 	float32 velocityBias;
+	float32 separation;
+	float32 maxNormalImpulse;
 };
 
 struct b2ContactVelocityConstraint
@@ -54,14 +56,45 @@ struct b2ContactVelocityConstraint
 	float32 tangentSpeed;
 	int32 pointCount;
 	int32 contactIndex;
+	float32 angleA, angleB;
 };
 
+/// Soft constraint coefficients for a time step, computed from a stiffness in
+/// cycles per second and a damping ratio.
+struct b2Softness
+{
+	float32 biasRate;
+	float32 massScale;
+	float32 impulseScale;
+};
+
+inline b2Softness b2MakeSoft(float32 hertz, float32 dampingRatio, float32 h)
+{
+	b2Softness softness;
+	if (hertz == 0.0f)
+	{
+		softness.biasRate = 0.0f;
+		softness.massScale = 1.0f;
+		softness.impulseScale = 0.0f;
+		return softness;
+	}
+
+	float32 omega = 2.0f * b2_pi * hertz;
+	float32 a1 = 2.0f * dampingRatio + h * omega;
+	float32 a2 = h * omega * a1;
+	float32 a3 = 1.0f / (1.0f + a2);
+	softness.biasRate = omega / a1;
+	softness.massScale = a2 * a3;
+	softness.impulseScale = a3;
+	return softness;
+}
+
 struct b2ContactSolverDef
 {
 	b2TimeStep step;
 	b2Contact** contacts;
 	int32 count;
-	b2Position* positions;
+	b2Sweep* positions;
 	b2Velocity* velocities;
 	b2StackAllocator* allocator;
 };
@@ -75,20 +108,31 @@ public:
 	void InitializeVelocityConstraints();
 
 	void WarmStart();
-	void SolveVelocityConstraints();
+	bool SolveVelocityConstraints();
 	void StoreImpulses();
 
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	// Soft step solver. The velocity constraints must be initialized first.
+	// Each substep solves once with useBias and once without to relax. This
+	// returns true if the overlap of the contacts is within tolerance.
+	void InitializeSoftConstraints(float32 h);
+	bool SolveSoftConstraints(bool useBias);
+	void ApplyRestitution();
+
 	b2TimeStep m_step;
-	b2Position* m_positions;
+	b2Sweep* m_positions;
 	b2Velocity* m_velocities;
 	b2StackAllocator* m_allocator;
 	b2ContactPositionConstraint* m_positionConstraints;
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+
+	b2Softness m_softness;
+	float32 m_inv_h;
+	float32 m_maxBiasVelocity;
 };
 
 #endif
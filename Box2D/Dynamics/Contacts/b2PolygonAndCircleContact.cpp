@@ -18,7 +18,10 @@
 
 #include <Box2D/Dynamics/Contacts/b2PolygonAndCircleContact.h>
 #include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
 #include <new>
 
@@ -44,6 +47,47 @@ b2PolygonAndCircleContact::b2PolygonAndCircleContact(b2Fixture* fixtureA, b2Fixt
 void b2PolygonAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
 {
 	b2CollidePolygonAndCircle(	manifold,
-								(b2PolygonShape*)m_fixtureA->GetShape(), xfA,
-								(b2CircleShape*)m_fixtureB->GetShape(), xfB);
+								(const b2PolygonShape*)GetShapeA(), xfA,
+								(const b2CircleShape*)GetShapeB(), xfB, m_speculativeMargin);
+}
+
+void b2PolygonAndCircleContact::EvaluateBatch(b2Contact** contacts, int32 count)
+{
+	int32 i = 0;
+
+	// Full groups of lanes go through the wide kernel.
+	for (; i + b2_simdLanes <= count; i += b2_simdLanes)
+	{
+		b2Manifold* manifolds[b2_simdLanes];
+		const b2PolygonShape* polygonsA[b2_simdLanes];
+		b2CircleLanes circlesB;
+		b2TransformLanes xfA, xfB;
+		float32 margins[b2_simdLanes];
+
+		for (int32 j = 0; j < b2_simdLanes; ++j)
+		{
+			b2PolygonAndCircleContact* contact = (b2PolygonAndCircleContact*)contacts[i + j];
+			const b2CircleShape* circleB = (const b2CircleShape*)contact->GetShapeB();
+
+			manifolds[j] = &contact->m_manifold;
+			polygonsA[j] = (const b2PolygonShape*)contact->GetShapeA();
+			circlesB.Set(j, circleB->m_p, circleB->m_radius);
+			margins[j] = contact->m_speculativeMargin;
+			xfA.Set(j, contact->m_fixtureA->GetBody()->GetTransform());
+			xfB.Set(j, contact->m_fixtureB->GetBody()->GetTransform());
+		}
+
+		b2CollidePolygonAndCircleWide(manifolds, polygonsA, xfA, circlesB, xfB, margins);
+	}
+
+	// Handle the remainder one at a time.
+	for (; i < count; ++i)
+	{
+		b2PolygonAndCircleContact* contact = (b2PolygonAndCircleContact*)contacts[i];
+		const b2Transform& xfA = contact->m_fixtureA->GetBody()->GetTransform();
+		const b2Transform& xfB = contact->m_fixtureB->GetBody()->GetTransform();
+
+		// Qualified call, so there is no virtual dispatch inside the batch.
+		contact->b2PolygonAndCircleContact::Evaluate(&contact->m_manifold, xfA, xfB);
+	}
 }
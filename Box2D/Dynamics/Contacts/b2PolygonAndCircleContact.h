@@ -28,6 +28,7 @@ class b2PolygonAndCircleContact : public b2Contact
 public:
 	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
+	static void EvaluateBatch(b2Contact** contacts, int32 count);
 
 	b2PolygonAndCircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB);
 	~b2PolygonAndCircleContact() {}
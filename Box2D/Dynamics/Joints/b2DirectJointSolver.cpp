@@ -0,0 +1,292 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Joints/b2DirectJointSolver.h>
+#include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Common/b2StackAllocator.h>
+
+// A pivot below this fraction of its diagonal entry marks a redundant row.
+static const float32 b2_directPivotTolerance = 1.0e-4f;
+
+// Entry (i, j) of K = J * invM * JT. Rows only couple through shared bodies.
+static float32 b2RowDot(const b2JointRow& a, const b2JointRow& b)
+{
+	float32 k = 0.0f;
+
+	if (a.indexA == b.indexA)
+	{
+		k += a.invMassA * b2Dot(a.linearA, b.linearA) + a.invIA * a.angularA * b.angularA;
+	}
+
+	if (a.indexA == b.indexB)
+	{
+		k += a.invMassA * b2Dot(a.linearA, b.linearB) + a.invIA * a.angularA * b.angularB;
+	}
+
+	if (a.indexB == b.indexA)
+	{
+		k += a.invMassB * b2Dot(a.linearB, b.linearA) + a.invIB * a.angularB * b.angularA;
+	}
+
+	if (a.indexB == b.indexB)
+	{
+		k += a.invMassB * b2Dot(a.linearB, b.linearB) + a.invIB * a.angularB * b.angularB;
+	}
+
+	return k;
+}
+
+b2DirectJointSolver::b2DirectJointSolver(b2DirectJointSolverDef* def)
+{
+	m_joints = def->joints;
+	m_count = def->count;
+	m_velocities = def->velocities;
+	m_allocator = def->allocator;
+
+	m_rowCount = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_rowCount += m_joints[i]->GetDirectRowCount();
+	}
+
+	m_rows = NULL;
+	m_L = NULL;
+	m_invD = NULL;
+	m_impulses = NULL;
+	m_x = NULL;
+
+	if (m_rowCount > 0)
+	{
+		int32 n = m_rowCount;
+		m_rows = (b2JointRow*)m_allocator->Allocate(n * sizeof(b2JointRow));
+		m_L = (float32*)m_allocator->Allocate(n * n * sizeof(float32));
+		m_invD = (float32*)m_allocator->Allocate(n * sizeof(float32));
+		m_impulses = (float32*)m_allocator->Allocate(n * sizeof(float32));
+		m_x = (float32*)m_allocator->Allocate(n * sizeof(float32));
+	}
+}
+
+b2DirectJointSolver::~b2DirectJointSolver()
+{
+	if (m_rowCount > 0)
+	{
+		m_allocator->Free(m_x);
+		m_allocator->Free(m_impulses);
+		m_allocator->Free(m_invD);
+		m_allocator->Free(m_L);
+		m_allocator->Free(m_rows);
+	}
+}
+
+void b2DirectJointSolver::InitializeVelocityConstraints()
+{
+	int32 rowIndex = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2Joint* joint = m_joints[i];
+		joint->GetDirectVelocityRows(m_rows + rowIndex);
+		rowIndex += joint->GetDirectRowCount();
+	}
+
+	for (int32 i = 0; i < m_rowCount; ++i)
+	{
+		m_impulses[i] = 0.0f;
+	}
+
+	Factor();
+}
+
+bool b2DirectJointSolver::SolveVelocityConstraints()
+{
+	int32 n = m_rowCount;
+	float32* x = m_x;
+
+	// K * x = -Cdot
+	for (int32 i = 0; i < n; ++i)
+	{
+		const b2JointRow& row = m_rows[i];
+		const b2Velocity& velocityA = m_velocities[row.indexA];
+		const b2Velocity& velocityB = m_velocities[row.indexB];
+		float32 Cdot = b2Dot(row.linearA, velocityA.v) + row.angularA * velocityA.w +
+			b2Dot(row.linearB, velocityB.v) + row.angularB * velocityB.w;
+		x[i] = -Cdot;
+	}
+
+	Solve(x);
+
+	float32 maxLinearDeltaSqr = 0.0f;
+	float32 maxAngularDelta = 0.0f;
+	for (int32 i = 0; i < n; ++i)
+	{
+		const b2JointRow& row = m_rows[i];
+		float32 impulse = x[i];
+		m_impulses[i] += impulse;
+
+		b2Vec2 dvA = row.invMassA * impulse * row.linearA;
+		float32 dwA = row.invIA * impulse * row.angularA;
+		b2Vec2 dvB = row.invMassB * impulse * row.linearB;
+		float32 dwB = row.invIB * impulse * row.angularB;
+
+		m_velocities[row.indexA].v += dvA;
+		m_velocities[row.indexA].w += dwA;
+		m_velocities[row.indexB].v += dvB;
+		m_velocities[row.indexB].w += dwB;
+
+		maxLinearDeltaSqr = b2Max(maxLinearDeltaSqr, b2Max(dvA.LengthSquared(), dvB.LengthSquared()));
+		maxAngularDelta = b2Max(maxAngularDelta, b2Max(b2Abs(dwA), b2Abs(dwB)));
+	}
+
+	return maxLinearDeltaSqr <= b2_linearVelocityTolerance * b2_linearVelocityTolerance &&
+		maxAngularDelta <= b2_angularVelocityTolerance;
+}
+
+bool b2DirectJointSolver::SolvePositionConstraints(const b2SolverData& data)
+{
+	if (m_rowCount == 0)
+	{
+		return true;
+	}
+
+	// The Jacobians change with the positions, so each pass linearizes and
+	// factors again.
+	bool positionsOkay = true;
+	int32 rowIndex = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2Joint* joint = m_joints[i];
+		bool jointOkay = joint->GetDirectPositionRows(data, m_rows + rowIndex, m_x + rowIndex);
+		positionsOkay = positionsOkay && jointOkay;
+		rowIndex += joint->GetDirectRowCount();
+	}
+
+	if (positionsOkay)
+	{
+		return true;
+	}
+
+	Factor();
+
+	// K * x = -C, with C clamped to prevent large corrections. A row without
+	// linear terms constrains an angle.
+	int32 n = m_rowCount;
+	float32* x = m_x;
+	for (int32 i = 0; i < n; ++i)
+	{
+		const b2JointRow& row = m_rows[i];
+		bool angular = row.linearA.x == 0.0f && row.linearA.y == 0.0f && row.linearB.x == 0.0f && row.linearB.y == 0.0f;
+		float32 maxCorrection = angular ? b2_maxAngularCorrection : b2_maxLinearCorrection;
+		x[i] = -b2Clamp(x[i], -maxCorrection, maxCorrection);
+	}
+
+	Solve(x);
+
+	for (int32 i = 0; i < n; ++i)
+	{
+		const b2JointRow& row = m_rows[i];
+		float32 impulse = x[i];
+
+		data.positions[row.indexA].c += row.invMassA * impulse * row.linearA;
+		data.positions[row.indexA].a += row.invIA * impulse * row.angularA;
+		data.positions[row.indexB].c += row.invMassB * impulse * row.linearB;
+		data.positions[row.indexB].a += row.invIB * impulse * row.angularB;
+	}
+
+	return false;
+}
+
+// Factor K = L * D * LT in place. L is unit lower triangular and stored below the
+// diagonal, D is stored on the diagonal.
+void b2DirectJointSolver::Factor()
+{
+	int32 n = m_rowCount;
+	float32* L = m_L;
+	for (int32 j = 0; j < n; ++j)
+	{
+		float32 diagonal = b2RowDot(m_rows[j], m_rows[j]);
+		float32 d = diagonal;
+		for (int32 k = 0; k < j; ++k)
+		{
+			d -= L[j * n + k] * L[j * n + k] * L[k * n + k];
+		}
+
+		if (d <= b2_directPivotTolerance * diagonal)
+		{
+			// The row is a combination of the previous rows, or it does not
+			// involve a movable body.
+			L[j * n + j] = 0.0f;
+			m_invD[j] = 0.0f;
+			for (int32 i = j + 1; i < n; ++i)
+			{
+				L[i * n + j] = 0.0f;
+			}
+			continue;
+		}
+
+		L[j * n + j] = d;
+		m_invD[j] = 1.0f / d;
+		for (int32 i = j + 1; i < n; ++i)
+		{
+			float32 s = b2RowDot(m_rows[i], m_rows[j]);
+			for (int32 k = 0; k < j; ++k)
+			{
+				s -= L[i * n + k] * L[j * n + k] * L[k * n + k];
+			}
+			L[i * n + j] = s * m_invD[j];
+		}
+	}
+}
+
+// Solve K * x = b in place: forward substitution with L, scaling by the inverse
+// of D, then back substitution with LT.
+void b2DirectJointSolver::Solve(float32* x) const
+{
+	int32 n = m_rowCount;
+	const float32* L = m_L;
+
+	for (int32 i = 0; i < n; ++i)
+	{
+		for (int32 k = 0; k < i; ++k)
+		{
+			x[i] -= L[i * n + k] * x[k];
+		}
+	}
+
+	for (int32 i = 0; i < n; ++i)
+	{
+		x[i] *= m_invD[i];
+	}
+
+	for (int32 i = n - 1; i >= 0; --i)
+	{
+		for (int32 k = i + 1; k < n; ++k)
+		{
+			x[i] -= L[k * n + i] * x[k];
+		}
+	}
+}
+
+void b2DirectJointSolver::StoreImpulses()
+{
+	int32 rowIndex = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2Joint* joint = m_joints[i];
+		joint->AddDirectImpulses(m_impulses + rowIndex);
+		rowIndex += joint->GetDirectRowCount();
+	}
+}
@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_DIRECT_JOINT_SOLVER_H
+#define B2_DIRECT_JOINT_SOLVER_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+
+class b2Joint;
+class b2StackAllocator;
+struct b2JointRow;
+
+struct b2DirectJointSolverDef
+{
+	b2Joint** joints;
+	int32 count;
+	b2Velocity* velocities;
+	b2StackAllocator* allocator;
+};
+
+/// Solves the velocity rows of a small set of joints exactly. The rows are
+/// assembled into K = J * invM * JT, which is factored once per step as
+/// L * D * LT. Each solve is then a forward and a back substitution, which
+/// satisfies all rows at once, closed loops included. Redundant rows show up
+/// as zero pivots and are dropped.
+/// This is an internal class.
+class b2DirectJointSolver
+{
+public:
+	b2DirectJointSolver(b2DirectJointSolverDef* def);
+	~b2DirectJointSolver();
+
+	/// Assemble and factor the rows. The joints must have initialized their
+	/// velocity constraints.
+	void InitializeVelocityConstraints();
+
+	/// Returns true if no body velocity changed by more than the velocity tolerances.
+	bool SolveVelocityConstraints();
+
+	/// Hand the accumulated impulses back to the joints.
+	void StoreImpulses();
+
+	/// Project the position errors out with freshly linearized rows. This returns
+	/// true if the position errors were already within tolerance.
+	bool SolvePositionConstraints(const b2SolverData& data);
+
+	void Factor();
+	void Solve(float32* x) const;
+
+	b2Joint** m_joints;
+	int32 m_count;
+	b2Velocity* m_velocities;
+	b2StackAllocator* m_allocator;
+
+	int32 m_rowCount;
+	b2JointRow* m_rows;
+	float32* m_L;
+	float32* m_invD;
+	float32* m_impulses;
+	float32* m_x;
+};
+
+#endif
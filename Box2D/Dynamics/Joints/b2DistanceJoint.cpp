@@ -61,10 +61,10 @@ b2DistanceJoint::b2DistanceJoint(const b2DistanceJointDef* def)
 
 void b2DistanceJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterA = m_bodyA->m_sweep->localCenter;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassA = m_bodyA->m_invMass;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIA = m_bodyA->m_invI;
@@ -232,7 +232,7 @@ b2Vec2 b2DistanceJoint::GetAnchorB() const
 
 b2Vec2 b2DistanceJoint::GetReactionForce(float32 inv_dt) const
 {
-	b2Vec2 F = (inv_dt * m_impulse) * m_u;
+	b2Vec2 F = (m_substepCount * inv_dt * m_impulse) * m_u;
 	return F;
 }
 
@@ -244,8 +244,8 @@ float32 b2DistanceJoint::GetReactionTorque(float32 inv_dt) const
 
 void b2DistanceJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	b2Log("  b2DistanceJointDef jd;\n");
 	b2Log("  jd.bodyA = bodies[%d];\n", indexA);
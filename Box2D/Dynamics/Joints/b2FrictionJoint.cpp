@@ -55,10 +55,10 @@ b2FrictionJoint::b2FrictionJoint(const b2FrictionJointDef* def)
 
 void b2FrictionJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterA = m_bodyA->m_sweep->localCenter;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassA = m_bodyA->m_invMass;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIA = m_bodyA->m_invI;
@@ -204,12 +204,12 @@ b2Vec2 b2FrictionJoint::GetAnchorB() const
 
 b2Vec2 b2FrictionJoint::GetReactionForce(float32 inv_dt) const
 {
-	return inv_dt * m_linearImpulse;
+	return m_substepCount * inv_dt * m_linearImpulse;
 }
 
 float32 b2FrictionJoint::GetReactionTorque(float32 inv_dt) const
 {
-	return inv_dt * m_angularImpulse;
+	return m_substepCount * inv_dt * m_angularImpulse;
 }
 
 void b2FrictionJoint::SetMaxForce(float32 force)
@@ -236,8 +236,8 @@ float32 b2FrictionJoint::GetMaxTorque() const
 
 void b2FrictionJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	b2Log("  b2FrictionJointDef jd;\n");
 	b2Log("  jd.bodyA = bodies[%d];\n", indexA);
@@ -62,9 +62,9 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def)
 
 	// Get geometry of joint1
 	b2Transform xfA = m_bodyA->m_xf;
-	float32 aA = m_bodyA->m_sweep.a;
+	float32 aA = m_bodyA->m_sweep->a;
 	b2Transform xfC = m_bodyC->m_xf;
-	float32 aC = m_bodyC->m_sweep.a;
+	float32 aC = m_bodyC->m_sweep->a;
 
 	if (m_typeA == e_revoluteJoint)
 	{
@@ -94,9 +94,9 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def)
 
 	// Get geometry of joint2
 	b2Transform xfB = m_bodyB->m_xf;
-	float32 aB = m_bodyB->m_sweep.a;
+	float32 aB = m_bodyB->m_sweep->a;
 	b2Transform xfD = m_bodyD->m_xf;
-	float32 aD = m_bodyD->m_sweep.a;
+	float32 aD = m_bodyD->m_sweep->a;
 
 	if (m_typeB == e_revoluteJoint)
 	{
@@ -130,14 +130,14 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def)
 
 void b2GearJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_indexC = m_bodyC->m_islandIndex;
-	m_indexD = m_bodyD->m_islandIndex;
-	m_lcA = m_bodyA->m_sweep.localCenter;
-	m_lcB = m_bodyB->m_sweep.localCenter;
-	m_lcC = m_bodyC->m_sweep.localCenter;
-	m_lcD = m_bodyD->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_indexC = m_bodyC->m_slot;
+	m_indexD = m_bodyD->m_slot;
+	m_lcA = m_bodyA->m_sweep->localCenter;
+	m_lcB = m_bodyB->m_sweep->localCenter;
+	m_lcC = m_bodyC->m_sweep->localCenter;
+	m_lcD = m_bodyD->m_sweep->localCenter;
 	m_mA = m_bodyA->m_invMass;
 	m_mB = m_bodyB->m_invMass;
 	m_mC = m_bodyC->m_invMass;
@@ -380,13 +380,13 @@ b2Vec2 b2GearJoint::GetAnchorB() const
 b2Vec2 b2GearJoint::GetReactionForce(float32 inv_dt) const
 {
 	b2Vec2 P = m_impulse * m_JvAC;
-	return inv_dt * P;
+	return m_substepCount * inv_dt * P;
 }
 
 float32 b2GearJoint::GetReactionTorque(float32 inv_dt) const
 {
 	float32 L = m_impulse * m_JwA;
-	return inv_dt * L;
+	return m_substepCount * inv_dt * L;
 }
 
 void b2GearJoint::SetRatio(float32 ratio)
@@ -402,8 +402,8 @@ float32 b2GearJoint::GetRatio() const
 
 void b2GearJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	int32 index1 = m_joint1->m_index;
 	int32 index2 = m_joint2->m_index;
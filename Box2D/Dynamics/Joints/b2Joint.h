@@ -20,6 +20,7 @@
 #define B2_JOINT_H
 
 #include <Common/b2Math.h>
+#include <Dynamics/b2Id.h>
 
 class b2Body;
 class b2Joint;
@@ -70,6 +71,17 @@ struct b2JointEdge
 	b2JointEdge* next;		///< the next joint edge in the body's joint list
 };
 
+/// One row of a joint Jacobian, handed to the direct joint solver. The row
+/// constrains the relative velocity J * v of the two bodies to zero.
+struct b2JointRow
+{
+	int32 indexA, indexB;
+	float32 invMassA, invIA;
+	float32 invMassB, invIB;
+	b2Vec2 linearA, linearB;
+	float32 angularA, angularB;
+};
+
 /// Joint definitions are used to construct joints.
 struct b2JointDef
 {
@@ -119,16 +131,21 @@ public:
 	/// Get the anchor point on bodyB in world coordinates.
 	virtual b2Vec2 GetAnchorB() const = 0;
 
-	/// Get the reaction force on bodyB at the joint anchor in Newtons.
+	/// Get the reaction force on bodyB at the joint anchor in Newtons. Pass the
+	/// inverse of the full time step, also when the world uses substeps.
 	virtual b2Vec2 GetReactionForce(float32 inv_dt) const = 0;
 
-	/// Get the reaction torque on bodyB in N*m.
+	/// Get the reaction torque on bodyB in N*m. Pass the inverse of the full
+	/// time step, also when the world uses substeps.
 	virtual float32 GetReactionTorque(float32 inv_dt) const = 0;
 
 	/// Get the next joint the world joint list.
 	b2Joint* GetNext();
 	const b2Joint* GetNext() const;
 
+	/// Get the handle of this joint, see b2World::GetJoint.
+	b2JointId GetId() const;
+
 	/// Get the user data pointer.
 	void* GetUserData() const;
 
@@ -154,6 +171,8 @@ protected:
 	friend class b2Body;
 	friend class b2Island;
 	friend class b2GearJoint;
+	friend class b2DirectJointSolver;
+	friend class b2JointBatchSolver;
 
 	static b2Joint* Create(const b2JointDef* def, b2BlockAllocator* allocator);
 	static void Destroy(b2Joint* joint, b2BlockAllocator* allocator);
@@ -167,6 +186,26 @@ protected:
 	// This returns true if the position errors are within tolerance.
 	virtual bool SolvePositionConstraints(const b2SolverData& data) = 0;
 
+	// The number of velocity rows this joint can hand to the direct solver in its
+	// current state. Zero means the joint must be solved iteratively.
+	virtual int32 GetDirectRowCount() const { return 0; }
+
+	// Fill in the Jacobian rows. Called after InitVelocityConstraints.
+	virtual void GetDirectVelocityRows(b2JointRow* rows) const { B2_NOT_USED(rows); }
+
+	// Fill in the Jacobian rows and the position errors C at the current positions.
+	// This returns true if the position errors are within tolerance.
+	virtual bool GetDirectPositionRows(const b2SolverData& data, b2JointRow* rows, float32* C) const
+	{
+		B2_NOT_USED(data);
+		B2_NOT_USED(rows);
+		B2_NOT_USED(C);
+		return true;
+	}
+
+	// Accumulate the row impulses found by the direct solver for warm starting.
+	virtual void AddDirectImpulses(const float32* impulses) { B2_NOT_USED(impulses); }
+
 	b2JointType m_type;
 	b2Joint* m_prev;
 	b2Joint* m_next;
@@ -176,6 +215,11 @@ protected:
 	b2Body* m_bodyB;
 
 	int32 m_index;
+	b2JointId m_id;
+
+	// The stored impulses act over one substep of the last step, so the
+	// reaction accessors scale the inverse time step by this count.
+	int32 m_substepCount;
 
 	bool m_islandFlag;
 	bool m_collideConnected;
@@ -208,6 +252,11 @@ inline const b2Joint* b2Joint::GetNext() const
 	return m_next;
 }
 
+inline b2JointId b2Joint::GetId() const
+{
+	return m_id;
+}
+
 inline void* b2Joint::GetUserData() const
 {
 	return m_userData;
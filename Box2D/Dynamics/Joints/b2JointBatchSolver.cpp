@@ -0,0 +1,313 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Joints/b2JointBatchSolver.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Common/b2StackAllocator.h>
+#include <memory.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// The colors used at a body are the bits of a uint32. This fails to compile if
+// b2_maxJointColors does not fit.
+typedef char b2JointColorsFitInMask[b2_maxJointColors <= 32 ? 1 : -1];
+
+// Joints are colored after their velocity constraints are initialized, so the
+// island indices and inverse masses are known. Bodies with zero inverse mass are
+// never written and can be shared within a color.
+b2JointBatchSolver::b2JointBatchSolver(b2JointBatchSolverDef* def)
+{
+	m_joints = def->joints;
+	m_count = 0;
+	m_velocities = def->velocities;
+	m_allocator = def->allocator;
+	m_batches = NULL;
+	m_batchCount = 0;
+
+	int32 count = def->count;
+	if (count == 0)
+	{
+		return;
+	}
+
+	int32 batchCapacity = (count + b2_simdLanes - 1) / b2_simdLanes + b2_maxJointColors;
+	m_batches = (b2RevoluteLanes*)m_allocator->Allocate(batchCapacity * sizeof(b2RevoluteLanes));
+
+	uint32* bodyColors = (uint32*)m_allocator->Allocate(def->bodyCount * sizeof(uint32));
+	int32* jointColors = (int32*)m_allocator->Allocate(count * sizeof(int32));
+	b2Joint** sorted = (b2Joint**)m_allocator->Allocate(count * sizeof(b2Joint*));
+	memset(bodyColors, 0, def->bodyCount * sizeof(uint32));
+
+	// Greedy coloring. A joint takes the lowest color that neither of its
+	// movable bodies uses yet.
+	int32 colorCounts[b2_maxJointColors + 1] = {0};
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2RevoluteJoint* joint = (b2RevoluteJoint*)m_joints[i];
+		bool movableA = joint->m_invMassA > 0.0f || joint->m_invIA > 0.0f;
+		bool movableB = joint->m_invMassB > 0.0f || joint->m_invIB > 0.0f;
+
+		uint32 used = 0;
+		if (movableA)
+		{
+			used |= bodyColors[joint->m_indexA];
+		}
+		if (movableB)
+		{
+			used |= bodyColors[joint->m_indexB];
+		}
+
+		int32 color = b2_maxJointColors;
+		for (int32 c = 0; c < b2_maxJointColors; ++c)
+		{
+			if ((used & (1u << c)) == 0)
+			{
+				color = c;
+				break;
+			}
+		}
+
+		if (color < b2_maxJointColors)
+		{
+			if (movableA)
+			{
+				bodyColors[joint->m_indexA] |= 1u << color;
+			}
+			if (movableB)
+			{
+				bodyColors[joint->m_indexB] |= 1u << color;
+			}
+		}
+
+		jointColors[i] = color;
+		++colorCounts[color];
+	}
+
+	// Reorder the joints by color, keeping their order within a color. Joints
+	// that found no color go last.
+	int32 colorStarts[b2_maxJointColors + 1];
+	int32 start = 0;
+	for (int32 c = 0; c <= b2_maxJointColors; ++c)
+	{
+		colorStarts[c] = start;
+		start += colorCounts[c];
+	}
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		sorted[colorStarts[jointColors[i]]++] = m_joints[i];
+	}
+
+	memcpy(m_joints, sorted, count * sizeof(b2Joint*));
+	m_count = count - colorCounts[b2_maxJointColors];
+
+	// Split each color into batches.
+	int32 jointIndex = 0;
+	for (int32 c = 0; c < b2_maxJointColors; ++c)
+	{
+		int32 end = jointIndex + colorCounts[c];
+		while (jointIndex < end)
+		{
+			b2Assert(m_batchCount < batchCapacity);
+			b2RevoluteLanes* batch = m_batches + m_batchCount;
+			++m_batchCount;
+
+			batch->count = b2Min(b2_simdLanes, end - jointIndex);
+			for (int32 lane = 0; lane < batch->count; ++lane)
+			{
+				batch->joints[lane] = (b2RevoluteJoint*)m_joints[jointIndex++];
+			}
+		}
+	}
+
+	m_allocator->Free(sorted);
+	m_allocator->Free(jointColors);
+	m_allocator->Free(bodyColors);
+}
+
+b2JointBatchSolver::~b2JointBatchSolver()
+{
+	if (m_batches != NULL)
+	{
+		m_allocator->Free(m_batches);
+	}
+}
+
+bool b2JointBatchSolver::IsBatchable(const b2Joint* joint)
+{
+	if (joint->m_type != e_revoluteJoint)
+	{
+		return false;
+	}
+
+	const b2RevoluteJoint* revolute = (const b2RevoluteJoint*)joint;
+	return revolute->m_enableMotor == false && revolute->m_enableLimit == false;
+}
+
+void b2JointBatchSolver::InitializeVelocityConstraints()
+{
+	for (int32 i = 0; i < m_batchCount; ++i)
+	{
+		b2RevoluteLanes* batch = m_batches + i;
+
+		// Unused lanes solve to a zero impulse and are not written back.
+		for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+		{
+			b2RevoluteJoint* joint = batch->joints[lane < batch->count ? lane : 0];
+			float32 active = lane < batch->count ? 1.0f : 0.0f;
+
+			batch->indexA[lane] = joint->m_indexA;
+			batch->indexB[lane] = joint->m_indexB;
+			batch->rAx[lane] = joint->m_rA.x;
+			batch->rAy[lane] = joint->m_rA.y;
+			batch->rBx[lane] = joint->m_rB.x;
+			batch->rBy[lane] = joint->m_rB.y;
+			batch->mA[lane] = active * joint->m_invMassA;
+			batch->iA[lane] = active * joint->m_invIA;
+			batch->mB[lane] = active * joint->m_invMassB;
+			batch->iB[lane] = active * joint->m_invIB;
+			batch->impulseX[lane] = active * joint->m_impulse.x;
+			batch->impulseY[lane] = active * joint->m_impulse.y;
+
+			// Same as b2Mat33::Solve22.
+			const b2Mat33& K = joint->m_mass;
+			float32 det = K.ex.x * K.ey.y - K.ey.x * K.ex.y;
+			if (det != 0.0f)
+			{
+				det = 1.0f / det;
+			}
+			batch->k11[lane] = active * det * K.ey.y;
+			batch->k12[lane] = -active * det * K.ey.x;
+			batch->k22[lane] = active * det * K.ex.x;
+		}
+	}
+}
+
+bool b2JointBatchSolver::SolveVelocityConstraints()
+{
+	float32 maxLinearDeltaSqr = 0.0f;
+	float32 maxAngularDelta = 0.0f;
+
+	for (int32 i = 0; i < m_batchCount; ++i)
+	{
+		b2RevoluteLanes* batch = m_batches + i;
+
+		float32 vAx[b2_simdLanes], vAy[b2_simdLanes], wA[b2_simdLanes];
+		float32 vBx[b2_simdLanes], vBy[b2_simdLanes], wB[b2_simdLanes];
+		for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+		{
+			const b2Velocity& velocityA = m_velocities[batch->indexA[lane]];
+			const b2Velocity& velocityB = m_velocities[batch->indexB[lane]];
+			vAx[lane] = velocityA.v.x;
+			vAy[lane] = velocityA.v.y;
+			wA[lane] = velocityA.w;
+			vBx[lane] = velocityB.v.x;
+			vBy[lane] = velocityB.v.y;
+			wB[lane] = velocityB.w;
+		}
+
+		// Velocity changes of the lanes.
+		float32 dvAx[b2_simdLanes], dvAy[b2_simdLanes], dwA[b2_simdLanes];
+		float32 dvBx[b2_simdLanes], dvBy[b2_simdLanes], dwB[b2_simdLanes];
+
+#if defined(B2_USE_SSE2)
+		__m128 rAx = _mm_loadu_ps(batch->rAx), rAy = _mm_loadu_ps(batch->rAy);
+		__m128 rBx = _mm_loadu_ps(batch->rBx), rBy = _mm_loadu_ps(batch->rBy);
+		__m128 qwA = _mm_loadu_ps(wA), qwB = _mm_loadu_ps(wB);
+
+		// Cdot = vB + b2Cross(wB, rB) - vA - b2Cross(wA, rA)
+		__m128 cx = _mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(vBx), _mm_mul_ps(qwB, rBy)),
+			_mm_sub_ps(_mm_loadu_ps(vAx), _mm_mul_ps(qwA, rAy)));
+		__m128 cy = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(vBy), _mm_mul_ps(qwB, rBx)),
+			_mm_add_ps(_mm_loadu_ps(vAy), _mm_mul_ps(qwA, rAx)));
+
+		// impulse = -invK * Cdot
+		__m128 k11 = _mm_loadu_ps(batch->k11), k12 = _mm_loadu_ps(batch->k12), k22 = _mm_loadu_ps(batch->k22);
+		__m128 px = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_mul_ps(k11, cx), _mm_mul_ps(k12, cy)));
+		__m128 py = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_mul_ps(k12, cx), _mm_mul_ps(k22, cy)));
+
+		_mm_storeu_ps(batch->impulseX, _mm_add_ps(_mm_loadu_ps(batch->impulseX), px));
+		_mm_storeu_ps(batch->impulseY, _mm_add_ps(_mm_loadu_ps(batch->impulseY), py));
+
+		__m128 mA = _mm_loadu_ps(batch->mA), iA = _mm_loadu_ps(batch->iA);
+		__m128 mB = _mm_loadu_ps(batch->mB), iB = _mm_loadu_ps(batch->iB);
+
+		_mm_storeu_ps(dvAx, _mm_mul_ps(mA, px));
+		_mm_storeu_ps(dvAy, _mm_mul_ps(mA, py));
+		_mm_storeu_ps(dwA, _mm_mul_ps(iA, _mm_sub_ps(_mm_mul_ps(rAx, py), _mm_mul_ps(rAy, px))));
+		_mm_storeu_ps(dvBx, _mm_mul_ps(mB, px));
+		_mm_storeu_ps(dvBy, _mm_mul_ps(mB, py));
+		_mm_storeu_ps(dwB, _mm_mul_ps(iB, _mm_sub_ps(_mm_mul_ps(rBx, py), _mm_mul_ps(rBy, px))));
+#else
+		for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+		{
+			float32 cx = vBx[lane] - wB[lane] * batch->rBy[lane] - (vAx[lane] - wA[lane] * batch->rAy[lane]);
+			float32 cy = vBy[lane] + wB[lane] * batch->rBx[lane] - (vAy[lane] + wA[lane] * batch->rAx[lane]);
+
+			float32 px = -(batch->k11[lane] * cx + batch->k12[lane] * cy);
+			float32 py = -(batch->k12[lane] * cx + batch->k22[lane] * cy);
+
+			batch->impulseX[lane] += px;
+			batch->impulseY[lane] += py;
+
+			dvAx[lane] = batch->mA[lane] * px;
+			dvAy[lane] = batch->mA[lane] * py;
+			dwA[lane] = batch->iA[lane] * (batch->rAx[lane] * py - batch->rAy[lane] * px);
+			dvBx[lane] = batch->mB[lane] * px;
+			dvBy[lane] = batch->mB[lane] * py;
+			dwB[lane] = batch->iB[lane] * (batch->rBx[lane] * py - batch->rBy[lane] * px);
+		}
+#endif
+
+		for (int32 lane = 0; lane < batch->count; ++lane)
+		{
+			b2Velocity& velocityA = m_velocities[batch->indexA[lane]];
+			b2Velocity& velocityB = m_velocities[batch->indexB[lane]];
+			velocityA.v.x -= dvAx[lane];
+			velocityA.v.y -= dvAy[lane];
+			velocityA.w -= dwA[lane];
+			velocityB.v.x += dvBx[lane];
+			velocityB.v.y += dvBy[lane];
+			velocityB.w += dwB[lane];
+
+			maxLinearDeltaSqr = b2Max(maxLinearDeltaSqr, dvAx[lane] * dvAx[lane] + dvAy[lane] * dvAy[lane]);
+			maxLinearDeltaSqr = b2Max(maxLinearDeltaSqr, dvBx[lane] * dvBx[lane] + dvBy[lane] * dvBy[lane]);
+			maxAngularDelta = b2Max(maxAngularDelta, b2Max(b2Abs(dwA[lane]), b2Abs(dwB[lane])));
+		}
+	}
+
+	return maxLinearDeltaSqr <= b2_linearVelocityTolerance * b2_linearVelocityTolerance &&
+		maxAngularDelta <= b2_angularVelocityTolerance;
+}
+
+void b2JointBatchSolver::StoreImpulses()
+{
+	for (int32 i = 0; i < m_batchCount; ++i)
+	{
+		const b2RevoluteLanes* batch = m_batches + i;
+		for (int32 lane = 0; lane < batch->count; ++lane)
+		{
+			b2RevoluteJoint* joint = batch->joints[lane];
+			joint->m_impulse.x = batch->impulseX[lane];
+			joint->m_impulse.y = batch->impulseY[lane];
+		}
+	}
+}
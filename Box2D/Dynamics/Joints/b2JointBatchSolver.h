@@ -0,0 +1,91 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_JOINT_BATCH_SOLVER_H
+#define B2_JOINT_BATCH_SOLVER_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+
+class b2Joint;
+class b2RevoluteJoint;
+class b2StackAllocator;
+
+struct b2JointBatchSolverDef
+{
+	b2Joint** joints;
+	int32 count;
+	int32 bodyCount;
+	b2Velocity* velocities;
+	b2StackAllocator* allocator;
+};
+
+/// The point constraints of b2_simdLanes revolute joints stored as a structure of
+/// arrays. The joints of one batch share no dynamic body, so the lanes can be
+/// solved together without write conflicts.
+struct b2RevoluteLanes
+{
+	int32 count;
+	b2RevoluteJoint* joints[b2_simdLanes];
+	int32 indexA[b2_simdLanes];
+	int32 indexB[b2_simdLanes];
+	float32 rAx[b2_simdLanes], rAy[b2_simdLanes];
+	float32 rBx[b2_simdLanes], rBy[b2_simdLanes];
+	float32 mA[b2_simdLanes], iA[b2_simdLanes];
+	float32 mB[b2_simdLanes], iB[b2_simdLanes];
+	float32 k11[b2_simdLanes], k12[b2_simdLanes], k22[b2_simdLanes];	// inverse of the 2x2 mass matrix
+	float32 impulseX[b2_simdLanes], impulseY[b2_simdLanes];
+};
+
+/// Solves revolute joints without motor or limit in batches with a wide kernel.
+/// The joints are colored so that no two joints of one color share a dynamic body,
+/// and each color is split into batches of b2_simdLanes joints. Joints that do not
+/// fit in b2_maxJointColors colors are moved behind the colored ones and are left
+/// to the generic path.
+/// This is an internal class.
+class b2JointBatchSolver
+{
+public:
+	/// Color the joints and reorder them by color. m_count is then the number of
+	/// joints in batches.
+	b2JointBatchSolver(b2JointBatchSolverDef* def);
+	~b2JointBatchSolver();
+
+	/// True if the joint can be solved by this solver in its current state.
+	static bool IsBatchable(const b2Joint* joint);
+
+	/// Gather the constraints. The joints must have initialized their velocity
+	/// constraints.
+	void InitializeVelocityConstraints();
+
+	/// Returns true if no body velocity changed by more than the velocity tolerances.
+	bool SolveVelocityConstraints();
+
+	/// Hand the accumulated impulses back to the joints.
+	void StoreImpulses();
+
+	b2Joint** m_joints;
+	int32 m_count;
+	b2Velocity* m_velocities;
+	b2StackAllocator* m_allocator;
+
+	b2RevoluteLanes* m_batches;
+	int32 m_batchCount;
+};
+
+#endif
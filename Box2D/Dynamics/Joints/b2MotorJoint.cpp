@@ -60,10 +60,10 @@ b2MotorJoint::b2MotorJoint(const b2MotorJointDef* def)
 
 void b2MotorJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterA = m_bodyA->m_sweep->localCenter;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassA = m_bodyA->m_invMass;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIA = m_bodyA->m_invI;
@@ -215,12 +215,12 @@ b2Vec2 b2MotorJoint::GetAnchorB() const
 
 b2Vec2 b2MotorJoint::GetReactionForce(float32 inv_dt) const
 {
-	return inv_dt * m_linearImpulse;
+	return m_substepCount * inv_dt * m_linearImpulse;
 }
 
 float32 b2MotorJoint::GetReactionTorque(float32 inv_dt) const
 {
-	return inv_dt * m_angularImpulse;
+	return m_substepCount * inv_dt * m_angularImpulse;
 }
 
 void b2MotorJoint::SetMaxForce(float32 force)
@@ -288,8 +288,8 @@ float32 b2MotorJoint::GetAngularOffset() const
 
 void b2MotorJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	b2Log("  b2MotorJointDef jd;\n");
 	b2Log("  jd.bodyA = bodies[%d];\n", indexA);
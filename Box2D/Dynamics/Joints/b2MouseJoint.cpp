@@ -95,8 +95,8 @@ float32 b2MouseJoint::GetDampingRatio() const
 
 void b2MouseJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIB = m_bodyB->m_invI;
 
@@ -208,7 +208,7 @@ b2Vec2 b2MouseJoint::GetAnchorB() const
 
 b2Vec2 b2MouseJoint::GetReactionForce(float32 inv_dt) const
 {
-	return inv_dt * m_impulse;
+	return m_substepCount * inv_dt * m_impulse;
 }
 
 float32 b2MouseJoint::GetReactionTorque(float32 inv_dt) const
@@ -125,10 +125,10 @@ b2PrismaticJoint::b2PrismaticJoint(const b2PrismaticJointDef* def)
 
 void b2PrismaticJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterA = m_bodyA->m_sweep->localCenter;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassA = m_bodyA->m_invMass;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIA = m_bodyA->m_invI;
@@ -481,6 +481,90 @@ bool b2PrismaticJoint::SolvePositionConstraints(const b2SolverData& data)
 	return linearError <= b2_linearSlop && angularError <= b2_angularSlop;
 }
 
+// The point-to-line and angular constraints are handed to the direct solver when
+// there is no motor or limit row to clamp.
+int32 b2PrismaticJoint::GetDirectRowCount() const
+{
+	if (m_enableMotor || m_enableLimit)
+	{
+		return 0;
+	}
+
+	return 2;
+}
+
+// J = [-perp -s1 perp s2]
+//     [0     -1  0    1]
+void b2PrismaticJoint::GetDirectVelocityRows(b2JointRow* rows) const
+{
+	for (int32 i = 0; i < 2; ++i)
+	{
+		b2JointRow* row = rows + i;
+		row->indexA = m_indexA;
+		row->indexB = m_indexB;
+		row->invMassA = m_invMassA;
+		row->invIA = m_invIA;
+		row->invMassB = m_invMassB;
+		row->invIB = m_invIB;
+	}
+
+	rows[0].linearA = -m_perp;
+	rows[0].angularA = -m_s1;
+	rows[0].linearB = m_perp;
+	rows[0].angularB = m_s2;
+
+	rows[1].linearA.SetZero();
+	rows[1].angularA = -1.0f;
+	rows[1].linearB.SetZero();
+	rows[1].angularB = 1.0f;
+}
+
+bool b2PrismaticJoint::GetDirectPositionRows(const b2SolverData& data, b2JointRow* rows, float32* C) const
+{
+	b2Vec2 cA = data.positions[m_indexA].c;
+	float32 aA = data.positions[m_indexA].a;
+	b2Vec2 cB = data.positions[m_indexB].c;
+	float32 aB = data.positions[m_indexB].a;
+
+	b2Rot qA(aA), qB(aB);
+	b2Vec2 rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
+	b2Vec2 rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
+	b2Vec2 d = cB + rB - cA - rA;
+	b2Vec2 perp = b2Mul(qA, m_localYAxisA);
+
+	C[0] = b2Dot(perp, d);
+	C[1] = aB - aA - m_referenceAngle;
+
+	for (int32 i = 0; i < 2; ++i)
+	{
+		b2JointRow* row = rows + i;
+		row->indexA = m_indexA;
+		row->indexB = m_indexB;
+		row->invMassA = m_invMassA;
+		row->invIA = m_invIA;
+		row->invMassB = m_invMassB;
+		row->invIB = m_invIB;
+	}
+
+	rows[0].linearA = -perp;
+	rows[0].angularA = -b2Cross(d + rA, perp);
+	rows[0].linearB = perp;
+	rows[0].angularB = b2Cross(rB, perp);
+
+	rows[1].linearA.SetZero();
+	rows[1].angularA = -1.0f;
+	rows[1].linearB.SetZero();
+	rows[1].angularB = 1.0f;
+
+	return b2Abs(C[0]) <= b2_linearSlop && b2Abs(C[1]) <= b2_angularSlop;
+}
+
+void b2PrismaticJoint::AddDirectImpulses(const float32* impulses)
+{
+	m_impulse.x += impulses[0];
+	m_impulse.y += impulses[1];
+}
+
 b2Vec2 b2PrismaticJoint::GetAnchorA() const
 {
 	return m_bodyA->GetWorldPoint(m_localAnchorA);
@@ -493,12 +577,12 @@ b2Vec2 b2PrismaticJoint::GetAnchorB() const
 
 b2Vec2 b2PrismaticJoint::GetReactionForce(float32 inv_dt) const
 {
-	return inv_dt * (m_impulse.x * m_perp + (m_motorImpulse + m_impulse.z) * m_axis);
+	return m_substepCount * inv_dt * (m_impulse.x * m_perp + (m_motorImpulse + m_impulse.z) * m_axis);
 }
 
 float32 b2PrismaticJoint::GetReactionTorque(float32 inv_dt) const
 {
-	return inv_dt * m_impulse.y;
+	return m_substepCount * inv_dt * m_impulse.y;
 }
 
 float32 b2PrismaticJoint::GetJointTranslation() const
@@ -517,17 +601,17 @@ float32 b2PrismaticJoint::GetJointSpeed() const
 	b2Body* bA = m_bodyA;
 	b2Body* bB = m_bodyB;
 
-	b2Vec2 rA = b2Mul(bA->m_xf.q, m_localAnchorA - bA->m_sweep.localCenter);
-	b2Vec2 rB = b2Mul(bB->m_xf.q, m_localAnchorB - bB->m_sweep.localCenter);
-	b2Vec2 p1 = bA->m_sweep.c + rA;
-	b2Vec2 p2 = bB->m_sweep.c + rB;
+	b2Vec2 rA = b2Mul(bA->m_xf.q, m_localAnchorA - bA->m_sweep->localCenter);
+	b2Vec2 rB = b2Mul(bB->m_xf.q, m_localAnchorB - bB->m_sweep->localCenter);
+	b2Vec2 p1 = bA->m_sweep->c + rA;
+	b2Vec2 p2 = bB->m_sweep->c + rB;
 	b2Vec2 d = p2 - p1;
 	b2Vec2 axis = b2Mul(bA->m_xf.q, m_localXAxisA);
 
-	b2Vec2 vA = bA->m_linearVelocity;
-	b2Vec2 vB = bB->m_linearVelocity;
-	float32 wA = bA->m_angularVelocity;
-	float32 wB = bB->m_angularVelocity;
+	b2Vec2 vA = bA->m_velocity->v;
+	b2Vec2 vB = bB->m_velocity->v;
+	float32 wA = bA->m_velocity->w;
+	float32 wB = bB->m_velocity->w;
 
 	float32 speed = b2Dot(d, b2Cross(wA, axis)) + b2Dot(axis, vB + b2Cross(wB, rB) - vA - b2Cross(wA, rA));
 	return speed;
@@ -600,13 +684,13 @@ void b2PrismaticJoint::SetMaxMotorForce(float32 force)
 
 float32 b2PrismaticJoint::GetMotorForce(float32 inv_dt) const
 {
-	return inv_dt * m_motorImpulse;
+	return m_substepCount * inv_dt * m_motorImpulse;
 }
 
 void b2PrismaticJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	b2Log("  b2PrismaticJointDef jd;\n");
 	b2Log("  jd.bodyA = bodies[%d];\n", indexA);
@@ -150,12 +150,18 @@ public:
 protected:
 	friend class b2Joint;
 	friend class b2GearJoint;
+	friend class b2Scene;
 	b2PrismaticJoint(const b2PrismaticJointDef* def);
 
 	void InitVelocityConstraints(const b2SolverData& data);
 	void SolveVelocityConstraints(const b2SolverData& data);
 	bool SolvePositionConstraints(const b2SolverData& data);
 
+	int32 GetDirectRowCount() const;
+	void GetDirectVelocityRows(b2JointRow* rows) const;
+	bool GetDirectPositionRows(const b2SolverData& data, b2JointRow* rows, float32* C) const;
+	void AddDirectImpulses(const float32* impulses);
+
 	// Solver shared
 	b2Vec2 m_localAnchorA;
 	b2Vec2 m_localAnchorB;
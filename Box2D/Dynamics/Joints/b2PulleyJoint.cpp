@@ -72,10 +72,10 @@ b2PulleyJoint::b2PulleyJoint(const b2PulleyJointDef* def)
 
 void b2PulleyJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterA = m_bodyA->m_sweep->localCenter;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassA = m_bodyA->m_invMass;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIA = m_bodyA->m_invI;
@@ -272,7 +272,7 @@ b2Vec2 b2PulleyJoint::GetAnchorB() const
 b2Vec2 b2PulleyJoint::GetReactionForce(float32 inv_dt) const
 {
 	b2Vec2 P = m_impulse * m_uB;
-	return inv_dt * P;
+	return m_substepCount * inv_dt * P;
 }
 
 float32 b2PulleyJoint::GetReactionTorque(float32 inv_dt) const
@@ -324,8 +324,8 @@ float32 b2PulleyJoint::GetCurrentLengthB() const
 
 void b2PulleyJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	b2Log("  b2PulleyJointDef jd;\n");
 	b2Log("  jd.bodyA = bodies[%d];\n", indexA);
@@ -63,10 +63,10 @@ b2RevoluteJoint::b2RevoluteJoint(const b2RevoluteJointDef* def)
 
 void b2RevoluteJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterA = m_bodyA->m_sweep->localCenter;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassA = m_bodyA->m_invMass;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIA = m_bodyA->m_invI;
@@ -374,6 +374,89 @@ bool b2RevoluteJoint::SolvePositionConstraints(const b2SolverData& data)
 	return positionError <= b2_linearSlop && angularError <= b2_angularSlop;
 }
 
+// The point-to-point constraint is handed to the direct solver when there is no
+// motor or limit row to clamp.
+int32 b2RevoluteJoint::GetDirectRowCount() const
+{
+	if (m_enableMotor || m_enableLimit)
+	{
+		return 0;
+	}
+
+	return 2;
+}
+
+// Cdot = vB + cross(wB, rB) - vA - cross(wA, rA)
+// J = [-I -skew(rA) I skew(rB)], one row per axis
+void b2RevoluteJoint::GetDirectVelocityRows(b2JointRow* rows) const
+{
+	for (int32 i = 0; i < 2; ++i)
+	{
+		b2JointRow* row = rows + i;
+		row->indexA = m_indexA;
+		row->indexB = m_indexB;
+		row->invMassA = m_invMassA;
+		row->invIA = m_invIA;
+		row->invMassB = m_invMassB;
+		row->invIB = m_invIB;
+	}
+
+	rows[0].linearA.Set(-1.0f, 0.0f);
+	rows[0].angularA = m_rA.y;
+	rows[0].linearB.Set(1.0f, 0.0f);
+	rows[0].angularB = -m_rB.y;
+
+	rows[1].linearA.Set(0.0f, -1.0f);
+	rows[1].angularA = -m_rA.x;
+	rows[1].linearB.Set(0.0f, 1.0f);
+	rows[1].angularB = m_rB.x;
+}
+
+bool b2RevoluteJoint::GetDirectPositionRows(const b2SolverData& data, b2JointRow* rows, float32* C) const
+{
+	b2Vec2 cA = data.positions[m_indexA].c;
+	float32 aA = data.positions[m_indexA].a;
+	b2Vec2 cB = data.positions[m_indexB].c;
+	float32 aB = data.positions[m_indexB].a;
+
+	b2Rot qA(aA), qB(aB);
+	b2Vec2 rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
+	b2Vec2 rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
+
+	b2Vec2 error = cB + rB - cA - rA;
+	C[0] = error.x;
+	C[1] = error.y;
+
+	for (int32 i = 0; i < 2; ++i)
+	{
+		b2JointRow* row = rows + i;
+		row->indexA = m_indexA;
+		row->indexB = m_indexB;
+		row->invMassA = m_invMassA;
+		row->invIA = m_invIA;
+		row->invMassB = m_invMassB;
+		row->invIB = m_invIB;
+	}
+
+	rows[0].linearA.Set(-1.0f, 0.0f);
+	rows[0].angularA = rA.y;
+	rows[0].linearB.Set(1.0f, 0.0f);
+	rows[0].angularB = -rB.y;
+
+	rows[1].linearA.Set(0.0f, -1.0f);
+	rows[1].angularA = -rA.x;
+	rows[1].linearB.Set(0.0f, 1.0f);
+	rows[1].angularB = rB.x;
+
+	return error.Length() <= b2_linearSlop;
+}
+
+void b2RevoluteJoint::AddDirectImpulses(const float32* impulses)
+{
+	m_impulse.x += impulses[0];
+	m_impulse.y += impulses[1];
+}
+
 b2Vec2 b2RevoluteJoint::GetAnchorA() const
 {
 	return m_bodyA->GetWorldPoint(m_localAnchorA);
@@ -387,26 +470,26 @@ b2Vec2 b2RevoluteJoint::GetAnchorB() const
 b2Vec2 b2RevoluteJoint::GetReactionForce(float32 inv_dt) const
 {
 	b2Vec2 P(m_impulse.x, m_impulse.y);
-	return inv_dt * P;
+	return m_substepCount * inv_dt * P;
 }
 
 float32 b2RevoluteJoint::GetReactionTorque(float32 inv_dt) const
 {
-	return inv_dt * m_impulse.z;
+	return m_substepCount * inv_dt * m_impulse.z;
 }
 
 float32 b2RevoluteJoint::GetJointAngle() const
 {
 	b2Body* bA = m_bodyA;
 	b2Body* bB = m_bodyB;
-	return bB->m_sweep.a - bA->m_sweep.a - m_referenceAngle;
+	return bB->m_sweep->a - bA->m_sweep->a - m_referenceAngle;
 }
 
 float32 b2RevoluteJoint::GetJointSpeed() const
 {
 	b2Body* bA = m_bodyA;
 	b2Body* bB = m_bodyB;
-	return bB->m_angularVelocity - bA->m_angularVelocity;
+	return bB->m_velocity->w - bA->m_velocity->w;
 }
 
 bool b2RevoluteJoint::IsMotorEnabled() const
@@ -423,7 +506,7 @@ void b2RevoluteJoint::EnableMotor(bool flag)
 
 float32 b2RevoluteJoint::GetMotorTorque(float32 inv_dt) const
 {
-	return inv_dt * m_motorImpulse;
+	return m_substepCount * inv_dt * m_motorImpulse;
 }
 
 void b2RevoluteJoint::SetMotorSpeed(float32 speed)
@@ -482,8 +565,8 @@ void b2RevoluteJoint::SetLimits(float32 lower, float32 upper)
 
 void b2RevoluteJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	b2Log("  b2RevoluteJointDef jd;\n");
 	b2Log("  jd.bodyA = bodies[%d];\n", indexA);
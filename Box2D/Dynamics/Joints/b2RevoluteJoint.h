@@ -158,6 +158,7 @@ protected:
 
 	friend class b2Joint;
 	friend class b2GearJoint;
+	friend class b2JointBatchSolver;
 
 	b2RevoluteJoint(const b2RevoluteJointDef* def);
 
@@ -165,6 +166,11 @@ protected:
 	void SolveVelocityConstraints(const b2SolverData& data);
 	bool SolvePositionConstraints(const b2SolverData& data);
 
+	int32 GetDirectRowCount() const;
+	void GetDirectVelocityRows(b2JointRow* rows) const;
+	bool GetDirectPositionRows(const b2SolverData& data, b2JointRow* rows, float32* C) const;
+	void AddDirectImpulses(const float32* impulses);
+
 	// Solver shared
 	b2Vec2 m_localAnchorA;
 	b2Vec2 m_localAnchorB;
@@ -57,10 +57,10 @@ b2WeldJoint::b2WeldJoint(const b2WeldJointDef* def)
 
 void b2WeldJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterA = m_bodyA->m_sweep->localCenter;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassA = m_bodyA->m_invMass;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIA = m_bodyA->m_invI;
@@ -302,18 +302,18 @@ b2Vec2 b2WeldJoint::GetAnchorB() const
 b2Vec2 b2WeldJoint::GetReactionForce(float32 inv_dt) const
 {
 	b2Vec2 P(m_impulse.x, m_impulse.y);
-	return inv_dt * P;
+	return m_substepCount * inv_dt * P;
 }
 
 float32 b2WeldJoint::GetReactionTorque(float32 inv_dt) const
 {
-	return inv_dt * m_impulse.z;
+	return m_substepCount * inv_dt * m_impulse.z;
 }
 
 void b2WeldJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	b2Log("  b2WeldJointDef jd;\n");
 	b2Log("  jd.bodyA = bodies[%d];\n", indexA);
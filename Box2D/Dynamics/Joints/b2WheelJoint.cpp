@@ -76,10 +76,10 @@ b2WheelJoint::b2WheelJoint(const b2WheelJointDef* def)
 
 void b2WheelJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_indexA = m_bodyA->m_slot;
+	m_indexB = m_bodyB->m_slot;
+	m_localCenterA = m_bodyA->m_sweep->localCenter;
+	m_localCenterB = m_bodyB->m_sweep->localCenter;
 	m_invMassA = m_bodyA->m_invMass;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIA = m_bodyA->m_invI;
@@ -338,12 +338,12 @@ b2Vec2 b2WheelJoint::GetAnchorB() const
 
 b2Vec2 b2WheelJoint::GetReactionForce(float32 inv_dt) const
 {
-	return inv_dt * (m_impulse * m_ay + m_springImpulse * m_ax);
+	return m_substepCount * inv_dt * (m_impulse * m_ay + m_springImpulse * m_ax);
 }
 
 float32 b2WheelJoint::GetReactionTorque(float32 inv_dt) const
 {
-	return inv_dt * m_motorImpulse;
+	return m_substepCount * inv_dt * m_motorImpulse;
 }
 
 float32 b2WheelJoint::GetJointTranslation() const
@@ -362,8 +362,8 @@ float32 b2WheelJoint::GetJointTranslation() const
 
 float32 b2WheelJoint::GetJointSpeed() const
 {
-	float32 wA = m_bodyA->m_angularVelocity;
-	float32 wB = m_bodyB->m_angularVelocity;
+	float32 wA = m_bodyA->m_velocity->w;
+	float32 wB = m_bodyB->m_velocity->w;
 	return wB - wA;
 }
 
@@ -395,13 +395,13 @@ void b2WheelJoint::SetMaxMotorTorque(float32 torque)
 
 float32 b2WheelJoint::GetMotorTorque(float32 inv_dt) const
 {
-	return inv_dt * m_motorImpulse;
+	return m_substepCount * inv_dt * m_motorImpulse;
 }
 
 void b2WheelJoint::Dump()
 {
-	int32 indexA = m_bodyA->m_islandIndex;
-	int32 indexB = m_bodyB->m_islandIndex;
+	int32 indexA = m_bodyA->m_slot;
+	int32 indexB = m_bodyB->m_slot;
 
 	b2Log("  b2WheelJointDef jd;\n");
 	b2Log("  jd.bodyA = bodies[%d];\n", indexA);
@@ -21,8 +21,9 @@
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <new>
 
-b2Body::b2Body(const b2BodyDef* bd, b2World* world)
+b2Body::b2Body(const b2BodyDef* bd, b2World* world, int32 slot)
 {
 	b2Assert(bd->position.IsValid());
 	b2Assert(bd->linearVelocity.IsValid());
@@ -56,23 +57,28 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_world = world;
 
+	// The simulation state lives in the world's body storage.
+	m_slot = slot;
+	m_sweep = world->m_bodySweeps + slot;
+	m_velocity = world->m_bodyVelocities + slot;
+
 	m_xf.p = bd->position;
 	m_xf.q.Set(bd->angle);
 
-	m_sweep.localCenter.SetZero();
-	m_sweep.c0 = m_xf.p;
-	m_sweep.c = m_xf.p;
-	m_sweep.a0 = bd->angle;
-	m_sweep.a = bd->angle;
-	m_sweep.alpha0 = 0.0f;
+	m_sweep->localCenter.SetZero();
+	m_sweep->c0 = m_xf.p;
+	m_sweep->c = m_xf.p;
+	m_sweep->a0 = bd->angle;
+	m_sweep->a = bd->angle;
+	m_sweep->alpha0 = 0.0f;
 
 	m_jointList = NULL;
 	m_contactList = NULL;
 	m_prev = NULL;
 	m_next = NULL;
 
-	m_linearVelocity = bd->linearVelocity;
-	m_angularVelocity = bd->angularVelocity;
+	m_velocity->v = bd->linearVelocity;
+	m_velocity->w = bd->angularVelocity;
 
 	m_linearDamping = bd->linearDamping;
 	m_angularDamping = bd->angularDamping;
@@ -103,11 +109,38 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_fixtureList = NULL;
 	m_fixtureCount = 0;
+
+	m_compoundTree = NULL;
+	m_compoundProxy = NULL;
+	m_compoundBounds.lowerBound.SetZero();
+	m_compoundBounds.upperBound.SetZero();
+
+	if (bd->compound)
+	{
+		b2BlockAllocator* allocator = &world->m_blockAllocator;
+
+		void* mem = allocator->Allocate(sizeof(b2DynamicTree));
+		m_compoundTree = new (mem) b2DynamicTree(&world->m_allocator);
+
+		m_compoundProxy = (b2FixtureProxy*)allocator->Allocate(sizeof(b2FixtureProxy));
+		m_compoundProxy->aabb = m_compoundBounds;
+		m_compoundProxy->fixture = NULL;
+		m_compoundProxy->body = this;
+		m_compoundProxy->childIndex = 0;
+		m_compoundProxy->proxyId = b2BroadPhase::e_nullProxy;
+	}
 }
 
 b2Body::~b2Body()
 {
 	// shapes and joints are destroyed in b2World::Destroy
+	if (m_compoundTree)
+	{
+		b2BlockAllocator* allocator = &m_world->m_blockAllocator;
+		m_compoundTree->~b2DynamicTree();
+		allocator->Free(m_compoundTree, sizeof(b2DynamicTree));
+		allocator->Free(m_compoundProxy, sizeof(b2FixtureProxy));
+	}
 }
 
 void b2Body::SetType(b2BodyType type)
@@ -129,10 +162,10 @@ void b2Body::SetType(b2BodyType type)
 
 	if (m_type == b2_staticBody)
 	{
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
-		m_sweep.a0 = m_sweep.a;
-		m_sweep.c0 = m_sweep.c;
+		m_velocity->v.SetZero();
+		m_velocity->w = 0.0f;
+		m_sweep->a0 = m_sweep->a;
+		m_sweep->c0 = m_sweep->c;
 		SynchronizeFixtures();
 	}
 
@@ -153,6 +186,15 @@ void b2Body::SetType(b2BodyType type)
 
 	// Touch the proxies so that new contacts will be created (when appropriate)
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	if (m_compoundTree)
+	{
+		if (m_compoundProxy->proxyId != b2BroadPhase::e_nullProxy)
+		{
+			broadPhase->TouchProxy(m_compoundProxy->proxyId);
+		}
+		return;
+	}
+
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
 		int32 proxyCount = f->m_proxyCount;
@@ -171,11 +213,7 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 		return NULL;
 	}
 
-	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
-
-	void* memory = allocator->Allocate(sizeof(b2Fixture));
-	b2Fixture* fixture = new (memory) b2Fixture;
-	fixture->Create(allocator, this, def);
+	b2Fixture* fixture = AddFixture(def);
 
 	if (m_flags & e_activeFlag)
 	{
@@ -183,11 +221,7 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 		fixture->CreateProxies(broadPhase, m_xf);
 	}
 
-	fixture->m_next = m_fixtureList;
-	m_fixtureList = fixture;
-	++m_fixtureCount;
-
-	fixture->m_body = this;
+	ResetCompoundProxy();
 
 	// Adjust mass properties if needed.
 	if (fixture->m_density > 0.0f)
@@ -202,6 +236,58 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 	return fixture;
 }
 
+void b2Body::CreateFixtures(const b2FixtureDef* defs, int32 count, b2Fixture** fixtures)
+{
+	b2Assert(m_world->IsLocked() == false);
+	if (m_world->IsLocked() == true)
+	{
+		return;
+	}
+
+	bool hasDensity = false;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Fixture* fixture = AddFixture(defs + i);
+		hasDensity = hasDensity || fixture->m_density > 0.0f;
+
+		if (fixtures)
+		{
+			fixtures[i] = fixture;
+		}
+	}
+
+	b2Body* body = this;
+	m_world->CreateFixtureProxies(&body, 1);
+
+	ResetCompoundProxy();
+
+	if (hasDensity)
+	{
+		ResetMassData();
+	}
+
+	m_world->m_flags |= b2World::e_newFixture;
+}
+
+b2Fixture* b2Body::AddFixture(const b2FixtureDef* def)
+{
+	b2BlockAllocator* allocator = &m_world->m_fixtureAllocator;
+
+	void* memory = allocator->Allocate(sizeof(b2Fixture));
+	b2Fixture* fixture = new (memory) b2Fixture;
+	fixture->Create(allocator, this, def);
+	fixture->m_id.index = m_world->m_fixtureHandles.Create(fixture);
+	fixture->m_id.generation = m_world->m_fixtureHandles.GetGeneration(fixture->m_id.index);
+
+	fixture->m_next = m_fixtureList;
+	m_fixtureList = fixture;
+	++m_fixtureCount;
+
+	fixture->m_body = this;
+
+	return fixture;
+}
+
 b2Fixture* b2Body::CreateFixture(const b2Shape* shape, float32 density)
 {
 	b2FixtureDef def;
@@ -211,6 +297,15 @@ b2Fixture* b2Body::CreateFixture(const b2Shape* shape, float32 density)
 	return CreateFixture(&def);
 }
 
+b2Fixture* b2Body::CreateFixture(b2SharedShape* shape, float32 density)
+{
+	b2FixtureDef def;
+	def.sharedShape = shape;
+	def.density = density;
+
+	return CreateFixture(&def);
+}
+
 void b2Body::DestroyFixture(b2Fixture* fixture)
 {
 	b2Assert(m_world->IsLocked() == false);
@@ -258,7 +353,7 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 		}
 	}
 
-	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
+	b2BlockAllocator* allocator = &m_world->m_fixtureAllocator;
 
 	if (m_flags & e_activeFlag)
 	{
@@ -266,6 +361,8 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 		fixture->DestroyProxies(broadPhase);
 	}
 
+	m_world->m_fixtureHandles.Destroy(fixture->m_id.index);
+	m_world->DestroyUserData(fixture);
 	fixture->Destroy(allocator);
 	fixture->m_body = NULL;
 	fixture->m_next = NULL;
@@ -274,6 +371,8 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 
 	--m_fixtureCount;
 
+	ResetCompoundProxy();
+
 	// Reset the mass data.
 	ResetMassData();
 }
@@ -285,14 +384,14 @@ void b2Body::ResetMassData()
 	m_invMass = 0.0f;
 	m_I = 0.0f;
 	m_invI = 0.0f;
-	m_sweep.localCenter.SetZero();
+	m_sweep->localCenter.SetZero();
 
 	// Static and kinematic bodies have zero mass.
 	if (m_type == b2_staticBody || m_type == b2_kinematicBody)
 	{
-		m_sweep.c0 = m_xf.p;
-		m_sweep.c = m_xf.p;
-		m_sweep.a0 = m_sweep.a;
+		m_sweep->c0 = m_xf.p;
+		m_sweep->c = m_xf.p;
+		m_sweep->a0 = m_sweep->a;
 		return;
 	}
 
@@ -342,12 +441,12 @@ void b2Body::ResetMassData()
 	}
 
 	// Move center of mass.
-	b2Vec2 oldCenter = m_sweep.c;
-	m_sweep.localCenter = localCenter;
-	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	b2Vec2 oldCenter = m_sweep->c;
+	m_sweep->localCenter = localCenter;
+	m_sweep->c0 = m_sweep->c = b2Mul(m_xf, m_sweep->localCenter);
 
 	// Update center of mass velocity.
-	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
+	m_velocity->v += b2Cross(m_velocity->w, m_sweep->c - oldCenter);
 }
 
 void b2Body::SetMassData(const b2MassData* massData)
@@ -383,12 +482,12 @@ void b2Body::SetMassData(const b2MassData* massData)
 	}
 
 	// Move center of mass.
-	b2Vec2 oldCenter = m_sweep.c;
-	m_sweep.localCenter =  massData->center;
-	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	b2Vec2 oldCenter = m_sweep->c;
+	m_sweep->localCenter =  massData->center;
+	m_sweep->c0 = m_sweep->c = b2Mul(m_xf, m_sweep->localCenter);
 
 	// Update center of mass velocity.
-	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
+	m_velocity->v += b2Cross(m_velocity->w, m_sweep->c - oldCenter);
 }
 
 bool b2Body::ShouldCollide(const b2Body* other) const
@@ -425,11 +524,19 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 	m_xf.q.Set(angle);
 	m_xf.p = position;
 
-	m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
-	m_sweep.a = angle;
+	m_sweep->c = b2Mul(m_xf, m_sweep->localCenter);
+	m_sweep->a = angle;
+
+	m_sweep->c0 = m_sweep->c;
+	m_sweep->a0 = angle;
 
-	m_sweep.c0 = m_sweep.c;
-	m_sweep.a0 = angle;
+	m_flags |= e_proxyMoveFlag;
+
+	if (m_compoundTree)
+	{
+		SynchronizeCompound(m_xf, m_xf);
+		return;
+	}
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
@@ -441,14 +548,101 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 void b2Body::SynchronizeFixtures()
 {
 	b2Transform xf1;
-	xf1.q.Set(m_sweep.a0);
-	xf1.p = m_sweep.c0 - b2Mul(xf1.q, m_sweep.localCenter);
+	if (m_world->m_rotationIntegration)
+	{
+		// Turn the current rotation back to the start of the sweep.
+		xf1.q = b2IntegrateRotation(m_xf.q, m_sweep->a0 - m_sweep->a);
+	}
+	else
+	{
+		xf1.q.Set(m_sweep->a0);
+	}
+	xf1.p = m_sweep->c0 - b2Mul(xf1.q, m_sweep->localCenter);
+
+	SynchronizeFixtures(xf1, m_xf);
+}
+
+void b2Body::SynchronizeFixtures(const b2Transform& xf1, const b2Transform& xf2)
+{
+	// Compound pairs of this body need to be walked again.
+	m_flags |= e_proxyMoveFlag;
+
+	if (m_compoundTree)
+	{
+		SynchronizeCompound(xf1, xf2);
+		return;
+	}
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
-		f->Synchronize(broadPhase, xf1, m_xf);
+		f->Synchronize(broadPhase, xf1, xf2);
+	}
+}
+
+void b2Body::ResetCompoundProxy()
+{
+	if (m_compoundTree == NULL)
+	{
+		return;
+	}
+
+	b2ContactManager* contactManager = &m_world->m_contactManager;
+	b2BroadPhase* broadPhase = &contactManager->m_broadPhase;
+
+	if (m_compoundProxy->proxyId != b2BroadPhase::e_nullProxy)
+	{
+		contactManager->RemoveCompoundPairs(m_compoundProxy);
+		broadPhase->DestroyProxy(m_compoundProxy->proxyId);
+		m_compoundProxy->proxyId = b2BroadPhase::e_nullProxy;
+	}
+
+	if ((m_flags & e_activeFlag) == 0 || m_fixtureList == NULL)
+	{
+		return;
+	}
+
+	// Bound the fat AABBs of the fixture tree in body space.
+	bool first = true;
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		for (int32 i = 0; i < f->m_proxyCount; ++i)
+		{
+			const b2AABB& aabb = m_compoundTree->GetFatAABB(f->m_proxies[i].proxyId);
+			if (first)
+			{
+				m_compoundBounds = aabb;
+				first = false;
+			}
+			else
+			{
+				m_compoundBounds.Combine(aabb);
+			}
+		}
+	}
+
+	b2TransformAABB(&m_compoundProxy->aabb, m_xf, m_compoundBounds);
+	m_compoundProxy->proxyId = broadPhase->CreateProxy(m_compoundProxy->aabb, m_compoundProxy);
+}
+
+void b2Body::SynchronizeCompound(const b2Transform& xf1, const b2Transform& xf2)
+{
+	if (m_compoundProxy->proxyId == b2BroadPhase::e_nullProxy)
+	{
+		return;
 	}
+
+	// Only the body proxy moves. The fixture tree is in body space.
+	b2AABB aabb1, aabb2;
+	b2TransformAABB(&aabb1, xf1, m_compoundBounds);
+	b2TransformAABB(&aabb2, xf2, m_compoundBounds);
+
+	m_compoundProxy->aabb.Combine(aabb1, aabb2);
+
+	b2Vec2 displacement = aabb2.GetCenter() - aabb1.GetCenter();
+
+	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	broadPhase->MoveProxy(m_compoundProxy->proxyId, m_compoundProxy->aabb, displacement);
 }
 
 void b2Body::SetActive(bool flag)
@@ -471,6 +665,8 @@ void b2Body::SetActive(bool flag)
 			f->CreateProxies(broadPhase, m_xf);
 		}
 
+		ResetCompoundProxy();
+
 		// Contacts are created the next time step.
 	}
 	else
@@ -484,6 +680,8 @@ void b2Body::SetActive(bool flag)
 			f->DestroyProxies(broadPhase);
 		}
 
+		ResetCompoundProxy();
+
 		// Destroy the attached contacts.
 		b2ContactEdge* ce = m_contactList;
 		while (ce)
@@ -496,6 +694,12 @@ void b2Body::SetActive(bool flag)
 	}
 }
 
+void b2Body::SetUserData(void* data)
+{
+	m_world->DestroyUserData(this);
+	m_userData = data;
+}
+
 void b2Body::SetFixedRotation(bool flag)
 {
 	bool status = (m_flags & e_fixedRotationFlag) == e_fixedRotationFlag;
@@ -513,31 +717,32 @@ void b2Body::SetFixedRotation(bool flag)
 		m_flags &= ~e_fixedRotationFlag;
 	}
 
-	m_angularVelocity = 0.0f;
+	m_velocity->w = 0.0f;
 
 	ResetMassData();
 }
 
 void b2Body::Dump()
 {
-	int32 bodyIndex = m_islandIndex;
+	int32 bodyIndex = m_slot;
 
 	b2Log("{\n");
 	b2Log("  b2BodyDef bd;\n");
 	b2Log("  bd.type = b2BodyType(%d);\n", m_type);
 	b2Log("  bd.position.Set(%.15lef, %.15lef);\n", m_xf.p.x, m_xf.p.y);
-	b2Log("  bd.angle = %.15lef;\n", m_sweep.a);
-	b2Log("  bd.linearVelocity.Set(%.15lef, %.15lef);\n", m_linearVelocity.x, m_linearVelocity.y);
-	b2Log("  bd.angularVelocity = %.15lef;\n", m_angularVelocity);
+	b2Log("  bd.angle = %.15lef;\n", m_sweep->a);
+	b2Log("  bd.linearVelocity.Set(%.15lef, %.15lef);\n", m_velocity->v.x, m_velocity->v.y);
+	b2Log("  bd.angularVelocity = %.15lef;\n", m_velocity->w);
 	b2Log("  bd.linearDamping = %.15lef;\n", m_linearDamping);
 	b2Log("  bd.angularDamping = %.15lef;\n", m_angularDamping);
 	b2Log("  bd.allowSleep = bool(%d);\n", m_flags & e_autoSleepFlag);
 	b2Log("  bd.awake = bool(%d);\n", m_flags & e_awakeFlag);
 	b2Log("  bd.fixedRotation = bool(%d);\n", m_flags & e_fixedRotationFlag);
 	b2Log("  bd.bullet = bool(%d);\n", m_flags & e_bulletFlag);
+	b2Log("  bd.compound = bool(%d);\n", m_compoundTree != NULL);
 	b2Log("  bd.active = bool(%d);\n", m_flags & e_activeFlag);
 	b2Log("  bd.gravityScale = %.15lef;\n", m_gravityScale);
-	b2Log("  bodies[%d] = m_world->CreateBody(&bd);\n", m_islandIndex);
+	b2Log("  bodies[%d] = m_world->CreateBody(&bd);\n", m_slot);
 	b2Log("\n");
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
@@ -21,14 +21,20 @@
 
 #include <Common/b2Math.h>
 #include <Collision/Shapes/b2Shape.h>
+#include <Collision/b2Collision.h>
+#include <Dynamics/b2TimeStep.h>
+#include <Dynamics/b2Id.h>
 #include <memory>
 
 class b2Fixture;
+class b2SharedShape;
 class b2Joint;
 class b2Contact;
 class b2Controller;
 class b2World;
+class b2DynamicTree;
 struct b2FixtureDef;
+struct b2FixtureProxy;
 struct b2JointEdge;
 struct b2ContactEdge;
 
@@ -64,6 +70,7 @@ struct b2BodyDef
 		awake = true;
 		fixedRotation = false;
 		bullet = false;
+		compound = false;
 		type = b2_staticBody;
 		active = true;
 		gravityScale = 1.0f;
@@ -112,6 +119,12 @@ struct b2BodyDef
 	/// @warning You should use this flag sparingly since it increases processing time.
 	bool bullet;
 
+	/// Should the fixtures of this body be kept in a private tree in body space?
+	/// A compound body has a single broad-phase proxy that bounds all of its
+	/// fixtures, so moving it only moves one proxy. Use this for rigid bodies
+	/// with many fixtures. This cannot be changed after creation.
+	bool compound;
+
 	/// Does this body start out active?
 	bool active;
 
@@ -144,6 +157,22 @@ public:
 	/// @warning This function is locked during callbacks.
 	b2Fixture* CreateFixture(const b2Shape* shape, float32 density);
 
+	/// Creates a fixture that references a shared shape and attach it to this body.
+	/// This is a convenience function like the one above, but the shape is not cloned.
+	/// @param shape the shared shape, created by b2World::CreateSharedShape.
+	/// @param density the shape density (set to zero for static bodies).
+	/// @warning This function is locked during callbacks.
+	b2Fixture* CreateFixture(b2SharedShape* shape, float32 density);
+
+	/// Creates many fixtures at once. The mass is updated once and the broad-phase
+	/// proxies are inserted together, which is much faster than calling
+	/// CreateFixture in a loop for bodies with many fixtures.
+	/// @param defs the fixture definitions.
+	/// @param count the number of fixture definitions.
+	/// @param fixtures optional, receives the fixtures in the order of the definitions.
+	/// @warning This function is locked during callbacks.
+	void CreateFixtures(const b2FixtureDef* defs, int32 count, b2Fixture** fixtures = NULL);
+
 	/// Destroy a fixture. This removes the fixture from the broad-phase and
 	/// destroys all contacts associated with this fixture. This will
 	/// automatically adjust the mass of the body if the body is dynamic and the
@@ -173,10 +202,10 @@ public:
 	float32 GetAngle() const;
 
 	/// Get the world position of the center of mass.
-	const b2Vec2& GetWorldCenter() const;
+	b2Vec2 GetWorldCenter() const;
 
 	/// Get the local position of the center of mass.
-	const b2Vec2& GetLocalCenter() const;
+	b2Vec2 GetLocalCenter() const;
 
 	/// Set the linear velocity of the center of mass.
 	/// @param v the new linear velocity of the center of mass.
@@ -184,7 +213,7 @@ public:
 
 	/// Get the linear velocity of the center of mass.
 	/// @return the linear velocity of the center of mass.
-	const b2Vec2& GetLinearVelocity() const;
+	b2Vec2 GetLinearVelocity() const;
 
 	/// Set the angular velocity.
 	/// @param omega the new angular velocity in radians/second.
@@ -311,6 +340,9 @@ public:
 	/// Is this body treated like a bullet for continuous collision detection?
 	bool IsBullet() const;
 
+	/// Are the fixtures of this body kept in a private body-space tree?
+	bool IsCompound() const;
+
 	/// You can disable sleeping on this body. If you disable sleeping, the
 	/// body will be woken.
 	void SetSleepingAllowed(bool flag);
@@ -370,10 +402,14 @@ public:
 	b2Body* GetNext();
 	const b2Body* GetNext() const;
 
+	/// Get the handle of this body, see b2World::GetBody.
+	b2BodyId GetId() const;
+
 	/// Get the user data pointer that was provided in the body definition.
 	void* GetUserData() const;
 
 	/// Set the user data. Use this to store your application specific data.
+	/// User data owned by the world is destroyed first, see b2World::DestroyUserData.
 	void SetUserData(void* data);
 
 	/// Get the parent world of this body.
@@ -390,6 +426,10 @@ private:
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
 	friend class b2Contact;
+	friend class b2Fixture;
+	friend class b2Scene;
+	friend struct b2WorldQueryWrapper;
+	friend struct b2WorldRayCastWrapper;
 
 	friend class b2DistanceJoint;
 	friend class b2FrictionJoint;
@@ -412,15 +452,29 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_proxyMoveFlag		= 0x0080,
+		e_userDataFlag		= 0x0100	// the user data is owned by the world
 	};
 
-	b2Body(const b2BodyDef* bd, b2World* world);
+	b2Body(const b2BodyDef* bd, b2World* world, int32 slot);
 	~b2Body();
 
 	void SynchronizeFixtures();
 	void SynchronizeTransform();
 
+	// Move the proxies to cover the motion from xf1 to xf2.
+	void SynchronizeFixtures(const b2Transform& xf1, const b2Transform& xf2);
+
+	// Compound bodies: rebuild or move the single broad-phase proxy that
+	// bounds the fixture tree.
+	void ResetCompoundProxy();
+
+	// Create a fixture and link it to this body. The caller creates the proxies
+	// and resets the mass.
+	b2Fixture* AddFixture(const b2FixtureDef* def);
+	void SynchronizeCompound(const b2Transform& xf1, const b2Transform& xf2);
+
 	// This is used to prevent connected bodies from colliding.
 	// It may lie, depending on the collideConnected flag.
 	bool ShouldCollide(const b2Body* other) const;
@@ -431,13 +485,14 @@ private:
 
 	uint16 m_flags;
 
-	int32 m_islandIndex;
+	// The body is a handle to its slot in the world's body storage. The islands
+	// solve on the storage in place.
+	int32 m_slot;
+	b2BodyId m_id;
+	b2Sweep* m_sweep;		// the swept motion for CCD
+	b2Velocity* m_velocity;
 
 	b2Transform m_xf;		// the body origin transform
-	b2Sweep m_sweep;		// the swept motion for CCD
-
-	b2Vec2 m_linearVelocity;
-	float32 m_angularVelocity;
 
 	b2Vec2 m_force;
 	float32 m_torque;
@@ -449,6 +504,12 @@ private:
 	b2Fixture* m_fixtureList;
 	int32 m_fixtureCount;
 
+	// Compound bodies only. Fixture proxies live in a body-space tree and the
+	// broad-phase sees m_compoundProxy, which bounds m_compoundBounds.
+	b2DynamicTree* m_compoundTree;
+	b2FixtureProxy* m_compoundProxy;
+	b2AABB m_compoundBounds;
+
 	b2JointEdge* m_jointList;
 	b2ContactEdge* m_contactList;
 
@@ -483,17 +544,17 @@ inline const b2Vec2& b2Body::GetPosition() const
 
 inline float32 b2Body::GetAngle() const
 {
-	return m_sweep.a;
+	return m_sweep->a;
 }
 
-inline const b2Vec2& b2Body::GetWorldCenter() const
+inline b2Vec2 b2Body::GetWorldCenter() const
 {
-	return m_sweep.c;
+	return m_sweep->c;
 }
 
-inline const b2Vec2& b2Body::GetLocalCenter() const
+inline b2Vec2 b2Body::GetLocalCenter() const
 {
-	return m_sweep.localCenter;
+	return m_sweep->localCenter;
 }
 
 inline void b2Body::SetLinearVelocity(const b2Vec2& v)
@@ -508,12 +569,12 @@ inline void b2Body::SetLinearVelocity(const b2Vec2& v)
 		SetAwake(true);
 	}
 
-	m_linearVelocity = v;
+	m_velocity->v = v;
 }
 
-inline const b2Vec2& b2Body::GetLinearVelocity() const
+inline b2Vec2 b2Body::GetLinearVelocity() const
 {
-	return m_linearVelocity;
+	return m_velocity->v;
 }
 
 inline void b2Body::SetAngularVelocity(float32 w)
@@ -528,12 +589,12 @@ inline void b2Body::SetAngularVelocity(float32 w)
 		SetAwake(true);
 	}
 
-	m_angularVelocity = w;
+	m_velocity->w = w;
 }
 
 inline float32 b2Body::GetAngularVelocity() const
 {
-	return m_angularVelocity;
+	return m_velocity->w;
 }
 
 inline float32 b2Body::GetMass() const
@@ -543,14 +604,14 @@ inline float32 b2Body::GetMass() const
 
 inline float32 b2Body::GetInertia() const
 {
-	return m_I + m_mass * b2Dot(m_sweep.localCenter, m_sweep.localCenter);
+	return m_I + m_mass * b2Dot(m_sweep->localCenter, m_sweep->localCenter);
 }
 
 inline void b2Body::GetMassData(b2MassData* data) const
 {
 	data->mass = m_mass;
-	data->I = m_I + m_mass * b2Dot(m_sweep.localCenter, m_sweep.localCenter);
-	data->center = m_sweep.localCenter;
+	data->I = m_I + m_mass * b2Dot(m_sweep->localCenter, m_sweep->localCenter);
+	data->center = m_sweep->localCenter;
 }
 
 inline b2Vec2 b2Body::GetWorldPoint(const b2Vec2& localPoint) const
@@ -575,7 +636,7 @@ inline b2Vec2 b2Body::GetLocalVector(const b2Vec2& worldVector) const
 
 inline b2Vec2 b2Body::GetLinearVelocityFromWorldPoint(const b2Vec2& worldPoint) const
 {
-	return m_linearVelocity + b2Cross(m_angularVelocity, worldPoint - m_sweep.c);
+	return m_velocity->v + b2Cross(m_velocity->w, worldPoint - m_sweep->c);
 }
 
 inline b2Vec2 b2Body::GetLinearVelocityFromLocalPoint(const b2Vec2& localPoint) const
@@ -644,8 +705,8 @@ inline void b2Body::SetAwake(bool flag)
 	{
 		m_flags &= ~e_awakeFlag;
 		m_sleepTime = 0.0f;
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
+		m_velocity->v.SetZero();
+		m_velocity->w = 0.0f;
 		m_force.SetZero();
 		m_torque = 0.0f;
 	}
@@ -656,6 +717,11 @@ inline bool b2Body::IsAwake() const
 	return (m_flags & e_awakeFlag) == e_awakeFlag;
 }
 
+inline bool b2Body::IsCompound() const
+{
+	return m_compoundTree != NULL;
+}
+
 inline bool b2Body::IsActive() const
 {
 	return (m_flags & e_activeFlag) == e_activeFlag;
@@ -724,9 +790,9 @@ inline const b2Body* b2Body::GetNext() const
 	return m_next;
 }
 
-inline void b2Body::SetUserData(void* data)
+inline b2BodyId b2Body::GetId() const
 {
-	m_userData = data;
+	return m_id;
 }
 
 inline void* b2Body::GetUserData() const
@@ -750,7 +816,7 @@ inline void b2Body::ApplyForce(const b2Vec2& force, const b2Vec2& point, bool wa
 	if (m_flags & e_awakeFlag)
 	{
 		m_force += force;
-		m_torque += b2Cross(point - m_sweep.c, force);
+		m_torque += b2Cross(point - m_sweep->c, force);
 	}
 }
 
@@ -807,8 +873,8 @@ inline void b2Body::ApplyLinearImpulse(const b2Vec2& impulse, const b2Vec2& poin
 	// Don't accumulate velocity if the body is sleeping
 	if (m_flags & e_awakeFlag)
 	{
-		m_linearVelocity += m_invMass * impulse;
-		m_angularVelocity += m_invI * b2Cross(point - m_sweep.c, impulse);
+		m_velocity->v += m_invMass * impulse;
+		m_velocity->w += m_invI * b2Cross(point - m_sweep->c, impulse);
 	}
 }
 
@@ -827,24 +893,24 @@ inline void b2Body::ApplyAngularImpulse(float32 impulse, bool wake)
 	// Don't accumulate velocity if the body is sleeping
 	if (m_flags & e_awakeFlag)
 	{
-		m_angularVelocity += m_invI * impulse;
+		m_velocity->w += m_invI * impulse;
 	}
 }
 
 inline void b2Body::SynchronizeTransform()
 {
-	m_xf.q.Set(m_sweep.a);
-	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
+	m_xf.q.Set(m_sweep->a);
+	m_xf.p = m_sweep->c - b2Mul(m_xf.q, m_sweep->localCenter);
 }
 
 inline void b2Body::Advance(float32 alpha)
 {
 	// Advance to the new safe time. This doesn't sync the broad-phase.
-	m_sweep.Advance(alpha);
-	m_sweep.c = m_sweep.c0;
-	m_sweep.a = m_sweep.a0;
-	m_xf.q.Set(m_sweep.a);
-	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
+	m_sweep->Advance(alpha);
+	m_sweep->c = m_sweep->c0;
+	m_sweep->a = m_sweep->a0;
+	m_xf.q.Set(m_sweep->a);
+	m_xf.p = m_sweep->c - b2Mul(m_xf.q, m_sweep->localCenter);
 }
 
 inline b2World* b2Body::GetWorld()
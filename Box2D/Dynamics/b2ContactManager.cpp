@@ -25,13 +25,189 @@
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
-b2ContactManager::b2ContactManager()
+b2ContactManager::b2ContactManager(b2Allocator* allocator)
+	: m_broadPhase(allocator)
 {
+	m_heapAllocator = allocator ? allocator : b2GetDefaultAllocator();
 	m_contactList = NULL;
 	m_contactCount = 0;
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = NULL;
+	m_creationStamp = 0;
+	m_speculativeTime = 0.0f;
+
+	for (int32 i = 0; i < b2Shape::e_typeCount; ++i)
+	{
+		for (int32 j = 0; j < b2Shape::e_typeCount; ++j)
+		{
+			b2ContactBatch* batch = &m_batches[i][j];
+			batch->contacts = NULL;
+			batch->count = 0;
+			batch->capacity = 0;
+			batch->pendingCount = 0;
+		}
+	}
+
+	m_oldManifoldCapacity = 0;
+	m_oldManifolds = NULL;
+
+	m_compoundPairs = NULL;
+	m_compoundPairCount = 0;
+	m_compoundPairCapacity = 0;
+	m_mergeCompoundPairs = false;
+
+	m_queryProxy = NULL;
+	m_queryTreeA = NULL;
+	m_queryTreeB = NULL;
+}
+
+b2ContactManager::~b2ContactManager()
+{
+	for (int32 i = 0; i < b2Shape::e_typeCount; ++i)
+	{
+		for (int32 j = 0; j < b2Shape::e_typeCount; ++j)
+		{
+			if (m_batches[i][j].contacts)
+			{
+				m_heapAllocator->Free(m_batches[i][j].contacts, m_batches[i][j].capacity * sizeof(b2Contact*), b2_contactMemory);
+			}
+		}
+	}
+
+	if (m_oldManifolds)
+	{
+		m_heapAllocator->Free(m_oldManifolds, m_oldManifoldCapacity * sizeof(b2Manifold), b2_contactMemory);
+	}
+
+	if (m_compoundPairs)
+	{
+		m_heapAllocator->Free(m_compoundPairs, m_compoundPairCapacity * sizeof(b2CompoundPair), b2_contactMemory);
+	}
+}
+
+void b2ContactManager::Reserve(int32 proxyCount, int32 contactCount)
+{
+	m_broadPhase.Reserve(proxyCount, contactCount);
+
+	if (contactCount > m_oldManifoldCapacity)
+	{
+		if (m_oldManifolds)
+		{
+			m_heapAllocator->Free(m_oldManifolds, m_oldManifoldCapacity * sizeof(b2Manifold), b2_contactMemory);
+		}
+
+		m_oldManifoldCapacity = contactCount;
+		m_oldManifolds = (b2Manifold*)m_heapAllocator->Allocate(m_oldManifoldCapacity * sizeof(b2Manifold), b2_contactMemory);
+	}
+}
+
+void b2ContactManager::AddToBatch(b2Contact* c)
+{
+	b2Shape::Type typeA = c->GetFixtureA()->GetType();
+	b2Shape::Type typeB = c->GetFixtureB()->GetType();
+	b2ContactBatch* batch = &m_batches[typeA][typeB];
+
+	// Grow the batch as needed.
+	if (batch->count == batch->capacity)
+	{
+		b2Contact** oldContacts = batch->contacts;
+		batch->capacity = b2Max(2 * batch->capacity, 16);
+		batch->contacts = (b2Contact**)m_heapAllocator->Allocate(batch->capacity * sizeof(b2Contact*), b2_contactMemory);
+		if (oldContacts)
+		{
+			memcpy(batch->contacts, oldContacts, batch->count * sizeof(b2Contact*));
+			m_heapAllocator->Free(oldContacts, batch->count * sizeof(b2Contact*), b2_contactMemory);
+		}
+	}
+
+	c->m_batchIndex = batch->count;
+	batch->contacts[batch->count] = c;
+	++batch->count;
+}
+
+void b2ContactManager::RemoveFromBatch(b2Contact* c)
+{
+	b2Shape::Type typeA = c->GetFixtureA()->GetType();
+	b2Shape::Type typeB = c->GetFixtureB()->GetType();
+	b2ContactBatch* batch = &m_batches[typeA][typeB];
+
+	int32 index = c->m_batchIndex;
+	b2Assert(0 <= index && index < batch->count);
+	b2Assert(batch->contacts[index] == c);
+
+	// Contacts are only destroyed before they are marked as pending.
+	b2Assert(index >= batch->pendingCount);
+
+	// Swap the last contact into the hole.
+	--batch->count;
+	b2Contact* last = batch->contacts[batch->count];
+	batch->contacts[index] = last;
+	last->m_batchIndex = index;
+	c->m_batchIndex = -1;
+}
+
+// Move the contact to the pending section at the front of its batch.
+void b2ContactManager::MarkPending(b2Contact* c)
+{
+	b2Shape::Type typeA = c->GetFixtureA()->GetType();
+	b2Shape::Type typeB = c->GetFixtureB()->GetType();
+	b2ContactBatch* batch = &m_batches[typeA][typeB];
+
+	int32 index = c->m_batchIndex;
+	int32 pendingIndex = batch->pendingCount;
+	b2Assert(index >= pendingIndex);
+
+	b2Contact* other = batch->contacts[pendingIndex];
+	batch->contacts[pendingIndex] = c;
+	c->m_batchIndex = pendingIndex;
+	batch->contacts[index] = other;
+	other->m_batchIndex = index;
+
+	++batch->pendingCount;
+}
+
+// Run the narrow-phase kernels one shape type pair at a time.
+void b2ContactManager::EvaluateBatches()
+{
+	for (int32 i = 0; i < b2Shape::e_typeCount; ++i)
+	{
+		for (int32 j = 0; j < b2Shape::e_typeCount; ++j)
+		{
+			b2ContactBatch* batch = &m_batches[i][j];
+			int32 count = batch->pendingCount;
+			if (count == 0)
+			{
+				continue;
+			}
+
+			if (count > m_oldManifoldCapacity)
+			{
+				if (m_oldManifolds)
+				{
+					m_heapAllocator->Free(m_oldManifolds, m_oldManifoldCapacity * sizeof(b2Manifold), b2_contactMemory);
+				}
+
+				m_oldManifoldCapacity = b2Max(2 * m_oldManifoldCapacity, count);
+				m_oldManifolds = (b2Manifold*)m_heapAllocator->Allocate(m_oldManifoldCapacity * sizeof(b2Manifold), b2_contactMemory);
+			}
+
+			for (int32 k = 0; k < count; ++k)
+			{
+				m_oldManifolds[k] = batch->contacts[k]->m_manifold;
+			}
+
+			b2ContactEvaluateFcn* evaluateFcn = b2Contact::s_registers[i][j].evaluateFcn;
+			evaluateFcn(batch->contacts, count);
+
+			for (int32 k = 0; k < count; ++k)
+			{
+				batch->contacts[k]->FinishUpdate(m_oldManifolds[k], m_contactListener);
+			}
+
+			batch->pendingCount = 0;
+		}
+	}
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -94,6 +270,8 @@ void b2ContactManager::Destroy(b2Contact* c)
 		bodyB->m_contactList = c->m_nodeB.next;
 	}
 
+	RemoveFromBatch(c);
+
 	// Call the factory.
 	b2Contact::Destroy(c, m_allocator);
 	--m_contactCount;
@@ -101,7 +279,8 @@ void b2ContactManager::Destroy(b2Contact* c)
 
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
-// contact list.
+// contact list. Filtering and broad-phase overlap are checked in
+// list order, then manifolds are computed per shape type pair.
 void b2ContactManager::Collide()
 {
 	// Update awake contacts.
@@ -150,9 +329,21 @@ void b2ContactManager::Collide()
 			continue;
 		}
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		bool overlap;
+		if (bodyA->m_compoundTree || bodyB->m_compoundTree)
+		{
+			// Fixtures of compound bodies are not in the broad-phase.
+			b2AABB aabbA, aabbB;
+			GetFatAABB(&aabbA, fixtureA->m_proxies + indexA);
+			GetFatAABB(&aabbB, fixtureB->m_proxies + indexB);
+			overlap = b2TestOverlap(aabbA, aabbB);
+		}
+		else
+		{
+			int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+			int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+			overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		}
 
 		// Here we destroy contacts that cease to overlap in the broad-phase.
 		if (overlap == false)
@@ -163,15 +354,293 @@ void b2ContactManager::Collide()
 			continue;
 		}
 
-		// The contact persists.
-		c->Update(m_contactListener);
+		// The contact persists. Sensors don't need a manifold, so they are
+		// updated right away.
+		if (fixtureA->IsSensor() || fixtureB->IsSensor())
+		{
+			c->Update(m_contactListener);
+		}
+		else
+		{
+			c->m_speculativeMargin = 0.0f;
+			if (m_speculativeTime > 0.0f)
+			{
+				c->m_speculativeMargin = ComputeSpeculativeMargin(c);
+			}
+
+			MarkPending(c);
+		}
+
 		c = c->GetNext();
 	}
+
+	EvaluateBatches();
 }
 
 void b2ContactManager::FindNewContacts()
 {
 	m_broadPhase.UpdatePairs(this);
+
+	// Fixture pairs under compound pairs are found here, so they are in place
+	// before the continuous collision pass.
+	UpdateCompoundPairs();
+}
+
+// Distance from a point to the farthest corner of a box.
+static float32 b2MaxDistance(const b2AABB& aabb, const b2Vec2& point)
+{
+	b2Vec2 d = b2Max(b2Abs(aabb.lowerBound - point), b2Abs(aabb.upperBound - point));
+	return d.Length();
+}
+
+// Bound how far the shapes of a contact can close during the look ahead time.
+// This is the relative linear motion plus the rotation of each fixture about
+// its center of mass. The fat AABBs bound the reach of the fixtures.
+float32 b2ContactManager::ComputeSpeculativeMargin(const b2Contact* c) const
+{
+	const b2FixtureProxy* proxyA = c->m_fixtureA->m_proxies + c->m_indexA;
+	const b2FixtureProxy* proxyB = c->m_fixtureB->m_proxies + c->m_indexB;
+	const b2Body* bodyA = proxyA->body;
+	const b2Body* bodyB = proxyB->body;
+
+	float32 speed = b2Distance(bodyA->m_velocity->v, bodyB->m_velocity->v);
+
+	if (bodyA->m_velocity->w != 0.0f)
+	{
+		b2AABB aabb;
+		GetFatAABB(&aabb, proxyA);
+		speed += b2Abs(bodyA->m_velocity->w) * b2MaxDistance(aabb, bodyA->m_sweep->c);
+	}
+
+	if (bodyB->m_velocity->w != 0.0f)
+	{
+		b2AABB aabb;
+		GetFatAABB(&aabb, proxyB);
+		speed += b2Abs(bodyB->m_velocity->w) * b2MaxDistance(aabb, bodyB->m_sweep->c);
+	}
+
+	return b2_speculativeDistance + m_speculativeTime * speed;
+}
+
+// Get the fat AABB of a fixture proxy in world space.
+void b2ContactManager::GetFatAABB(b2AABB* aabb, const b2FixtureProxy* proxy) const
+{
+	const b2Body* body = proxy->body;
+	if (body->m_compoundTree && proxy->fixture)
+	{
+		// Rotating the body-space box would inflate it, so bound the shape
+		// directly and add the same margin as the broad-phase.
+		proxy->fixture->m_shape->ComputeAABB(aabb, body->m_xf, proxy->childIndex);
+		b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+		aabb->lowerBound = aabb->lowerBound - r;
+		aabb->upperBound = aabb->upperBound + r;
+	}
+	else
+	{
+		*aabb = m_broadPhase.GetFatAABB(proxy->proxyId);
+	}
+}
+
+inline bool b2CompoundPairLessThan(const b2CompoundPair& pair1, const b2CompoundPair& pair2)
+{
+	if (pair1.proxyA->proxyId < pair2.proxyA->proxyId)
+	{
+		return true;
+	}
+
+	if (pair1.proxyA->proxyId == pair2.proxyA->proxyId)
+	{
+		return pair1.proxyB->proxyId < pair2.proxyB->proxyId;
+	}
+
+	return false;
+}
+
+void b2ContactManager::AddCompoundPair(b2FixtureProxy* proxyA, b2FixtureProxy* proxyB)
+{
+	// The broad-phase reports a pair again each time one of the proxies moves.
+	// Duplicates are merged in UpdateCompoundPairs.
+	if (proxyB->proxyId < proxyA->proxyId)
+	{
+		b2Swap(proxyA, proxyB);
+	}
+
+	// Grow the pair array as needed.
+	if (m_compoundPairCount == m_compoundPairCapacity)
+	{
+		b2CompoundPair* oldPairs = m_compoundPairs;
+		m_compoundPairCapacity = b2Max(2 * m_compoundPairCapacity, 16);
+		m_compoundPairs = (b2CompoundPair*)m_heapAllocator->Allocate(m_compoundPairCapacity * sizeof(b2CompoundPair), b2_contactMemory);
+		if (oldPairs)
+		{
+			memcpy(m_compoundPairs, oldPairs, m_compoundPairCount * sizeof(b2CompoundPair));
+			m_heapAllocator->Free(oldPairs, m_compoundPairCount * sizeof(b2CompoundPair), b2_contactMemory);
+		}
+	}
+
+	b2CompoundPair* pair = m_compoundPairs + m_compoundPairCount;
+	pair->proxyA = proxyA;
+	pair->proxyB = proxyB;
+	pair->touched = true;
+	++m_compoundPairCount;
+
+	m_mergeCompoundPairs = true;
+}
+
+void b2ContactManager::RemoveCompoundPairs(const b2FixtureProxy* proxy)
+{
+	int32 i = 0;
+	while (i < m_compoundPairCount)
+	{
+		const b2CompoundPair* pair = m_compoundPairs + i;
+		if (pair->proxyA == proxy || pair->proxyB == proxy)
+		{
+			--m_compoundPairCount;
+			m_compoundPairs[i] = m_compoundPairs[m_compoundPairCount];
+			continue;
+		}
+
+		++i;
+	}
+}
+
+void b2ContactManager::UpdateCompoundPairs()
+{
+	if (m_mergeCompoundPairs)
+	{
+		std::sort(m_compoundPairs, m_compoundPairs + m_compoundPairCount, b2CompoundPairLessThan);
+
+		int32 count = 0;
+		for (int32 i = 0; i < m_compoundPairCount; ++i)
+		{
+			b2CompoundPair* pair = m_compoundPairs + i;
+			if (count > 0)
+			{
+				b2CompoundPair* last = m_compoundPairs + count - 1;
+				if (last->proxyA == pair->proxyA && last->proxyB == pair->proxyB)
+				{
+					last->touched = last->touched || pair->touched;
+					continue;
+				}
+			}
+
+			m_compoundPairs[count] = *pair;
+			++count;
+		}
+
+		m_compoundPairCount = count;
+		m_mergeCompoundPairs = false;
+	}
+
+	int32 i = 0;
+	while (i < m_compoundPairCount)
+	{
+		b2CompoundPair* pair = m_compoundPairs + i;
+		b2FixtureProxy* proxyA = pair->proxyA;
+		b2FixtureProxy* proxyB = pair->proxyB;
+
+		// Drop pairs that stopped overlapping. The broad-phase reports them
+		// again if they come back.
+		if (m_broadPhase.TestOverlap(proxyA->proxyId, proxyB->proxyId) == false)
+		{
+			--m_compoundPairCount;
+			m_compoundPairs[i] = m_compoundPairs[m_compoundPairCount];
+			continue;
+		}
+
+		++i;
+
+		b2Body* bodyA = proxyA->body;
+		b2Body* bodyB = proxyB->body;
+
+		// Only walk pairs that are new or have a body that moved since the
+		// last walk. This keeps the continuous collision pass cheap.
+		bool moved = ((bodyA->m_flags | bodyB->m_flags) & b2Body::e_proxyMoveFlag) != 0;
+		if (pair->touched == false && moved == false)
+		{
+			continue;
+		}
+
+		// A touched pair may be new or refiltered, so it is walked even when
+		// both bodies rest, just like the broad-phase pairs of plain bodies.
+		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
+		bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+		if (pair->touched == false && activeA == false && activeB == false)
+		{
+			continue;
+		}
+
+		if (bodyB->ShouldCollide(bodyA) == false)
+		{
+			continue;
+		}
+
+		if (proxyA->fixture == NULL && proxyB->fixture == NULL)
+		{
+			// Walk both fixture trees with B placed in the frame of A.
+			m_queryTreeA = bodyA->m_compoundTree;
+			m_queryTreeB = bodyB->m_compoundTree;
+			b2Transform xf = b2MulT(bodyA->m_xf, bodyB->m_xf);
+			m_queryTreeA->QueryPairs(this, m_queryTreeB, xf);
+			continue;
+		}
+
+		if (proxyA->fixture != NULL)
+		{
+			b2Swap(proxyA, proxyB);
+			b2Swap(bodyA, bodyB);
+		}
+
+		// Query the fixture tree of A with the fat AABB of fixture B.
+		b2AABB aabb;
+		b2InvTransformAABB(&aabb, bodyA->m_xf, m_broadPhase.GetFatAABB(proxyB->proxyId));
+		m_queryTreeA = bodyA->m_compoundTree;
+		m_queryProxy = proxyB;
+		m_queryTreeA->Query(this, aabb);
+	}
+
+	for (int32 i = 0; i < m_compoundPairCount; ++i)
+	{
+		b2CompoundPair* pair = m_compoundPairs + i;
+		pair->touched = false;
+		pair->proxyA->body->m_flags &= ~b2Body::e_proxyMoveFlag;
+		pair->proxyB->body->m_flags &= ~b2Body::e_proxyMoveFlag;
+	}
+}
+
+// Called from UpdateCompoundPairs for compound against fixture pairs.
+bool b2ContactManager::QueryCallback(int32 proxyId)
+{
+	b2FixtureProxy* proxy = (b2FixtureProxy*)m_queryTreeA->GetUserData(proxyId);
+
+	// The tree query is loose once rotated, so test the fat AABBs the
+	// same way Collide does.
+	b2AABB aabbA, aabbB;
+	GetFatAABB(&aabbA, proxy);
+	GetFatAABB(&aabbB, m_queryProxy);
+	if (b2TestOverlap(aabbA, aabbB))
+	{
+		AddFixturePair(proxy, m_queryProxy);
+	}
+
+	return true;
+}
+
+// Called from UpdateCompoundPairs for compound against compound pairs.
+bool b2ContactManager::QueryCallback(int32 proxyIdA, int32 proxyIdB)
+{
+	b2FixtureProxy* proxyA = (b2FixtureProxy*)m_queryTreeA->GetUserData(proxyIdA);
+	b2FixtureProxy* proxyB = (b2FixtureProxy*)m_queryTreeB->GetUserData(proxyIdB);
+
+	b2AABB aabbA, aabbB;
+	GetFatAABB(&aabbA, proxyA);
+	GetFatAABB(&aabbB, proxyB);
+	if (b2TestOverlap(aabbA, aabbB))
+	{
+		AddFixturePair(proxyA, proxyB);
+	}
+
+	return true;
 }
 
 void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
@@ -179,6 +648,18 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	b2FixtureProxy* proxyA = (b2FixtureProxy*)proxyUserDataA;
 	b2FixtureProxy* proxyB = (b2FixtureProxy*)proxyUserDataB;
 
+	// A compound body stands in for all of its fixtures.
+	if (proxyA->fixture == NULL || proxyB->fixture == NULL)
+	{
+		AddCompoundPair(proxyA, proxyB);
+		return;
+	}
+
+	AddFixturePair(proxyA, proxyB);
+}
+
+void b2ContactManager::AddFixturePair(b2FixtureProxy* proxyA, b2FixtureProxy* proxyB)
+{
 	b2Fixture* fixtureA = proxyA->fixture;
 	b2Fixture* fixtureB = proxyB->fixture;
 
@@ -242,6 +723,9 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		return;
 	}
 
+	c->m_creationStamp = m_creationStamp;
+	++m_creationStamp;
+
 	// Contact creation may swap fixtures.
 	fixtureA = c->GetFixtureA();
 	fixtureB = c->GetFixtureB();
@@ -259,6 +743,8 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	}
 	m_contactList = c;
 
+	AddToBatch(c);
+
 	// Connect to island graph.
 
 	// Connect to body A
@@ -20,33 +20,111 @@
 #define B2_CONTACT_MANAGER_H
 
 #include <Collision/b2BroadPhase.h>
+#include <Collision/Shapes/b2Shape.h>
 
 class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+struct b2FixtureProxy;
+
+/// A dense array of contacts that share the same shape type pair. The narrow-phase
+/// runs over these arrays one type at a time so each batch kernel sees a
+/// homogeneous stream of contacts.
+struct b2ContactBatch
+{
+	b2Contact** contacts;
+	int32 count;
+	int32 capacity;
+
+	// Contacts [0, pendingCount) need their manifold updated this step.
+	int32 pendingCount;
+};
+
+/// A broad-phase pair that involves at least one compound body. The fixture
+/// pairs under it are found by walking the body fixture trees whenever one of
+/// the bodies has moved.
+struct b2CompoundPair
+{
+	b2FixtureProxy* proxyA;
+	b2FixtureProxy* proxyB;
+
+	// Set when the broad-phase reports the pair, so it is walked once even if
+	// neither body moved.
+	bool touched;
+};
 
 // Delegate of b2World.
 class b2ContactManager
 {
 public:
-	b2ContactManager();
+	b2ContactManager(b2Allocator* allocator = NULL);
+	~b2ContactManager();
 
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
 
+	// Fixture tree callbacks for compound pairs.
+	bool QueryCallback(int32 proxyId);
+	bool QueryCallback(int32 proxyIdA, int32 proxyIdB);
+
 	void FindNewContacts();
 
+	// Size the broad-phase and the manifold scratch for the given counts.
+	void Reserve(int32 proxyCount, int32 contactCount);
+
+	// Forget the compound pairs of a broad-phase proxy before it is destroyed.
+	void RemoveCompoundPairs(const b2FixtureProxy* proxy);
+
 	void Destroy(b2Contact* c);
 
 	void Collide();
 
 	b2BroadPhase m_broadPhase;
+	b2ContactBatch m_batches[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	b2Contact* m_contactList;
 	int32 m_contactCount;
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+
+	// Stamp for the next contact created.
+	uint32 m_creationStamp;
+
+	// Time that speculative contacts look ahead, zero when they are disabled.
+	float32 m_speculativeTime;
+
+private:
+
+	// Heap memory of the broad-phase, batches and pair arrays.
+	b2Allocator* m_heapAllocator;
+
+	void AddToBatch(b2Contact* c);
+	void RemoveFromBatch(b2Contact* c);
+	void MarkPending(b2Contact* c);
+	void EvaluateBatches();
+
+	void AddFixturePair(b2FixtureProxy* proxyA, b2FixtureProxy* proxyB);
+	void AddCompoundPair(b2FixtureProxy* proxyA, b2FixtureProxy* proxyB);
+	void UpdateCompoundPairs();
+	void GetFatAABB(b2AABB* aabb, const b2FixtureProxy* proxy) const;
+	float32 ComputeSpeculativeMargin(const b2Contact* c) const;
+
+	// Old manifolds kept while a batch is evaluated, used for warm starting.
+	b2Manifold* m_oldManifolds;
+	int32 m_oldManifoldCapacity;
+
+	b2CompoundPair* m_compoundPairs;
+	int32 m_compoundPairCount;
+	int32 m_compoundPairCapacity;
+
+	// Pairs were added since the last walk and may hold duplicates.
+	bool m_mergeCompoundPairs;
+
+	// Context of the fixture tree callbacks.
+	b2FixtureProxy* m_queryProxy;
+	const b2DynamicTree* m_queryTreeA;
+	const b2DynamicTree* m_queryTreeB;
 };
 
 #endif
@@ -23,24 +23,100 @@
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
 #include <Box2D/Collision/b2BroadPhase.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 
+// Free a shape cloned with the block allocator.
+static void b2FreeShape(b2BlockAllocator* allocator, b2Shape* shape)
+{
+	switch (shape->m_type)
+	{
+	case b2Shape::e_circle:
+		{
+			b2CircleShape* s = (b2CircleShape*)shape;
+			s->~b2CircleShape();
+			allocator->Free(s, sizeof(b2CircleShape));
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
+			b2EdgeShape* s = (b2EdgeShape*)shape;
+			s->~b2EdgeShape();
+			allocator->Free(s, sizeof(b2EdgeShape));
+		}
+		break;
+
+	case b2Shape::e_polygon:
+		{
+			b2PolygonShape* s = (b2PolygonShape*)shape;
+			s->~b2PolygonShape();
+			allocator->Free(s, sizeof(b2PolygonShape));
+		}
+		break;
+
+	case b2Shape::e_chain:
+		{
+			b2ChainShape* s = (b2ChainShape*)shape;
+			s->~b2ChainShape();
+			allocator->Free(s, sizeof(b2ChainShape));
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)shape;
+			s->~b2CapsuleShape();
+			allocator->Free(s, sizeof(b2CapsuleShape));
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
+
+b2SharedShape::b2SharedShape()
+{
+	m_shape = NULL;
+	m_refCount = 0;
+	m_destroyed = false;
+	m_prev = NULL;
+	m_next = NULL;
+}
+
+void b2SharedShape::Create(b2BlockAllocator* allocator, const b2Shape* shape)
+{
+	m_shape = shape->Clone(allocator);
+}
+
+void b2SharedShape::Destroy(b2BlockAllocator* allocator)
+{
+	b2Assert(m_refCount == 0);
+	b2FreeShape(allocator, m_shape);
+	m_shape = NULL;
+}
+
 b2Fixture::b2Fixture()
 {
 	m_userData = NULL;
+	m_ownsUserData = false;
 	m_body = NULL;
 	m_next = NULL;
 	m_proxies = NULL;
 	m_proxyCount = 0;
 	m_shape = NULL;
+	m_sharedShape = NULL;
 	m_density = 0.0f;
 }
 
 void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def)
 {
 	m_userData = def->userData;
+	m_ownsUserData = false;
 	m_friction = def->friction;
 	m_restitution = def->restitution;
 
@@ -50,8 +126,20 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2Fixtur
 	m_filter = def->filter;
 
 	m_isSensor = def->isSensor;
+	m_continuous = def->continuous;
 
-	m_shape = def->shape->Clone(allocator);
+	if (def->sharedShape)
+	{
+		b2Assert(def->sharedShape->m_destroyed == false);
+		m_sharedShape = def->sharedShape;
+		m_shape = m_sharedShape->m_shape;
+		++m_sharedShape->m_refCount;
+	}
+	else
+	{
+		m_sharedShape = NULL;
+		m_shape = def->shape->Clone(allocator);
+	}
 
 	// Reserve proxy space
 	int32 childCount = m_shape->GetChildCount();
@@ -76,44 +164,21 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 	allocator->Free(m_proxies, childCount * sizeof(b2FixtureProxy));
 	m_proxies = NULL;
 
-	// Free the child shape.
-	switch (m_shape->m_type)
+	// Free the child shape, or release the shared shape.
+	if (m_sharedShape)
 	{
-	case b2Shape::e_circle:
+		b2Assert(m_sharedShape->m_refCount > 0);
+		--m_sharedShape->m_refCount;
+		if (m_sharedShape->m_refCount == 0 && m_sharedShape->m_destroyed)
 		{
-			b2CircleShape* s = (b2CircleShape*)m_shape;
-			s->~b2CircleShape();
-			allocator->Free(s, sizeof(b2CircleShape));
+			m_sharedShape->Destroy(allocator);
+			allocator->Free(m_sharedShape, sizeof(b2SharedShape));
 		}
-		break;
-
-	case b2Shape::e_edge:
-		{
-			b2EdgeShape* s = (b2EdgeShape*)m_shape;
-			s->~b2EdgeShape();
-			allocator->Free(s, sizeof(b2EdgeShape));
-		}
-		break;
-
-	case b2Shape::e_polygon:
-		{
-			b2PolygonShape* s = (b2PolygonShape*)m_shape;
-			s->~b2PolygonShape();
-			allocator->Free(s, sizeof(b2PolygonShape));
-		}
-		break;
-
-	case b2Shape::e_chain:
-		{
-			b2ChainShape* s = (b2ChainShape*)m_shape;
-			s->~b2ChainShape();
-			allocator->Free(s, sizeof(b2ChainShape));
-		}
-		break;
-
-	default:
-		b2Assert(false);
-		break;
+		m_sharedShape = NULL;
+	}
+	else
+	{
+		b2FreeShape(allocator, m_shape);
 	}
 
 	m_shape = NULL;
@@ -123,25 +188,63 @@ void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
 {
 	b2Assert(m_proxyCount == 0);
 
-	// Create proxies in the broad-phase.
 	m_proxyCount = m_shape->GetChildCount();
 
+	// Compound bodies keep their fixtures in body space. The body owns the
+	// broad-phase proxy.
+	b2DynamicTree* tree = m_body->m_compoundTree;
+	if (tree)
+	{
+		b2Transform identity;
+		identity.SetIdentity();
+
+		for (int32 i = 0; i < m_proxyCount; ++i)
+		{
+			b2FixtureProxy* proxy = m_proxies + i;
+			m_shape->ComputeAABB(&proxy->aabb, identity, i);
+			proxy->proxyId = tree->CreateProxy(proxy->aabb, proxy);
+			proxy->fixture = this;
+			proxy->body = m_body;
+			proxy->childIndex = i;
+		}
+
+		return;
+	}
+
+	// Create proxies in the broad-phase.
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
 		m_shape->ComputeAABB(&proxy->aabb, xf, i);
 		proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy);
 		proxy->fixture = this;
+		proxy->body = m_body;
 		proxy->childIndex = i;
 	}
 }
 
 void b2Fixture::DestroyProxies(b2BroadPhase* broadPhase)
 {
+	b2DynamicTree* tree = m_body->m_compoundTree;
+	if (tree)
+	{
+		for (int32 i = 0; i < m_proxyCount; ++i)
+		{
+			b2FixtureProxy* proxy = m_proxies + i;
+			tree->DestroyProxy(proxy->proxyId);
+			proxy->proxyId = b2BroadPhase::e_nullProxy;
+		}
+
+		m_proxyCount = 0;
+		return;
+	}
+
 	// Destroy proxies in the broad-phase.
+	b2ContactManager* contactManager = &m_body->m_world->m_contactManager;
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
+		contactManager->RemoveCompoundPairs(proxy);
 		broadPhase->DestroyProxy(proxy->proxyId);
 		proxy->proxyId = b2BroadPhase::e_nullProxy;
 	}
@@ -211,12 +314,30 @@ void b2Fixture::Refilter()
 
 	// Touch each proxy so that new pairs may be created
 	b2BroadPhase* broadPhase = &world->m_contactManager.m_broadPhase;
+
+	// The fixture proxies of a compound body live in its own tree. Touching
+	// the compound proxy marks every pair of the body for another walk.
+	if (m_body->m_compoundTree)
+	{
+		if (m_body->m_compoundProxy->proxyId != b2BroadPhase::e_nullProxy)
+		{
+			broadPhase->TouchProxy(m_body->m_compoundProxy->proxyId);
+		}
+		return;
+	}
+
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		broadPhase->TouchProxy(m_proxies[i].proxyId);
 	}
 }
 
+void b2Fixture::SetUserData(void* data)
+{
+	m_body->m_world->DestroyUserData(this);
+	m_userData = data;
+}
+
 void b2Fixture::SetSensor(bool sensor)
 {
 	if (sensor != m_isSensor)
@@ -233,6 +354,7 @@ void b2Fixture::Dump(int32 bodyIndex)
 	b2Log("    fd.restitution = %.15lef;\n", m_restitution);
 	b2Log("    fd.density = %.15lef;\n", m_density);
 	b2Log("    fd.isSensor = bool(%d);\n", m_isSensor);
+	b2Log("    fd.continuous = b2ContinuousMode(%d);\n", m_continuous);
 	b2Log("    fd.filter.categoryBits = uint16(%d);\n", m_filter.categoryBits);
 	b2Log("    fd.filter.maskBits = uint16(%d);\n", m_filter.maskBits);
 	b2Log("    fd.filter.groupIndex = int16(%d);\n", m_filter.groupIndex);
@@ -292,6 +414,15 @@ void b2Fixture::Dump(int32 bodyIndex)
 		}
 		break;
 
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			b2Log("    b2CapsuleShape shape;\n");
+			b2Log("    shape.Set(b2Vec2(%.15lef, %.15lef), b2Vec2(%.15lef, %.15lef), %.15lef);\n",
+				s->m_vertex1.x, s->m_vertex1.y, s->m_vertex2.x, s->m_vertex2.y, s->m_radius);
+		}
+		break;
+
 	default:
 		return;
 	}
@@ -51,6 +51,51 @@ struct b2Filter
 	int16 groupIndex;
 };
 
+/// Which contacts of a fixture use continuous collision (time of impact).
+enum b2ContinuousMode
+{
+	b2_continuousNever = 0,	///< never, the fixture may tunnel
+	b2_continuousStatic,	///< against static and kinematic bodies
+	b2_continuousAlways		///< against all bodies, like a bullet
+};
+
+/// A shared shape is one immutable shape referenced by many fixtures, instead of
+/// each fixture holding its own copy. Use it for large numbers of identical
+/// fixtures, such as particles. The shape is in body coordinates, so every
+/// fixture still takes its transform from its own body.
+/// Shared shapes are created via b2World::CreateSharedShape. A shared shape is
+/// freed once it has been destroyed and the last fixture using it is gone.
+class b2SharedShape
+{
+public:
+	/// Get the shape. It cannot be modified.
+	const b2Shape* GetShape() const;
+
+	/// Get the number of fixtures that reference this shape.
+	int32 GetFixtureCount() const;
+
+protected:
+
+	friend class b2World;
+	friend class b2Fixture;
+
+	b2SharedShape();
+
+	void Create(b2BlockAllocator* allocator, const b2Shape* shape);
+	void Destroy(b2BlockAllocator* allocator);
+
+	b2Shape* m_shape;
+
+	// The number of fixtures referencing the shape. The shape is freed when this
+	// drops to zero after b2World::DestroySharedShape.
+	int32 m_refCount;
+	bool m_destroyed;
+
+	// World list of shared shapes that have not been destroyed.
+	b2SharedShape* m_prev;
+	b2SharedShape* m_next;
+};
+
 /// A fixture definition is used to create a fixture. This class defines an
 /// abstract fixture definition. You can reuse fixture definitions safely.
 struct b2FixtureDef
@@ -59,17 +104,23 @@ struct b2FixtureDef
 	b2FixtureDef()
 	{
 		shape = NULL;
+		sharedShape = NULL;
 		userData = NULL;
 		friction = 0.2f;
 		restitution = 0.0f;
 		density = 0.0f;
 		isSensor = false;
+		continuous = b2_continuousStatic;
 	}
 
 	/// The shape, this must be set. The shape will be cloned, so you
 	/// can create the shape on the stack.
 	const b2Shape* shape;
 
+	/// Optionally reference a shared shape instead of cloning shape. When this is
+	/// set, shape is ignored. The shared shape must belong to the same world.
+	b2SharedShape* sharedShape;
+
 	/// Use this to store application specific fixture data.
 	void* userData;
 
@@ -86,15 +137,22 @@ struct b2FixtureDef
 	/// response.
 	bool isSensor;
 
+	/// Continuous collision policy. A bullet body uses b2_continuousAlways
+	/// for fixtures that are not b2_continuousNever.
+	b2ContinuousMode continuous;
+
 	/// Contact filtering data.
 	b2Filter filter;
 };
 
 /// This proxy is used internally to connect fixtures to the broad-phase.
+/// A compound body has a single broad-phase proxy with no fixture, and the
+/// fixture proxies live in the body's fixture tree instead.
 struct b2FixtureProxy
 {
 	b2AABB aabb;
 	b2Fixture* fixture;
+	b2Body* body;
 	int32 childIndex;
 	int32 proxyId;
 };
@@ -114,9 +172,15 @@ public:
 	/// Get the child shape. You can modify the child shape, however you should not change the
 	/// number of vertices because this will crash some collision caching mechanisms.
 	/// Manipulating the shape may lead to non-physical behavior.
+	/// @warning a shared shape must not be modified, it belongs to other fixtures too. This
+	/// asserts if the fixture references a shared shape; use the const version to read it.
 	b2Shape* GetShape();
 	const b2Shape* GetShape() const;
 
+	/// Get the shared shape of this fixture, or NULL if it owns its shape.
+	b2SharedShape* GetSharedShape();
+	const b2SharedShape* GetSharedShape() const;
+
 	/// Set if this fixture is a sensor.
 	void SetSensor(bool sensor);
 
@@ -124,6 +188,12 @@ public:
 	/// @return the true if the shape is a sensor.
 	bool IsSensor() const;
 
+	/// Set the continuous collision policy of this fixture.
+	void SetContinuousMode(b2ContinuousMode mode);
+
+	/// Get the continuous collision policy of this fixture.
+	b2ContinuousMode GetContinuousMode() const;
+
 	/// Set the contact filtering data. This will not update contacts until the next time
 	/// step when either parent body is active and awake.
 	/// This automatically calls Refilter.
@@ -145,11 +215,15 @@ public:
 	b2Fixture* GetNext();
 	const b2Fixture* GetNext() const;
 
+	/// Get the handle of this fixture, see b2World::GetFixture.
+	b2FixtureId GetId() const;
+
 	/// Get the user data that was assigned in the fixture definition. Use this to
 	/// store your application specific data.
 	void* GetUserData() const;
 
 	/// Set the user data. Use this to store your application specific data.
+	/// User data owned by the world is destroyed first, see b2World::DestroyUserData.
 	void SetUserData(void* data);
 
 	/// Test a point for containment in this fixture.
@@ -189,7 +263,7 @@ public:
 
 	/// Get the fixture's AABB. This AABB may be enlarge and/or stale.
 	/// If you need a more accurate AABB, compute it using the shape and
-	/// the body transform.
+	/// the body transform. On a compound body the AABB is in body coordinates.
 	const b2AABB& GetAABB(int32 childIndex) const;
 
 	/// Dump this fixture to the log file.
@@ -201,6 +275,7 @@ protected:
 	friend class b2World;
 	friend class b2Contact;
 	friend class b2ContactManager;
+	friend class b2Scene;
 
 	b2Fixture();
 
@@ -219,8 +294,10 @@ protected:
 
 	b2Fixture* m_next;
 	b2Body* m_body;
+	b2FixtureId m_id;
 
 	b2Shape* m_shape;
+	b2SharedShape* m_sharedShape;
 
 	float32 m_friction;
 	float32 m_restitution;
@@ -232,9 +309,22 @@ protected:
 
 	bool m_isSensor;
 
+	b2ContinuousMode m_continuous;
+
 	void* m_userData;
+	bool m_ownsUserData;
 };
 
+inline const b2Shape* b2SharedShape::GetShape() const
+{
+	return m_shape;
+}
+
+inline int32 b2SharedShape::GetFixtureCount() const
+{
+	return m_refCount;
+}
+
 inline b2Shape::Type b2Fixture::GetType() const
 {
 	return m_shape->GetType();
@@ -242,6 +332,7 @@ inline b2Shape::Type b2Fixture::GetType() const
 
 inline b2Shape* b2Fixture::GetShape()
 {
+	b2Assert(m_sharedShape == NULL);
 	return m_shape;
 }
 
@@ -250,24 +341,44 @@ inline const b2Shape* b2Fixture::GetShape() const
 	return m_shape;
 }
 
+inline b2SharedShape* b2Fixture::GetSharedShape()
+{
+	return m_sharedShape;
+}
+
+inline const b2SharedShape* b2Fixture::GetSharedShape() const
+{
+	return m_sharedShape;
+}
+
 inline bool b2Fixture::IsSensor() const
 {
 	return m_isSensor;
 }
 
+inline void b2Fixture::SetContinuousMode(b2ContinuousMode mode)
+{
+	m_continuous = mode;
+}
+
+inline b2ContinuousMode b2Fixture::GetContinuousMode() const
+{
+	return m_continuous;
+}
+
 inline const b2Filter& b2Fixture::GetFilterData() const
 {
 	return m_filter;
 }
 
-inline void* b2Fixture::GetUserData() const
+inline b2FixtureId b2Fixture::GetId() const
 {
-	return m_userData;
+	return m_id;
 }
 
-inline void b2Fixture::SetUserData(void* data)
+inline void* b2Fixture::GetUserData() const
 {
-	m_userData = data;
+	return m_userData;
 }
 
 inline b2Body* b2Fixture::GetBody()
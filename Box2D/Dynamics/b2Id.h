@@ -0,0 +1,85 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_ID_H
+#define B2_ID_H
+
+#include <Common/b2HandleTable.h>
+
+/// Handles to bodies, fixtures and joints, for use instead of pointers where an
+/// object may be destroyed while the handle is kept. A handle stays valid for
+/// the life of its object. Once the object is destroyed the handle is stale and
+/// the world lookup returns NULL, even after its index has been reused.
+/// A default constructed handle is null.
+struct b2BodyId
+{
+	b2BodyId() : index(b2_nullHandle), generation(0) {}
+
+	int32 index;
+	uint32 generation;
+};
+
+/// A fixture handle, see b2BodyId.
+struct b2FixtureId
+{
+	b2FixtureId() : index(b2_nullHandle), generation(0) {}
+
+	int32 index;
+	uint32 generation;
+};
+
+/// A joint handle, see b2BodyId.
+struct b2JointId
+{
+	b2JointId() : index(b2_nullHandle), generation(0) {}
+
+	int32 index;
+	uint32 generation;
+};
+
+inline bool operator == (const b2BodyId& a, const b2BodyId& b)
+{
+	return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator != (const b2BodyId& a, const b2BodyId& b)
+{
+	return !(a == b);
+}
+
+inline bool operator == (const b2FixtureId& a, const b2FixtureId& b)
+{
+	return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator != (const b2FixtureId& a, const b2FixtureId& b)
+{
+	return !(a == b);
+}
+
+inline bool operator == (const b2JointId& a, const b2JointId& b)
+{
+	return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator != (const b2JointId& a, const b2JointId& b)
+{
+	return !(a == b);
+}
+
+#endif
@@ -24,6 +24,8 @@
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Dynamics/Joints/b2DirectJointSolver.h>
+#include <Box2D/Dynamics/Joints/b2JointBatchSolver.h>
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Timer.h>
 
@@ -117,9 +119,10 @@ to few cache misses.
 The bodies are not accessed during iteration. Instead read only data, such as
 the mass values are stored with the constraints. The mutable data are the constraint
 impulses and the bodies velocities/positions. The impulses are held inside the
-constraint structures. The body velocities/positions are held in compact, temporary
-arrays to increase the number of cache hits. Linear and angular velocity are
-stored in a single array since multiple arrays lead to multiple misses.
+constraint structures. The body velocities/positions are held in compact arrays
+owned by the world and indexed by body slot, so the islands solve them in place
+without copying. Linear and angular velocity are stored in a single array since
+multiple arrays lead to multiple misses.
 */
 
 /*
@@ -150,7 +153,10 @@ b2Island::b2Island(
 	int32 contactCapacity,
 	int32 jointCapacity,
 	b2StackAllocator* allocator,
-	b2ContactListener* listener)
+	b2ContactListener* listener,
+	b2Sweep* positions,
+	b2Velocity* velocities,
+	int32 slotCount)
 {
 	m_bodyCapacity = bodyCapacity;
 	m_contactCapacity = contactCapacity;
@@ -166,15 +172,14 @@ b2Island::b2Island(
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
 	m_joints = (b2Joint**)m_allocator->Allocate(jointCapacity * sizeof(b2Joint*));
 
-	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
-	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+	m_positions = positions;
+	m_velocities = velocities;
+	m_slotCount = slotCount;
 }
 
 b2Island::~b2Island()
 {
 	// Warning: the order should reverse the constructor order.
-	m_allocator->Free(m_positions);
-	m_allocator->Free(m_velocities);
 	m_allocator->Free(m_joints);
 	m_allocator->Free(m_contacts);
 	m_allocator->Free(m_bodies);
@@ -182,26 +187,36 @@ b2Island::~b2Island()
 
 void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
+	for (int32 i = 0; i < m_jointCount; ++i)
+	{
+		m_joints[i]->m_substepCount = b2Max(step.substepCount, 1);
+	}
+
+	if (step.substepCount > 0)
+	{
+		SolveSubsteps(profile, step, gravity, allowSleep);
+		return;
+	}
+
 	b2Timer timer;
 
 	float32 h = step.dt;
 
-	// Integrate velocities and apply damping. Initialize the body state.
+	// Integrate velocities and apply damping.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
-
-		b2Vec2 c = b->m_sweep.c;
-		float32 a = b->m_sweep.a;
-		b2Vec2 v = b->m_linearVelocity;
-		float32 w = b->m_angularVelocity;
+		b2Sweep* sweep = b->m_sweep;
 
 		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		sweep->c0 = sweep->c;
+		sweep->a0 = sweep->a;
 
 		if (b->m_type == b2_dynamicBody)
 		{
+			b2Vec2 v = b->m_velocity->v;
+			float32 w = b->m_velocity->w;
+
 			// Integrate velocities.
 			v += h * (b->m_gravityScale * gravity + b->m_invMass * b->m_force);
 			w += h * b->m_invI * b->m_torque;
@@ -215,12 +230,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			// v2 = v1 * 1 / (1 + c * dt)
 			v *= 1.0f / (1.0f + h * b->m_linearDamping);
 			w *= 1.0f / (1.0f + h * b->m_angularDamping);
-		}
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+			b->m_velocity->v = v;
+			b->m_velocity->w = w;
+		}
 	}
 
 	timer.Reset();
@@ -253,31 +266,132 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		m_joints[i]->InitVelocityConstraints(solverData);
 	}
 
+	// Move the joints the direct solver can take to the front. They are solved
+	// iteratively after all if they produce too many rows.
+	int32 directJointCount = 0;
+	if (step.directJointSolver)
+	{
+		int32 rowCount = 0;
+		for (int32 i = 0; i < m_jointCount; ++i)
+		{
+			int32 count = m_joints[i]->GetDirectRowCount();
+			if (count > 0)
+			{
+				rowCount += count;
+				b2Swap(m_joints[i], m_joints[directJointCount]);
+				++directJointCount;
+			}
+		}
+
+		if (rowCount > b2_maxDirectJointRows)
+		{
+			directJointCount = 0;
+		}
+	}
+
+	b2DirectJointSolverDef directSolverDef;
+	directSolverDef.joints = m_joints;
+	directSolverDef.count = directJointCount;
+	directSolverDef.velocities = m_velocities;
+	directSolverDef.allocator = m_allocator;
+
+	b2DirectJointSolver directSolver(&directSolverDef);
+	directSolver.InitializeVelocityConstraints();
+
+	// Move the joints that can be batched behind the direct ones. Batching pays
+	// off for many joints only.
+	int32 batchJointCount = 0;
+	for (int32 i = directJointCount; i < m_jointCount; ++i)
+	{
+		if (b2JointBatchSolver::IsBatchable(m_joints[i]))
+		{
+			++batchJointCount;
+		}
+	}
+
+	if (batchJointCount < b2_minJointBatchCount)
+	{
+		batchJointCount = 0;
+	}
+	else
+	{
+		batchJointCount = 0;
+		for (int32 i = directJointCount; i < m_jointCount; ++i)
+		{
+			if (b2JointBatchSolver::IsBatchable(m_joints[i]))
+			{
+				b2Swap(m_joints[i], m_joints[directJointCount + batchJointCount]);
+				++batchJointCount;
+			}
+		}
+	}
+
+	b2JointBatchSolverDef batchSolverDef;
+	batchSolverDef.joints = m_joints + directJointCount;
+	batchSolverDef.count = batchJointCount;
+	batchSolverDef.bodyCount = m_slotCount;
+	batchSolverDef.velocities = m_velocities;
+	batchSolverDef.allocator = m_allocator;
+
+	b2JointBatchSolver batchSolver(&batchSolverDef);
+	batchSolver.InitializeVelocityConstraints();
+
+	// The remaining joints are solved one at a time.
+	int32 firstJoint = directJointCount + batchSolver.m_count;
+
 	profile->solveInit = timer.GetMilliseconds();
 
-	// Solve velocity constraints
+	// Solve velocity constraints. Past the minimum iteration count the loop stops
+	// as soon as an iteration no longer changes the body velocities.
 	timer.Reset();
-	for (int32 i = 0; i < step.velocityIterations; ++i)
+	bool adaptive = step.minVelocityIterations < step.velocityIterations;
+	int32 velocityIterations = 0;
+	while (velocityIterations < step.velocityIterations)
 	{
-		for (int32 j = 0; j < m_jointCount; ++j)
+		++velocityIterations;
+
+		bool jointsOkay = directSolver.SolveVelocityConstraints();
+		bool batchesOkay = batchSolver.SolveVelocityConstraints();
+		jointsOkay = jointsOkay && batchesOkay;
+		if (adaptive)
 		{
-			m_joints[j]->SolveVelocityConstraints(solverData);
+			bool iteratedOkay = SolveJointVelocities(solverData, firstJoint);
+			jointsOkay = jointsOkay && iteratedOkay;
+		}
+		else
+		{
+			for (int32 j = firstJoint; j < m_jointCount; ++j)
+			{
+				m_joints[j]->SolveVelocityConstraints(solverData);
+			}
 		}
 
-		contactSolver.SolveVelocityConstraints();
+		bool contactsOkay = contactSolver.SolveVelocityConstraints();
+
+		if (adaptive && contactsOkay && jointsOkay && velocityIterations >= step.minVelocityIterations)
+		{
+			break;
+		}
 	}
+	profile->velocityIterations = velocityIterations;
 
 	// Store impulses for warm starting
+	directSolver.StoreImpulses();
+	batchSolver.StoreImpulses();
 	contactSolver.StoreImpulses();
 	profile->solveVelocity = timer.GetMilliseconds();
 
 	// Integrate positions
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b2Vec2 c = m_positions[i].c;
-		float32 a = m_positions[i].a;
-		b2Vec2 v = m_velocities[i].v;
-		float32 w = m_velocities[i].w;
+		b2Body* b = m_bodies[i];
+		b2Sweep* sweep = b->m_sweep;
+		b2Velocity* velocity = b->m_velocity;
+
+		b2Vec2 c = sweep->c;
+		float32 a = sweep->a;
+		b2Vec2 v = velocity->v;
+		float32 w = velocity->w;
 
 		// Check for large velocities
 		b2Vec2 translation = h * v;
@@ -298,10 +412,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		c += h * v;
 		a += h * w;
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		sweep->c = c;
+		sweep->a = a;
+		velocity->v = v;
+		velocity->w = w;
 	}
 
 	// Solve position constraints
@@ -311,8 +425,8 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	{
 		bool contactsOkay = contactSolver.SolvePositionConstraints();
 
-		bool jointsOkay = true;
-		for (int32 i = 0; i < m_jointCount; ++i)
+		bool jointsOkay = directSolver.SolvePositionConstraints(solverData);
+		for (int32 i = directJointCount; i < m_jointCount; ++i)
 		{
 			bool jointOkay = m_joints[i]->SolvePositionConstraints(solverData);
 			jointsOkay = jointsOkay && jointOkay;
@@ -326,16 +440,8 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		}
 	}
 
-	// Copy state buffers back to the bodies
-	for (int32 i = 0; i < m_bodyCount; ++i)
-	{
-		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
-		body->SynchronizeTransform();
-	}
+	// Update the body transforms
+	SynchronizeTransforms(step);
 
 	profile->solvePosition = timer.GetMilliseconds();
 
@@ -343,58 +449,288 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	if (allowSleep)
 	{
-		float32 minSleepTime = b2_maxFloat;
+		UpdateSleep(h, positionSolved);
+	}
+}
+
+// Solve the joints from firstJoint on once and report whether no body velocity
+// changed by more than the velocity tolerances.
+bool b2Island::SolveJointVelocities(const b2SolverData& data, int32 firstJoint)
+{
+	float32 maxLinearDeltaSqr = 0.0f;
+	float32 maxAngularDelta = 0.0f;
+
+	for (int32 j = firstJoint; j < m_jointCount; ++j)
+	{
+		b2Joint* joint = m_joints[j];
+		int32 indexA = joint->m_bodyA->m_slot;
+		int32 indexB = joint->m_bodyB->m_slot;
+		b2Velocity vA = m_velocities[indexA];
+		b2Velocity vB = m_velocities[indexB];
+
+		joint->SolveVelocityConstraints(data);
+
+		maxLinearDeltaSqr = b2Max(maxLinearDeltaSqr, b2DistanceSquared(m_velocities[indexA].v, vA.v));
+		maxLinearDeltaSqr = b2Max(maxLinearDeltaSqr, b2DistanceSquared(m_velocities[indexB].v, vB.v));
+		maxAngularDelta = b2Max(maxAngularDelta, b2Abs(m_velocities[indexA].w - vA.w));
+		maxAngularDelta = b2Max(maxAngularDelta, b2Abs(m_velocities[indexB].w - vB.w));
+	}
+
+	return maxLinearDeltaSqr <= b2_linearVelocityTolerance * b2_linearVelocityTolerance &&
+		maxAngularDelta <= b2_angularVelocityTolerance;
+}
+
+// Update the body transforms after the bodies moved from the start of their
+// sweeps. With rotation integration the rotations are turned by the angles the
+// bodies moved in this step, and set from the angles once in a while.
+void b2Island::SynchronizeTransforms(const b2TimeStep& step)
+{
+	if (step.integrateRotation == false)
+	{
+		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			m_bodies[i]->SynchronizeTransform();
+		}
+		return;
+	}
+
+	if (step.syncRotation)
+	{
+		float32* angles = (float32*)m_allocator->Allocate(m_bodyCount * sizeof(float32));
+		b2Rot* rotations = (b2Rot*)m_allocator->Allocate(m_bodyCount * sizeof(b2Rot));
 
-		const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
-		const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			angles[i] = m_bodies[i]->m_sweep->a;
+		}
+
+		b2SinCos(angles, rotations, m_bodyCount);
 
 		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
 			b2Body* b = m_bodies[i];
-			if (b->GetType() == b2_staticBody)
+			b->m_xf.q = rotations[i];
+			b->m_xf.p = b->m_sweep->c - b2Mul(b->m_xf.q, b->m_sweep->localCenter);
+		}
+
+		m_allocator->Free(rotations);
+		m_allocator->Free(angles);
+		return;
+	}
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		b2Sweep* sweep = b->m_sweep;
+
+		float32 angle = sweep->a - sweep->a0;
+		if (angle != 0.0f)
+		{
+			b->m_xf.q = b2IntegrateRotation(b->m_xf.q, angle);
+		}
+
+		b->m_xf.p = sweep->c - b2Mul(b->m_xf.q, sweep->localCenter);
+	}
+}
+
+// Put the island to sleep once all of its bodies have rested long enough.
+void b2Island::UpdateSleep(float32 h, bool positionSolved)
+{
+	float32 minSleepTime = b2_maxFloat;
+
+	const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
+	const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
+			b->m_velocity->w * b->m_velocity->w > angTolSqr ||
+			b2Dot(b->m_velocity->v, b->m_velocity->v) > linTolSqr)
+		{
+			b->m_sleepTime = 0.0f;
+			minSleepTime = 0.0f;
+		}
+		else
+		{
+			b->m_sleepTime += h;
+			minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
+		}
+	}
+
+	if (minSleepTime >= b2_timeToSleep && positionSolved)
+	{
+		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			b2Body* b = m_bodies[i];
+			b->SetAwake(false);
+		}
+	}
+}
+
+// Soft step solver. The step is split into substeps that each integrate the
+// bodies and run one iteration with soft contacts, followed by a relax
+// iteration without position bias. Joints are linearized again in every
+// substep and their drift is projected out once per substep. Restitution is
+// applied once at the end. The iteration counts of the step are not used.
+void b2Island::SolveSubsteps(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
+{
+	b2Timer timer;
+
+	// Store positions for continuous collision.
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Sweep* sweep = m_bodies[i]->m_sweep;
+		sweep->c0 = sweep->c;
+		sweep->a0 = sweep->a;
+	}
+
+	int32 substepCount = step.substepCount;
+	float32 h = step.dt / substepCount;
+
+	b2TimeStep subStep = step;
+	subStep.dt = h;
+	subStep.inv_dt = step.inv_dt * substepCount;
+
+	b2SolverData solverData;
+	solverData.step = subStep;
+	solverData.positions = m_positions;
+	solverData.velocities = m_velocities;
+
+	b2ContactSolverDef contactSolverDef;
+	contactSolverDef.step = step;
+	contactSolverDef.contacts = m_contacts;
+	contactSolverDef.count = m_contactCount;
+	contactSolverDef.positions = m_positions;
+	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.allocator = m_allocator;
+
+	b2ContactSolver contactSolver(&contactSolverDef);
+	contactSolver.InitializeVelocityConstraints();
+	contactSolver.InitializeSoftConstraints(h);
+
+	profile->solveInit = timer.GetMilliseconds();
+
+	timer.Reset();
+	bool contactsOkay = true;
+	bool jointsOkay = true;
+	for (int32 i = 0; i < substepCount; ++i)
+	{
+		// Later substeps always continue from the previous one.
+		if (i > 0)
+		{
+			solverData.step.dtRatio = 1.0f;
+			solverData.step.warmStarting = true;
+		}
+
+		// Integrate velocities and apply damping.
+		for (int32 j = 0; j < m_bodyCount; ++j)
+		{
+			b2Body* b = m_bodies[j];
+			if (b->m_type != b2_dynamicBody)
 			{
 				continue;
 			}
 
-			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
-				b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-				b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
+			b2Vec2 v = b->m_velocity->v;
+			float32 w = b->m_velocity->w;
+
+			v += h * (b->m_gravityScale * gravity + b->m_invMass * b->m_force);
+			w += h * b->m_invI * b->m_torque;
+
+			v *= 1.0f / (1.0f + h * b->m_linearDamping);
+			w *= 1.0f / (1.0f + h * b->m_angularDamping);
+
+			b->m_velocity->v = v;
+			b->m_velocity->w = w;
+		}
+
+		for (int32 j = 0; j < m_jointCount; ++j)
+		{
+			m_joints[j]->InitVelocityConstraints(solverData);
+		}
+
+		contactSolver.WarmStart();
+
+		for (int32 j = 0; j < m_jointCount; ++j)
+		{
+			m_joints[j]->SolveVelocityConstraints(solverData);
+		}
+
+		contactSolver.SolveSoftConstraints(true);
+
+		// Integrate positions. Velocities are limited as in a full step.
+		for (int32 j = 0; j < m_bodyCount; ++j)
+		{
+			b2Body* b = m_bodies[j];
+			b2Vec2 v = b->m_velocity->v;
+			float32 w = b->m_velocity->w;
+
+			b2Vec2 translation = step.dt * v;
+			if (b2Dot(translation, translation) > b2_maxTranslationSquared)
 			{
-				b->m_sleepTime = 0.0f;
-				minSleepTime = 0.0f;
+				float32 ratio = b2_maxTranslation / translation.Length();
+				v *= ratio;
 			}
-			else
+
+			float32 rotation = step.dt * w;
+			if (rotation * rotation > b2_maxRotationSquared)
 			{
-				b->m_sleepTime += h;
-				minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
+				float32 ratio = b2_maxRotation / b2Abs(rotation);
+				w *= ratio;
 			}
+
+			b->m_sweep->c += h * v;
+			b->m_sweep->a += h * w;
+			b->m_velocity->v = v;
+			b->m_velocity->w = w;
 		}
 
-		if (minSleepTime >= b2_timeToSleep && positionSolved)
+		// Remove joint drift.
+		jointsOkay = true;
+		for (int32 j = 0; j < m_jointCount; ++j)
 		{
-			for (int32 i = 0; i < m_bodyCount; ++i)
-			{
-				b2Body* b = m_bodies[i];
-				b->SetAwake(false);
-			}
+			bool jointOkay = m_joints[j]->SolvePositionConstraints(solverData);
+			jointsOkay = jointsOkay && jointOkay;
 		}
+
+		// Relax.
+		for (int32 j = 0; j < m_jointCount; ++j)
+		{
+			m_joints[j]->SolveVelocityConstraints(solverData);
+		}
+
+		contactsOkay = contactSolver.SolveSoftConstraints(false);
 	}
-}
 
-void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB)
-{
-	b2Assert(toiIndexA < m_bodyCount);
-	b2Assert(toiIndexB < m_bodyCount);
+	contactSolver.ApplyRestitution();
+	contactSolver.StoreImpulses();
+	profile->solveVelocity = timer.GetMilliseconds();
+	profile->velocityIterations = substepCount;
 
-	// Initialize the body state.
-	for (int32 i = 0; i < m_bodyCount; ++i)
+	// Update the body transforms
+	timer.Reset();
+	SynchronizeTransforms(step);
+
+	profile->solvePosition = timer.GetMilliseconds();
+
+	Report(contactSolver.m_velocityConstraints);
+
+	if (allowSleep)
 	{
-		b2Body* b = m_bodies[i];
-		m_positions[i].c = b->m_sweep.c;
-		m_positions[i].a = b->m_sweep.a;
-		m_velocities[i].v = b->m_linearVelocity;
-		m_velocities[i].w = b->m_angularVelocity;
+		UpdateSleep(step.dt, contactsOkay && jointsOkay);
 	}
+}
+
+void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiSlotA, int32 toiSlotB)
+{
+	b2Assert(toiSlotA < m_slotCount);
+	b2Assert(toiSlotB < m_slotCount);
 
 	b2ContactSolverDef contactSolverDef;
 	contactSolverDef.contacts = m_contacts;
@@ -408,7 +744,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	// Solve position constraints.
 	for (int32 i = 0; i < subStep.positionIterations; ++i)
 	{
-		bool contactsOkay = contactSolver.SolveTOIPositionConstraints(toiIndexA, toiIndexB);
+		bool contactsOkay = contactSolver.SolveTOIPositionConstraints(toiSlotA, toiSlotB);
 		if (contactsOkay)
 		{
 			break;
@@ -449,10 +785,10 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 #endif
 
 	// Leap of faith to new safe state.
-	m_bodies[toiIndexA]->m_sweep.c0 = m_positions[toiIndexA].c;
-	m_bodies[toiIndexA]->m_sweep.a0 = m_positions[toiIndexA].a;
-	m_bodies[toiIndexB]->m_sweep.c0 = m_positions[toiIndexB].c;
-	m_bodies[toiIndexB]->m_sweep.a0 = m_positions[toiIndexB].a;
+	m_positions[toiSlotA].c0 = m_positions[toiSlotA].c;
+	m_positions[toiSlotA].a0 = m_positions[toiSlotA].a;
+	m_positions[toiSlotB].c0 = m_positions[toiSlotB].c;
+	m_positions[toiSlotB].a0 = m_positions[toiSlotB].a;
 
 	// No warm starting is needed for TOI events because warm
 	// starting impulses were applied in the discrete solver.
@@ -472,10 +808,14 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	// Integrate positions
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b2Vec2 c = m_positions[i].c;
-		float32 a = m_positions[i].a;
-		b2Vec2 v = m_velocities[i].v;
-		float32 w = m_velocities[i].w;
+		b2Body* body = m_bodies[i];
+		b2Sweep* sweep = body->m_sweep;
+		b2Velocity* velocity = body->m_velocity;
+
+		b2Vec2 c = sweep->c;
+		float32 a = sweep->a;
+		b2Vec2 v = velocity->v;
+		float32 w = velocity->w;
 
 		// Check for large velocities
 		b2Vec2 translation = h * v;
@@ -496,17 +836,12 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 		c += h * v;
 		a += h * w;
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		sweep->c = c;
+		sweep->a = a;
+		velocity->v = v;
+		velocity->w = w;
 
 		// Sync bodies
-		b2Body* body = m_bodies[i];
-		body->m_sweep.c = c;
-		body->m_sweep.a = a;
-		body->m_linearVelocity = v;
-		body->m_angularVelocity = w;
 		body->SynchronizeTransform();
 	}
 
@@ -30,12 +30,14 @@ class b2ContactListener;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
-/// This is an internal class.
+/// This is an internal class. The island solves on the body storage of the world
+/// in place, the bodies are addressed by their slots.
 class b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
-			b2StackAllocator* allocator, b2ContactListener* listener);
+			b2StackAllocator* allocator, b2ContactListener* listener,
+			b2Sweep* positions, b2Velocity* velocities, int32 slotCount);
 	~b2Island();
 
 	void Clear()
@@ -47,12 +49,13 @@ public:
 
 	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
-	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
+	void SolveSubsteps(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
+
+	void SolveTOI(const b2TimeStep& subStep, int32 toiSlotA, int32 toiSlotB);
 
 	void Add(b2Body* body)
 	{
 		b2Assert(m_bodyCount < m_bodyCapacity);
-		body->m_islandIndex = m_bodyCount;
 		m_bodies[m_bodyCount] = body;
 		++m_bodyCount;
 	}
@@ -71,6 +74,12 @@ public:
 
 	void Report(const b2ContactVelocityConstraint* constraints);
 
+	void UpdateSleep(float32 h, bool positionSolved);
+
+	bool SolveJointVelocities(const b2SolverData& data, int32 firstJoint);
+
+	void SynchronizeTransforms(const b2TimeStep& step);
+
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
@@ -78,8 +87,9 @@ public:
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
 
-	b2Position* m_positions;
+	b2Sweep* m_positions;
 	b2Velocity* m_velocities;
+	int32 m_slotCount;
 
 	int32 m_bodyCount;
 	int32 m_jointCount;
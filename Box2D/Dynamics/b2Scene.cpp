@@ -0,0 +1,867 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2Scene.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <Box2D/Dynamics/Joints/b2DistanceJoint.h>
+#include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/Joints/b2WeldJoint.h>
+#include <stdio.h>
+#include <string.h>
+
+b2Scene::b2Scene()
+{
+	m_header = NULL;
+	m_bodies = NULL;
+	m_fixtures = NULL;
+	m_joints = NULL;
+	m_vertices = NULL;
+	m_names = NULL;
+}
+
+bool b2Scene::Open(const char* path)
+{
+	Close();
+
+	if (m_file.Open(path) == false)
+	{
+		return false;
+	}
+
+	if (Load(m_file.GetData(), m_file.GetSize()) == false)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool b2Scene::Open(const void* data, int32 size)
+{
+	Close();
+	return Load(data, size);
+}
+
+void b2Scene::Close()
+{
+	m_file.Close();
+	m_header = NULL;
+	m_bodies = NULL;
+	m_fixtures = NULL;
+	m_joints = NULL;
+	m_vertices = NULL;
+	m_names = NULL;
+}
+
+// Is a name offset valid? The name section ends with a terminator, so any
+// offset into it is a terminated string.
+static bool b2IsValidName(int32 name, int32 nameSize)
+{
+	return name == -1 || (0 <= name && name < nameSize);
+}
+
+// Is a range of count items starting at index inside [0, total)?
+static bool b2IsValidRange(int32 index, int32 count, int32 total)
+{
+	return 0 <= index && 0 <= count && index <= total - count;
+}
+
+bool b2Scene::Load(const void* data, int32 size)
+{
+	b2Assert(((size_t)data & 3) == 0);
+
+	if (data == NULL || size < int32(sizeof(b2SceneHeader)))
+	{
+		return false;
+	}
+
+	const b2SceneHeader* header = (const b2SceneHeader*)data;
+	if (header->magic != b2_sceneMagic || header->version != b2_sceneVersion || header->size != size)
+	{
+		return false;
+	}
+
+	// The sections must fill the file exactly. Check each one against what is
+	// left so that large counts cannot overflow.
+	int32 remaining = size - int32(sizeof(b2SceneHeader));
+	if (header->bodyCount < 0 || header->bodyCount > remaining / int32(sizeof(b2SceneBody)))
+	{
+		return false;
+	}
+	remaining -= header->bodyCount * int32(sizeof(b2SceneBody));
+
+	if (header->fixtureCount < 0 || header->fixtureCount > remaining / int32(sizeof(b2SceneFixture)))
+	{
+		return false;
+	}
+	remaining -= header->fixtureCount * int32(sizeof(b2SceneFixture));
+
+	if (header->jointCount < 0 || header->jointCount > remaining / int32(sizeof(b2SceneJoint)))
+	{
+		return false;
+	}
+	remaining -= header->jointCount * int32(sizeof(b2SceneJoint));
+
+	if (header->vertexCount < 0 || header->vertexCount > remaining / int32(sizeof(b2Vec2)))
+	{
+		return false;
+	}
+	remaining -= header->vertexCount * int32(sizeof(b2Vec2));
+
+	if (header->nameSize != remaining || (remaining & 3) != 0)
+	{
+		return false;
+	}
+
+	const b2SceneBody* bodies = (const b2SceneBody*)(header + 1);
+	const b2SceneFixture* fixtures = (const b2SceneFixture*)(bodies + header->bodyCount);
+	const b2SceneJoint* joints = (const b2SceneJoint*)(fixtures + header->fixtureCount);
+	const b2Vec2* vertices = (const b2Vec2*)(joints + header->jointCount);
+	const char* names = (const char*)(vertices + header->vertexCount);
+
+	if (header->nameSize > 0 && names[header->nameSize - 1] != 0)
+	{
+		return false;
+	}
+
+	// Check the records, so that creating the scene can trust them.
+	for (int32 i = 0; i < header->bodyCount; ++i)
+	{
+		const b2SceneBody* b = bodies + i;
+		if (b->type < b2_staticBody || b->type > b2_dynamicBody ||
+			b2IsValidRange(b->fixtureIndex, b->fixtureCount, header->fixtureCount) == false ||
+			b2IsValidName(b->name, header->nameSize) == false)
+		{
+			return false;
+		}
+
+		// The mass is not recomputed, so a dynamic body must come with one.
+		if (b->type == b2_dynamicBody && (b->mass > 0.0f && b->invMass > 0.0f) == false)
+		{
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < header->fixtureCount; ++i)
+	{
+		const b2SceneFixture* f = fixtures + i;
+		if (b2IsValidRange(f->vertexIndex, f->vertexCount, header->vertexCount) == false ||
+			b2IsValidName(f->name, header->nameSize) == false ||
+			f->continuous < b2_continuousNever || f->continuous > b2_continuousAlways)
+		{
+			return false;
+		}
+
+		bool valid = false;
+		switch (f->shapeType)
+		{
+		case b2Shape::e_circle:
+			valid = f->vertexCount == 0;
+			break;
+
+		case b2Shape::e_edge:
+			valid = f->vertexCount == 4;
+			break;
+
+		case b2Shape::e_polygon:
+			valid = (f->vertexCount & 1) == 0 && 3 <= f->vertexCount / 2 && f->vertexCount / 2 <= b2_maxPolygonVertices;
+			break;
+
+		case b2Shape::e_chain:
+			valid = f->vertexCount >= 4;
+			break;
+
+		case b2Shape::e_capsule:
+			valid = f->vertexCount == 2;
+			break;
+
+		default:
+			break;
+		}
+
+		if (valid == false)
+		{
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < header->jointCount; ++i)
+	{
+		const b2SceneJoint* j = joints + i;
+		if ((j->type != e_revoluteJoint && j->type != e_prismaticJoint &&
+			 j->type != e_distanceJoint && j->type != e_weldJoint) ||
+			b2IsValidRange(j->bodyA, 1, header->bodyCount) == false ||
+			b2IsValidRange(j->bodyB, 1, header->bodyCount) == false ||
+			j->bodyA == j->bodyB ||
+			b2IsValidName(j->name, header->nameSize) == false)
+		{
+			return false;
+		}
+	}
+
+	m_header = header;
+	m_bodies = bodies;
+	m_fixtures = fixtures;
+	m_joints = joints;
+	m_vertices = vertices;
+	m_names = names;
+	return true;
+}
+
+b2Fixture* b2Scene::CreateFixture(b2Body* body, const b2SceneFixture* fixture) const
+{
+	const b2Vec2* v = m_vertices + fixture->vertexIndex;
+	bool hasVertex0 = (fixture->flags & b2SceneFixture::e_hasVertex0) == b2SceneFixture::e_hasVertex0;
+	bool hasVertex3 = (fixture->flags & b2SceneFixture::e_hasVertex3) == b2SceneFixture::e_hasVertex3;
+
+	b2CircleShape circle;
+	b2EdgeShape edge;
+	b2PolygonShape polygon;
+	b2ChainShape chain;
+	b2CapsuleShape capsule;
+
+	b2FixtureDef def;
+	switch (fixture->shapeType)
+	{
+	case b2Shape::e_circle:
+		circle.m_p = fixture->centroid;
+		def.shape = &circle;
+		break;
+
+	case b2Shape::e_edge:
+		edge.m_vertex0 = v[0];
+		edge.m_vertex1 = v[1];
+		edge.m_vertex2 = v[2];
+		edge.m_vertex3 = v[3];
+		edge.m_hasVertex0 = hasVertex0;
+		edge.m_hasVertex3 = hasVertex3;
+		def.shape = &edge;
+		break;
+
+	case b2Shape::e_polygon:
+		// The hull, normals and centroid were computed when the scene was written.
+		polygon.m_count = fixture->vertexCount / 2;
+		memcpy(polygon.m_vertices, v, polygon.m_count * sizeof(b2Vec2));
+		memcpy(polygon.m_normals, v + polygon.m_count, polygon.m_count * sizeof(b2Vec2));
+		polygon.m_centroid = fixture->centroid;
+		polygon.m_isBox = (fixture->flags & b2SceneFixture::e_box) == b2SceneFixture::e_box;
+		polygon.m_box = fixture->box;
+		def.shape = &polygon;
+		break;
+
+	case b2Shape::e_chain:
+		{
+			int32 count = fixture->vertexCount - 2;
+			chain.CreateChain(v, count);
+			chain.m_prevVertex = v[count];
+			chain.m_nextVertex = v[count + 1];
+			chain.m_hasPrevVertex = hasVertex0;
+			chain.m_hasNextVertex = hasVertex3;
+			def.shape = &chain;
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		capsule.m_vertex1 = v[0];
+		capsule.m_vertex2 = v[1];
+		def.shape = &capsule;
+		break;
+
+	default:
+		b2Assert(false);
+		return NULL;
+	}
+
+	circle.m_radius = fixture->radius;
+	edge.m_radius = fixture->radius;
+	polygon.m_radius = fixture->radius;
+	chain.m_radius = fixture->radius;
+	capsule.m_radius = fixture->radius;
+
+	def.friction = fixture->friction;
+	def.restitution = fixture->restitution;
+	def.density = fixture->density;
+	def.isSensor = (fixture->flags & b2SceneFixture::e_sensor) == b2SceneFixture::e_sensor;
+	def.continuous = b2ContinuousMode(fixture->continuous);
+	def.filter.categoryBits = uint16(fixture->categoryBits);
+	def.filter.maskBits = uint16(fixture->maskBits);
+	def.filter.groupIndex = int16(fixture->groupIndex);
+
+	return body->AddFixture(&def);
+}
+
+void b2Scene::Create(b2World* world, b2Body** bodies, b2Fixture** fixtures, b2Joint** joints) const
+{
+	b2Assert(m_header != NULL);
+	b2Assert(world->IsLocked() == false);
+	if (m_header == NULL || world->IsLocked() || m_header->bodyCount == 0)
+	{
+		return;
+	}
+
+	int32 bodyCount = m_header->bodyCount;
+	b2Body** created = bodies;
+	if (created == NULL)
+	{
+		created = (b2Body**)world->m_stackAllocator.Allocate(bodyCount * sizeof(b2Body*));
+	}
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		const b2SceneBody* sb = m_bodies + i;
+
+		b2BodyDef bd;
+		bd.type = b2BodyType(sb->type);
+		bd.position = sb->position;
+		bd.angle = sb->angle;
+		bd.linearVelocity = sb->linearVelocity;
+		bd.angularVelocity = sb->angularVelocity;
+		bd.linearDamping = sb->linearDamping;
+		bd.angularDamping = sb->angularDamping;
+		bd.gravityScale = sb->gravityScale;
+		bd.awake = (sb->flags & b2SceneBody::e_awake) == b2SceneBody::e_awake;
+		bd.allowSleep = (sb->flags & b2SceneBody::e_allowSleep) == b2SceneBody::e_allowSleep;
+		bd.fixedRotation = (sb->flags & b2SceneBody::e_fixedRotation) == b2SceneBody::e_fixedRotation;
+		bd.bullet = (sb->flags & b2SceneBody::e_bullet) == b2SceneBody::e_bullet;
+		bd.active = (sb->flags & b2SceneBody::e_active) == b2SceneBody::e_active;
+		bd.compound = (sb->flags & b2SceneBody::e_compound) == b2SceneBody::e_compound;
+
+		b2Body* b = world->CreateBody(&bd);
+
+		for (int32 j = 0; j < sb->fixtureCount; ++j)
+		{
+			int32 index = sb->fixtureIndex + j;
+			b2Fixture* f = CreateFixture(b, m_fixtures + index);
+			if (fixtures)
+			{
+				fixtures[index] = f;
+			}
+		}
+
+		// The mass data comes from the scene instead of ResetMassData.
+		b->m_mass = sb->mass;
+		b->m_invMass = sb->invMass;
+		b->m_I = sb->I;
+		b->m_invI = sb->invI;
+		b->m_sweep->localCenter = sb->localCenter;
+		b->m_sweep->c0 = b->m_sweep->c = b2Mul(b->m_xf, sb->localCenter);
+
+		created[i] = b;
+	}
+
+	if (m_header->fixtureCount > 0)
+	{
+		world->CreateFixtureProxies(created, bodyCount);
+
+		for (int32 i = 0; i < bodyCount; ++i)
+		{
+			created[i]->ResetCompoundProxy();
+		}
+
+		world->m_flags |= b2World::e_newFixture;
+	}
+
+	for (int32 i = 0; i < m_header->jointCount; ++i)
+	{
+		const b2SceneJoint* sj = m_joints + i;
+		bool collideConnected = (sj->flags & b2SceneJoint::e_collideConnected) == b2SceneJoint::e_collideConnected;
+		bool enableLimit = (sj->flags & b2SceneJoint::e_enableLimit) == b2SceneJoint::e_enableLimit;
+		bool enableMotor = (sj->flags & b2SceneJoint::e_enableMotor) == b2SceneJoint::e_enableMotor;
+
+		b2Joint* joint = NULL;
+		switch (sj->type)
+		{
+		case e_revoluteJoint:
+			{
+				b2RevoluteJointDef jd;
+				jd.bodyA = created[sj->bodyA];
+				jd.bodyB = created[sj->bodyB];
+				jd.collideConnected = collideConnected;
+				jd.localAnchorA = sj->localAnchorA;
+				jd.localAnchorB = sj->localAnchorB;
+				jd.referenceAngle = sj->referenceAngle;
+				jd.enableLimit = enableLimit;
+				jd.lowerAngle = sj->lowerLimit;
+				jd.upperAngle = sj->upperLimit;
+				jd.enableMotor = enableMotor;
+				jd.motorSpeed = sj->motorSpeed;
+				jd.maxMotorTorque = sj->maxMotorForce;
+				joint = world->CreateJoint(&jd);
+			}
+			break;
+
+		case e_prismaticJoint:
+			{
+				b2PrismaticJointDef jd;
+				jd.bodyA = created[sj->bodyA];
+				jd.bodyB = created[sj->bodyB];
+				jd.collideConnected = collideConnected;
+				jd.localAnchorA = sj->localAnchorA;
+				jd.localAnchorB = sj->localAnchorB;
+				jd.localAxisA = sj->localAxisA;
+				jd.referenceAngle = sj->referenceAngle;
+				jd.enableLimit = enableLimit;
+				jd.lowerTranslation = sj->lowerLimit;
+				jd.upperTranslation = sj->upperLimit;
+				jd.enableMotor = enableMotor;
+				jd.motorSpeed = sj->motorSpeed;
+				jd.maxMotorForce = sj->maxMotorForce;
+				joint = world->CreateJoint(&jd);
+
+				// Normalizing the stored axis again can change its last bits.
+				b2PrismaticJoint* prismatic = (b2PrismaticJoint*)joint;
+				prismatic->m_localXAxisA = sj->localAxisA;
+				prismatic->m_localYAxisA = b2Cross(1.0f, sj->localAxisA);
+			}
+			break;
+
+		case e_distanceJoint:
+			{
+				b2DistanceJointDef jd;
+				jd.bodyA = created[sj->bodyA];
+				jd.bodyB = created[sj->bodyB];
+				jd.collideConnected = collideConnected;
+				jd.localAnchorA = sj->localAnchorA;
+				jd.localAnchorB = sj->localAnchorB;
+				jd.length = sj->length;
+				jd.frequencyHz = sj->frequencyHz;
+				jd.dampingRatio = sj->dampingRatio;
+				joint = world->CreateJoint(&jd);
+			}
+			break;
+
+		case e_weldJoint:
+			{
+				b2WeldJointDef jd;
+				jd.bodyA = created[sj->bodyA];
+				jd.bodyB = created[sj->bodyB];
+				jd.collideConnected = collideConnected;
+				jd.localAnchorA = sj->localAnchorA;
+				jd.localAnchorB = sj->localAnchorB;
+				jd.referenceAngle = sj->referenceAngle;
+				jd.frequencyHz = sj->frequencyHz;
+				jd.dampingRatio = sj->dampingRatio;
+				joint = world->CreateJoint(&jd);
+			}
+			break;
+
+		default:
+			b2Assert(false);
+			break;
+		}
+
+		if (joints)
+		{
+			joints[i] = joint;
+		}
+	}
+
+	if (bodies == NULL)
+	{
+		world->m_stackAllocator.Free(created);
+	}
+}
+
+// Get the number of vertex section entries a shape needs.
+static int32 b2GetSceneVertexCount(const b2Shape* shape)
+{
+	switch (shape->GetType())
+	{
+	case b2Shape::e_edge:
+		return 4;
+
+	case b2Shape::e_polygon:
+		return 2 * ((const b2PolygonShape*)shape)->m_count;
+
+	case b2Shape::e_chain:
+		return ((const b2ChainShape*)shape)->m_count + 2;
+
+	case b2Shape::e_capsule:
+		return 2;
+
+	default:
+		return 0;
+	}
+}
+
+bool b2Scene::Write(const char* path, b2World* world, b2SceneNamer* namer)
+{
+	b2Assert(world->IsLocked() == false);
+
+	int32 bodyCount = world->m_bodyCount;
+	int32 jointCount = world->m_jointCount;
+
+	for (b2Joint* j = world->GetJointList(); j; j = j->GetNext())
+	{
+		b2JointType type = j->GetType();
+		if (type != e_revoluteJoint && type != e_prismaticJoint && type != e_distanceJoint && type != e_weldJoint)
+		{
+			return false;
+		}
+	}
+
+	// The world lists hold the newest objects first. The scene holds them in
+	// creation order, so that creating it rebuilds the same lists.
+	int32 fixtureCount = 0;
+	int32 vertexCount = 0;
+	for (b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		fixtureCount += b->m_fixtureCount;
+		for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+		{
+			vertexCount += b2GetSceneVertexCount(f->m_shape);
+		}
+	}
+
+	int32 objectCount = bodyCount + fixtureCount + jointCount;
+	b2Body** bodies = (b2Body**)b2Alloc(b2Max(bodyCount, 1) * sizeof(b2Body*));
+	b2Fixture** fixtures = (b2Fixture**)b2Alloc(b2Max(fixtureCount, 1) * sizeof(b2Fixture*));
+	b2Joint** joints = (b2Joint**)b2Alloc(b2Max(jointCount, 1) * sizeof(b2Joint*));
+	const char** names = (const char**)b2Alloc(b2Max(objectCount, 1) * sizeof(const char*));
+	int32* bodyIndices = (int32*)b2Alloc(b2Max(world->m_bodySlotCount, 1) * sizeof(int32));
+
+	int32 i = bodyCount;
+	for (b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		bodies[--i] = b;
+		bodyIndices[b->m_slot] = i;
+	}
+
+	int32 fixtureIndex = 0;
+	for (i = 0; i < bodyCount; ++i)
+	{
+		fixtureIndex += bodies[i]->m_fixtureCount;
+		int32 k = fixtureIndex;
+		for (b2Fixture* f = bodies[i]->GetFixtureList(); f; f = f->GetNext())
+		{
+			fixtures[--k] = f;
+		}
+	}
+
+	i = jointCount;
+	for (b2Joint* j = world->GetJointList(); j; j = j->GetNext())
+	{
+		joints[--i] = j;
+	}
+
+	// Names are stored back to back, in scene order.
+	int32 nameSize = 0;
+	for (i = 0; i < objectCount; ++i)
+	{
+		const char* name = NULL;
+		if (namer)
+		{
+			if (i < bodyCount)
+			{
+				name = namer->GetName(bodies[i]);
+			}
+			else if (i < bodyCount + fixtureCount)
+			{
+				name = namer->GetName(fixtures[i - bodyCount]);
+			}
+			else
+			{
+				name = namer->GetName(joints[i - bodyCount - fixtureCount]);
+			}
+		}
+
+		names[i] = name;
+		if (name)
+		{
+			nameSize += int32(strlen(name)) + 1;
+		}
+	}
+	int32 namePadding = (4 - (nameSize & 3)) & 3;
+
+	b2SceneHeader header;
+	header.magic = b2_sceneMagic;
+	header.version = b2_sceneVersion;
+	header.bodyCount = bodyCount;
+	header.fixtureCount = fixtureCount;
+	header.jointCount = jointCount;
+	header.vertexCount = vertexCount;
+	header.nameSize = nameSize + namePadding;
+	header.size = int32(sizeof(b2SceneHeader)) +
+		bodyCount * int32(sizeof(b2SceneBody)) +
+		fixtureCount * int32(sizeof(b2SceneFixture)) +
+		jointCount * int32(sizeof(b2SceneJoint)) +
+		vertexCount * int32(sizeof(b2Vec2)) +
+		header.nameSize;
+
+	FILE* file = fopen(path, "wb");
+	bool ok = file != NULL;
+	if (ok)
+	{
+		ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+		int32 name = 0;
+		fixtureIndex = 0;
+		for (i = 0; i < bodyCount && ok; ++i)
+		{
+			b2Body* b = bodies[i];
+
+			// Clear the whole record so that unused fields are written the same way every time.
+			b2SceneBody record;
+			memset((void*)&record, 0, sizeof(record));
+			record.type = b->GetType();
+			record.flags |= b->IsAwake() ? b2SceneBody::e_awake : 0;
+			record.flags |= b->IsSleepingAllowed() ? b2SceneBody::e_allowSleep : 0;
+			record.flags |= b->IsFixedRotation() ? b2SceneBody::e_fixedRotation : 0;
+			record.flags |= b->IsBullet() ? b2SceneBody::e_bullet : 0;
+			record.flags |= b->IsActive() ? b2SceneBody::e_active : 0;
+			record.flags |= b->IsCompound() ? b2SceneBody::e_compound : 0;
+			record.position = b->GetPosition();
+			record.angle = b->GetAngle();
+			record.linearVelocity = b->GetLinearVelocity();
+			record.angularVelocity = b->GetAngularVelocity();
+			record.linearDamping = b->GetLinearDamping();
+			record.angularDamping = b->GetAngularDamping();
+			record.gravityScale = b->GetGravityScale();
+			record.mass = b->m_mass;
+			record.invMass = b->m_invMass;
+			record.I = b->m_I;
+			record.invI = b->m_invI;
+			record.localCenter = b->m_sweep->localCenter;
+			record.fixtureIndex = fixtureIndex;
+			record.fixtureCount = b->m_fixtureCount;
+			record.name = names[i] ? name : -1;
+
+			fixtureIndex += b->m_fixtureCount;
+			name += names[i] ? int32(strlen(names[i])) + 1 : 0;
+			ok = fwrite(&record, sizeof(record), 1, file) == 1;
+		}
+
+		int32 vertexIndex = 0;
+		for (i = 0; i < fixtureCount && ok; ++i)
+		{
+			b2Fixture* f = fixtures[i];
+			const b2Shape* shape = f->m_shape;
+			const char* fixtureName = names[bodyCount + i];
+
+			b2SceneFixture record;
+			memset((void*)&record, 0, sizeof(record));
+			record.shapeType = shape->GetType();
+			record.radius = shape->m_radius;
+			record.friction = f->GetFriction();
+			record.restitution = f->GetRestitution();
+			record.density = f->GetDensity();
+			record.flags |= f->IsSensor() ? b2SceneFixture::e_sensor : 0;
+			record.continuous = f->GetContinuousMode();
+			record.categoryBits = f->GetFilterData().categoryBits;
+			record.maskBits = f->GetFilterData().maskBits;
+			record.groupIndex = f->GetFilterData().groupIndex;
+			record.vertexIndex = vertexIndex;
+			record.vertexCount = b2GetSceneVertexCount(shape);
+			record.name = fixtureName ? name : -1;
+
+			switch (shape->GetType())
+			{
+			case b2Shape::e_circle:
+				record.centroid = ((const b2CircleShape*)shape)->m_p;
+				break;
+
+			case b2Shape::e_edge:
+				{
+					const b2EdgeShape* edge = (const b2EdgeShape*)shape;
+					record.flags |= edge->m_hasVertex0 ? b2SceneFixture::e_hasVertex0 : 0;
+					record.flags |= edge->m_hasVertex3 ? b2SceneFixture::e_hasVertex3 : 0;
+				}
+				break;
+
+			case b2Shape::e_polygon:
+				{
+					const b2PolygonShape* polygon = (const b2PolygonShape*)shape;
+					record.centroid = polygon->m_centroid;
+					if (polygon->m_isBox)
+					{
+						record.flags |= b2SceneFixture::e_box;
+						record.box = polygon->m_box;
+					}
+				}
+				break;
+
+			case b2Shape::e_chain:
+				{
+					const b2ChainShape* chain = (const b2ChainShape*)shape;
+					record.flags |= chain->m_hasPrevVertex ? b2SceneFixture::e_hasVertex0 : 0;
+					record.flags |= chain->m_hasNextVertex ? b2SceneFixture::e_hasVertex3 : 0;
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			vertexIndex += record.vertexCount;
+			name += fixtureName ? int32(strlen(fixtureName)) + 1 : 0;
+			ok = fwrite(&record, sizeof(record), 1, file) == 1;
+		}
+
+		for (i = 0; i < jointCount && ok; ++i)
+		{
+			b2Joint* j = joints[i];
+			const char* jointName = names[bodyCount + fixtureCount + i];
+
+			b2SceneJoint record;
+			memset((void*)&record, 0, sizeof(record));
+			record.type = j->GetType();
+			record.bodyA = bodyIndices[j->GetBodyA()->m_slot];
+			record.bodyB = bodyIndices[j->GetBodyB()->m_slot];
+			record.flags |= j->GetCollideConnected() ? b2SceneJoint::e_collideConnected : 0;
+			record.name = jointName ? name : -1;
+
+			switch (j->GetType())
+			{
+			case e_revoluteJoint:
+				{
+					const b2RevoluteJoint* joint = (const b2RevoluteJoint*)j;
+					record.flags |= joint->IsLimitEnabled() ? b2SceneJoint::e_enableLimit : 0;
+					record.flags |= joint->IsMotorEnabled() ? b2SceneJoint::e_enableMotor : 0;
+					record.localAnchorA = joint->GetLocalAnchorA();
+					record.localAnchorB = joint->GetLocalAnchorB();
+					record.referenceAngle = joint->GetReferenceAngle();
+					record.lowerLimit = joint->GetLowerLimit();
+					record.upperLimit = joint->GetUpperLimit();
+					record.motorSpeed = joint->GetMotorSpeed();
+					record.maxMotorForce = joint->GetMaxMotorTorque();
+				}
+				break;
+
+			case e_prismaticJoint:
+				{
+					const b2PrismaticJoint* joint = (const b2PrismaticJoint*)j;
+					record.flags |= joint->IsLimitEnabled() ? b2SceneJoint::e_enableLimit : 0;
+					record.flags |= joint->IsMotorEnabled() ? b2SceneJoint::e_enableMotor : 0;
+					record.localAnchorA = joint->GetLocalAnchorA();
+					record.localAnchorB = joint->GetLocalAnchorB();
+					record.localAxisA = joint->GetLocalAxisA();
+					record.referenceAngle = joint->GetReferenceAngle();
+					record.lowerLimit = joint->GetLowerLimit();
+					record.upperLimit = joint->GetUpperLimit();
+					record.motorSpeed = joint->GetMotorSpeed();
+					record.maxMotorForce = joint->GetMaxMotorForce();
+				}
+				break;
+
+			case e_distanceJoint:
+				{
+					const b2DistanceJoint* joint = (const b2DistanceJoint*)j;
+					record.localAnchorA = joint->GetLocalAnchorA();
+					record.localAnchorB = joint->GetLocalAnchorB();
+					record.length = joint->GetLength();
+					record.frequencyHz = joint->GetFrequency();
+					record.dampingRatio = joint->GetDampingRatio();
+				}
+				break;
+
+			case e_weldJoint:
+				{
+					const b2WeldJoint* joint = (const b2WeldJoint*)j;
+					record.localAnchorA = joint->GetLocalAnchorA();
+					record.localAnchorB = joint->GetLocalAnchorB();
+					record.referenceAngle = joint->GetReferenceAngle();
+					record.frequencyHz = joint->GetFrequency();
+					record.dampingRatio = joint->GetDampingRatio();
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			name += jointName ? int32(strlen(jointName)) + 1 : 0;
+			ok = fwrite(&record, sizeof(record), 1, file) == 1;
+		}
+
+		for (i = 0; i < fixtureCount && ok; ++i)
+		{
+			const b2Shape* shape = fixtures[i]->m_shape;
+			switch (shape->GetType())
+			{
+			case b2Shape::e_edge:
+				{
+					const b2EdgeShape* edge = (const b2EdgeShape*)shape;
+					b2Vec2 vertices[4] = { edge->m_vertex0, edge->m_vertex1, edge->m_vertex2, edge->m_vertex3 };
+					ok = fwrite(vertices, sizeof(vertices), 1, file) == 1;
+				}
+				break;
+
+			case b2Shape::e_polygon:
+				{
+					const b2PolygonShape* polygon = (const b2PolygonShape*)shape;
+					ok = fwrite(polygon->m_vertices, sizeof(b2Vec2), polygon->m_count, file) == size_t(polygon->m_count) &&
+						 fwrite(polygon->m_normals, sizeof(b2Vec2), polygon->m_count, file) == size_t(polygon->m_count);
+				}
+				break;
+
+			case b2Shape::e_chain:
+				{
+					const b2ChainShape* chain = (const b2ChainShape*)shape;
+					b2Vec2 ends[2] = { chain->m_prevVertex, chain->m_nextVertex };
+					ok = fwrite(chain->m_vertices, sizeof(b2Vec2), chain->m_count, file) == size_t(chain->m_count) &&
+						 fwrite(ends, sizeof(ends), 1, file) == 1;
+				}
+				break;
+
+			case b2Shape::e_capsule:
+				{
+					const b2CapsuleShape* capsule = (const b2CapsuleShape*)shape;
+					b2Vec2 vertices[2] = { capsule->m_vertex1, capsule->m_vertex2 };
+					ok = fwrite(vertices, sizeof(vertices), 1, file) == 1;
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		for (i = 0; i < objectCount && ok; ++i)
+		{
+			if (names[i])
+			{
+				ok = fwrite(names[i], strlen(names[i]) + 1, 1, file) == 1;
+			}
+		}
+
+		const char padding[4] = { 0, 0, 0, 0 };
+		if (ok && namePadding > 0)
+		{
+			ok = fwrite(padding, namePadding, 1, file) == 1;
+		}
+
+		ok = fclose(file) == 0 && ok;
+	}
+
+	b2Free(bodyIndices);
+	b2Free(names);
+	b2Free(joints);
+	b2Free(fixtures);
+	b2Free(bodies);
+
+	return ok;
+}
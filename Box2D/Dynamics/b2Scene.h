@@ -0,0 +1,270 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_SCENE_H
+#define B2_SCENE_H
+
+#include <Common/b2MappedFile.h>
+#include <Collision/b2Collision.h>
+
+class b2Body;
+class b2Fixture;
+class b2Joint;
+class b2World;
+
+/// Scene files start with this value. It also tells apart files written on a
+/// machine of the other byte order.
+#define b2_sceneMagic		0x4e435342
+
+/// Scene files of another version are refused.
+#define b2_sceneVersion		1
+
+/// The header of a scene file. The sections follow the header in this order:
+/// bodies, fixtures, joints, vertices and names. Every record is made of 4 byte
+/// fields, so a mapped file can be read in place.
+struct b2SceneHeader
+{
+	uint32 magic;
+	uint32 version;
+	int32 size;				///< the file size in bytes
+	int32 bodyCount;
+	int32 fixtureCount;
+	int32 jointCount;
+	int32 vertexCount;
+	int32 nameSize;			///< the size of the name section in bytes, a multiple of 4
+};
+
+/// A body and its mass data. The fixtures of a body are consecutive.
+struct b2SceneBody
+{
+	enum
+	{
+		e_awake			= 0x0001,
+		e_allowSleep	= 0x0002,
+		e_fixedRotation	= 0x0004,
+		e_bullet		= 0x0008,
+		e_active		= 0x0010,
+		e_compound		= 0x0020
+	};
+
+	int32 type;
+	uint32 flags;
+	b2Vec2 position;
+	float32 angle;
+	b2Vec2 linearVelocity;
+	float32 angularVelocity;
+	float32 linearDamping;
+	float32 angularDamping;
+	float32 gravityScale;
+	float32 mass, invMass;
+	float32 I, invI;		///< about the center of mass
+	b2Vec2 localCenter;
+	int32 fixtureIndex;
+	int32 fixtureCount;
+	int32 name;				///< offset into the name section, or -1
+};
+
+/// A fixture and its shape. The shape is stored in its final form:
+/// - circle: the center is in centroid and there are no vertices.
+/// - polygon: the vertices followed by the normals.
+/// - edge: vertex0 to vertex3.
+/// - chain: the vertices followed by the previous and next vertex.
+/// - capsule: vertex1 and vertex2.
+struct b2SceneFixture
+{
+	enum
+	{
+		e_sensor		= 0x0001,
+		e_box			= 0x0002,	///< polygon is an axis aligned box
+		e_hasVertex0	= 0x0004,	///< edge vertex0 or chain previous vertex is used
+		e_hasVertex3	= 0x0008	///< edge vertex3 or chain next vertex is used
+	};
+
+	int32 shapeType;
+	float32 radius;
+	float32 friction;
+	float32 restitution;
+	float32 density;
+	uint32 flags;
+	int32 continuous;
+	uint32 categoryBits;
+	uint32 maskBits;
+	int32 groupIndex;
+	b2Vec2 centroid;
+	b2AABB box;
+	int32 vertexIndex;
+	int32 vertexCount;		///< the number of entries in the vertex section
+	int32 name;
+};
+
+/// A joint. Only the fields of its type are used.
+struct b2SceneJoint
+{
+	enum
+	{
+		e_collideConnected	= 0x0001,
+		e_enableLimit		= 0x0002,
+		e_enableMotor		= 0x0004
+	};
+
+	int32 type;
+	int32 bodyA;
+	int32 bodyB;
+	uint32 flags;
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	b2Vec2 localAxisA;
+	float32 referenceAngle;
+	float32 lowerLimit;
+	float32 upperLimit;
+	float32 motorSpeed;
+	float32 maxMotorForce;	///< torque for revolute joints
+	float32 length;
+	float32 frequencyHz;
+	float32 dampingRatio;
+	int32 name;
+};
+
+/// Gives names to the objects of a world when it is written as a scene, so the
+/// application can find them again after loading. The names must stay valid
+/// until b2Scene::Write returns.
+class b2SceneNamer
+{
+public:
+	virtual ~b2SceneNamer() {}
+
+	/// @return the name of a body, or NULL for none.
+	virtual const char* GetName(b2Body* body) { B2_NOT_USED(body); return NULL; }
+
+	/// @return the name of a fixture, or NULL for none.
+	virtual const char* GetName(b2Fixture* fixture) { B2_NOT_USED(fixture); return NULL; }
+
+	/// @return the name of a joint, or NULL for none.
+	virtual const char* GetName(b2Joint* joint) { B2_NOT_USED(joint); return NULL; }
+};
+
+/// A precompiled scene of bodies, fixtures and joints. The shapes are stored with
+/// their normals, centroids and bounds and the bodies with their mass, so a scene
+/// is created without building hulls or computing mass. Scene files are written
+/// by b2Scene::Write from a world built the usual way, and are memory mapped
+/// when opened. Files are in the byte order of the machine that wrote them.
+/// A created scene starts in the same state as the written world, but its
+/// proxies are inserted in one batch, so contacts may be created in another
+/// order. It then simulates like the written world but not bit for bit; two
+/// worlds created from the same scene do match bit for bit.
+class b2Scene
+{
+public:
+	b2Scene();
+
+	/// Open a scene file. Joints must connect two different bodies and dynamic
+	/// bodies must have a positive mass.
+	/// @return false if the file is missing, damaged or of another version.
+	bool Open(const char* path);
+
+	/// Open a scene that is already in memory. The data must be 4 byte aligned
+	/// and stay valid until the scene is closed.
+	/// @return false if the data is damaged or of another version.
+	bool Open(const void* data, int32 size);
+
+	/// Close the scene. Objects created from it are not affected.
+	void Close();
+
+	/// Is a scene open?
+	bool IsOpen() const;
+
+	int32 GetBodyCount() const;
+	int32 GetFixtureCount() const;
+	int32 GetJointCount() const;
+
+	/// Get the name of a body, fixture or joint by its index in the scene.
+	/// @return the name, or NULL if the object has none.
+	const char* GetBodyName(int32 index) const;
+	const char* GetFixtureName(int32 index) const;
+	const char* GetJointName(int32 index) const;
+
+	/// Create the scene in a world. The arrays are optional and receive the new
+	/// objects in scene order, so they line up with the names.
+	/// @warning This function is locked during callbacks.
+	void Create(b2World* world, b2Body** bodies = NULL, b2Fixture** fixtures = NULL, b2Joint** joints = NULL) const;
+
+	/// Write the bodies, fixtures and joints of a world as a scene file. Bodies,
+	/// fixtures and joints keep their order, contacts and forces are not written.
+	/// Only revolute, prismatic, distance and weld joints are supported.
+	/// @return false if the file cannot be written or a joint is not supported.
+	static bool Write(const char* path, b2World* world, b2SceneNamer* namer = NULL);
+
+private:
+
+	bool Load(const void* data, int32 size);
+	b2Fixture* CreateFixture(b2Body* body, const b2SceneFixture* fixture) const;
+	const char* GetName(int32 name) const;
+
+	b2MappedFile m_file;
+	const b2SceneHeader* m_header;
+	const b2SceneBody* m_bodies;
+	const b2SceneFixture* m_fixtures;
+	const b2SceneJoint* m_joints;
+	const b2Vec2* m_vertices;
+	const char* m_names;
+};
+
+inline bool b2Scene::IsOpen() const
+{
+	return m_header != NULL;
+}
+
+inline int32 b2Scene::GetBodyCount() const
+{
+	return m_header ? m_header->bodyCount : 0;
+}
+
+inline int32 b2Scene::GetFixtureCount() const
+{
+	return m_header ? m_header->fixtureCount : 0;
+}
+
+inline int32 b2Scene::GetJointCount() const
+{
+	return m_header ? m_header->jointCount : 0;
+}
+
+inline const char* b2Scene::GetName(int32 name) const
+{
+	return name < 0 ? NULL : m_names + name;
+}
+
+inline const char* b2Scene::GetBodyName(int32 index) const
+{
+	b2Assert(0 <= index && index < GetBodyCount());
+	return GetName(m_bodies[index].name);
+}
+
+inline const char* b2Scene::GetFixtureName(int32 index) const
+{
+	b2Assert(0 <= index && index < GetFixtureCount());
+	return GetName(m_fixtures[index].name);
+}
+
+inline const char* b2Scene::GetJointName(int32 index) const
+{
+	b2Assert(0 <= index && index < GetJointCount());
+	return GetName(m_joints[index].name);
+}
+
+#endif
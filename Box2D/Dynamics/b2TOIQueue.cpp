@@ -0,0 +1,197 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2TOIQueue.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <string.h>
+
+b2TOIQueue::b2TOIQueue(b2Allocator* allocator)
+{
+	m_allocator = allocator ? allocator : b2GetDefaultAllocator();
+	m_operationCount = 0;
+	m_contacts = NULL;
+	m_count = 0;
+	m_capacity = 0;
+}
+
+b2TOIQueue::~b2TOIQueue()
+{
+	if (m_contacts)
+	{
+		m_allocator->Free(m_contacts, m_capacity * sizeof(b2Contact*), b2_contactMemory);
+	}
+}
+
+void b2TOIQueue::Clear()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_contacts[i]->m_toiIndex = -1;
+	}
+
+	m_count = 0;
+}
+
+void b2TOIQueue::Reserve(int32 count)
+{
+	if (count <= m_capacity)
+	{
+		return;
+	}
+
+	b2Contact** oldContacts = m_contacts;
+	m_contacts = (b2Contact**)m_allocator->Allocate(count * sizeof(b2Contact*), b2_contactMemory);
+	if (oldContacts)
+	{
+		memcpy(m_contacts, oldContacts, m_count * sizeof(b2Contact*));
+		m_allocator->Free(oldContacts, m_capacity * sizeof(b2Contact*), b2_contactMemory);
+	}
+	m_capacity = count;
+}
+
+void b2TOIQueue::Update(b2Contact* contact)
+{
+	++m_operationCount;
+
+	int32 index = contact->m_toiIndex;
+	if (index != -1)
+	{
+		b2Assert(m_contacts[index] == contact);
+
+		// Only one of these moves the contact.
+		SiftUp(index);
+		SiftDown(contact->m_toiIndex);
+		return;
+	}
+
+	// Grow the heap as needed.
+	if (m_count == m_capacity)
+	{
+		b2Contact** oldContacts = m_contacts;
+		m_capacity = b2Max(2 * m_capacity, 64);
+		m_contacts = (b2Contact**)m_allocator->Allocate(m_capacity * sizeof(b2Contact*), b2_contactMemory);
+		if (oldContacts)
+		{
+			memcpy(m_contacts, oldContacts, m_count * sizeof(b2Contact*));
+			m_allocator->Free(oldContacts, m_count * sizeof(b2Contact*), b2_contactMemory);
+		}
+	}
+
+	contact->m_toiIndex = m_count;
+	m_contacts[m_count] = contact;
+	++m_count;
+
+	SiftUp(contact->m_toiIndex);
+}
+
+void b2TOIQueue::Remove(b2Contact* contact)
+{
+	int32 index = contact->m_toiIndex;
+	if (index == -1)
+	{
+		return;
+	}
+
+	++m_operationCount;
+
+	b2Assert(m_contacts[index] == contact);
+	contact->m_toiIndex = -1;
+
+	// Move the last contact into the hole.
+	--m_count;
+	if (index == m_count)
+	{
+		return;
+	}
+
+	b2Contact* last = m_contacts[m_count];
+	m_contacts[index] = last;
+	last->m_toiIndex = index;
+
+	SiftUp(index);
+	SiftDown(last->m_toiIndex);
+}
+
+// Ties go to the newer contact, which is also the order of the world contact list.
+bool b2TOIQueue::LessThan(const b2Contact* contact1, const b2Contact* contact2)
+{
+	if (contact1->m_toi < contact2->m_toi)
+	{
+		return true;
+	}
+
+	if (contact1->m_toi == contact2->m_toi)
+	{
+		return contact1->m_creationStamp > contact2->m_creationStamp;
+	}
+
+	return false;
+}
+
+void b2TOIQueue::SiftUp(int32 index)
+{
+	b2Contact* contact = m_contacts[index];
+	while (index > 0)
+	{
+		int32 parentIndex = (index - 1) >> 1;
+		b2Contact* parent = m_contacts[parentIndex];
+		if (LessThan(contact, parent) == false)
+		{
+			break;
+		}
+
+		m_contacts[index] = parent;
+		parent->m_toiIndex = index;
+		index = parentIndex;
+	}
+
+	m_contacts[index] = contact;
+	contact->m_toiIndex = index;
+}
+
+void b2TOIQueue::SiftDown(int32 index)
+{
+	b2Contact* contact = m_contacts[index];
+	for (;;)
+	{
+		int32 childIndex = 2 * index + 1;
+		if (childIndex >= m_count)
+		{
+			break;
+		}
+
+		// Pick the earlier child.
+		if (childIndex + 1 < m_count && LessThan(m_contacts[childIndex + 1], m_contacts[childIndex]))
+		{
+			++childIndex;
+		}
+
+		b2Contact* child = m_contacts[childIndex];
+		if (LessThan(child, contact) == false)
+		{
+			break;
+		}
+
+		m_contacts[index] = child;
+		child->m_toiIndex = index;
+		index = childIndex;
+	}
+
+	m_contacts[index] = contact;
+	contact->m_toiIndex = index;
+}
@@ -0,0 +1,75 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_TOI_QUEUE_H
+#define B2_TOI_QUEUE_H
+
+#include <Common/b2Allocator.h>
+
+class b2Contact;
+
+/// A binary min-heap of contacts ordered by their time of impact. Each queued
+/// contact stores its heap index so it can be moved or removed in place when
+/// its time of impact changes.
+/// This is an internal class.
+class b2TOIQueue
+{
+public:
+	b2TOIQueue(b2Allocator* allocator = NULL);
+	~b2TOIQueue();
+
+	/// Remove all contacts.
+	void Clear();
+
+	/// Make room for the given number of contacts.
+	void Reserve(int32 count);
+
+	/// Insert a contact, or move it if it is queued and its time of impact changed.
+	void Update(b2Contact* contact);
+
+	/// Remove a contact if it is queued.
+	void Remove(b2Contact* contact);
+
+	/// Get the contact with the earliest time of impact. The queue must not be empty.
+	b2Contact* GetMin() const
+	{
+		b2Assert(m_count > 0);
+		return m_contacts[0];
+	}
+
+	int32 GetCount() const
+	{
+		return m_count;
+	}
+
+	/// Insertions, moves and removals since this was last reset.
+	int32 m_operationCount;
+
+private:
+
+	static bool LessThan(const b2Contact* contact1, const b2Contact* contact2);
+	void SiftUp(int32 index);
+	void SiftDown(int32 index);
+
+	b2Allocator* m_allocator;
+	b2Contact** m_contacts;
+	int32 m_count;
+	int32 m_capacity;
+};
+
+#endif
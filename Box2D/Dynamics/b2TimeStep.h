@@ -21,7 +21,7 @@
 
 #include <Common/b2Math.h>
 
-/// Profiling data. Times are in milliseconds.
+/// Profiling data. Times are in milliseconds. Counts are for the last step.
 struct b2Profile
 {
 	float32 step;
@@ -32,6 +32,17 @@ struct b2Profile
 	float32 solvePosition;
 	float32 broadphase;
 	float32 solveTOI;
+	int32 toiEvents;		// TOI events solved
+	int32 toiQueueOperations;	// TOI queue insertions, moves and removals
+	int32 toiComputed;		// calls to b2TimeOfImpact
+	int32 toiSkipped;		// candidates culled by policy or motion bound
+	int32 islandCount;		// islands solved
+	int32 velocityIterations;	// velocity iterations summed over islands
+	int32 maxVelocityIterations;	// most velocity iterations used by one island
+	int32 iterationHistogram[b2_iterationHistogramSize];	// islands by velocity iterations, bucket i holds i + 1
+	int32 allocations;		// heap allocations made by the world during the step
+	int32 stackMaxAllocation;	// most step memory in use at once so far
+	int32 stackFallbacks;	// step allocations that did not fit and used the heap
 };
 
 /// This is an internal structure.
@@ -40,16 +51,14 @@ struct b2TimeStep
 	float32 dt;			// time step
 	float32 inv_dt;		// inverse time step (0 if dt == 0).
 	float32 dtRatio;	// dt * inv_dt0
-	int32 velocityIterations;
+	int32 minVelocityIterations;
+	int32 velocityIterations;	// upper bound, a fixed count when equal to minVelocityIterations
 	int32 positionIterations;
+	int32 substepCount;	// soft step substeps, 0 for the iterative solver
 	bool warmStarting;
-};
-
-/// This is an internal structure.
-struct b2Position
-{
-	b2Vec2 c;
-	float32 a;
+	bool directJointSolver;
+	bool integrateRotation;
+	bool syncRotation;	// set the integrated rotations from the angles
 };
 
 /// This is an internal structure.
@@ -59,11 +68,12 @@ struct b2Velocity
 	float32 w;
 };
 
-/// Solver Data
+/// Solver Data. The positions are the body sweeps of the world, indexed by body
+/// slot. The solver moves their current center and angle.
 struct b2SolverData
 {
 	b2TimeStep step;
-	b2Position* positions;
+	b2Sweep* positions;
 	b2Velocity* velocities;
 };
 
@@ -21,6 +21,9 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2Island.h>
 #include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
+#include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/Joints/b2WeldJoint.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Collision/b2Collision.h>
@@ -29,27 +32,55 @@
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
 #include <new>
 
-b2World::b2World(const b2Vec2& gravity)
+b2World::b2World(const b2Vec2& gravity, b2Allocator* allocator)
+	: m_allocator(allocator),
+	  m_blockAllocator(&m_allocator, b2_generalMemory),
+	  m_fixtureAllocator(&m_allocator, b2_fixtureMemory),
+	  m_contactAllocator(&m_allocator, b2_contactMemory),
+	  m_userDataAllocator(&m_allocator, b2_userDataMemory),
+	  m_stackAllocator(&m_allocator),
+	  m_contactManager(&m_allocator),
+	  m_toiQueue(&m_allocator),
+	  m_bodyHandles(&m_allocator),
+	  m_fixtureHandles(&m_allocator),
+	  m_jointHandles(&m_allocator)
 {
 	m_destructionListener = NULL;
 	m_debugDraw = NULL;
+	m_taskScheduler = NULL;
 
 	m_bodyList = NULL;
 	m_jointList = NULL;
 
 	m_bodyCount = 0;
 	m_jointCount = 0;
+	m_sharedShapeList = NULL;
+
+	m_bodySlots = NULL;
+	m_bodySweeps = NULL;
+	m_bodyVelocities = NULL;
+	m_freeBodySlots = NULL;
+	m_freeBodySlotCount = 0;
+	m_bodySlotCount = 0;
+	m_bodySlotCapacity = 0;
 
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
+	m_speculativeContacts = false;
+	m_substepCount = 0;
+	m_directJointSolver = false;
+	m_rotationIntegration = false;
 
 	m_stepComplete = true;
+	m_stepCount = 0;
+	m_stepAllocationCheck = false;
 
 	m_allowSleep = true;
 	m_gravity = gravity;
@@ -58,7 +89,7 @@ b2World::b2World(const b2Vec2& gravity)
 
 	m_inv_dt0 = 0.0f;
 
-	m_contactManager.m_allocator = &m_blockAllocator;
+	m_contactManager.m_allocator = &m_contactAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
 }
@@ -76,12 +107,29 @@ b2World::~b2World()
 		{
 			b2Fixture* fNext = f->m_next;
 			f->m_proxyCount = 0;
-			f->Destroy(&m_blockAllocator);
+			DestroyUserData(f);
+			f->Destroy(&m_fixtureAllocator);
 			f = fNext;
 		}
 
+		DestroyUserData(b);
+		b->~b2Body();
 		b = bNext;
 	}
+
+	// Shared shapes that were never destroyed have no fixtures left.
+	b2SharedShape* s = m_sharedShapeList;
+	while (s)
+	{
+		b2SharedShape* sNext = s->m_next;
+		s->Destroy(&m_fixtureAllocator);
+		s = sNext;
+	}
+
+	m_allocator.Free(m_freeBodySlots, m_bodySlotCapacity * sizeof(int32), b2_generalMemory);
+	m_allocator.Free(m_bodyVelocities, m_bodySlotCapacity * sizeof(b2Velocity), b2_generalMemory);
+	m_allocator.Free(m_bodySweeps, m_bodySlotCapacity * sizeof(b2Sweep), b2_generalMemory);
+	m_allocator.Free(m_bodySlots, m_bodySlotCapacity * sizeof(b2Body*), b2_generalMemory);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -104,6 +152,169 @@ void b2World::SetDebugDraw(b2Draw* debugDraw)
 	m_debugDraw = debugDraw;
 }
 
+void b2World::SetTaskScheduler(b2TaskScheduler* scheduler)
+{
+	m_taskScheduler = scheduler;
+}
+
+int32 b2World::TrimMemory()
+{
+	b2Assert(IsLocked() == false);
+	int32 released = m_blockAllocator.Trim();
+	released += m_fixtureAllocator.Trim();
+	released += m_contactAllocator.Trim();
+	released += m_userDataAllocator.Trim();
+	return released;
+}
+
+void b2World::SetMemoryTrimThreshold(int32 bytes)
+{
+	m_blockAllocator.SetTrimThreshold(bytes);
+	m_fixtureAllocator.SetTrimThreshold(bytes);
+	m_contactAllocator.SetTrimThreshold(bytes);
+	m_userDataAllocator.SetTrimThreshold(bytes);
+}
+
+void b2World::ReserveStepMemory(int32 bytes)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_stackAllocator.Reserve(bytes);
+}
+
+void b2World::Reserve(const b2WorldCapacity& capacity)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	if (capacity.bodyCount > m_bodySlotCapacity)
+	{
+		GrowBodySlots(capacity.bodyCount);
+	}
+
+	m_blockAllocator.Reserve(sizeof(b2Body), capacity.bodyCount - m_bodyCount);
+	m_bodyHandles.Reserve(capacity.bodyCount);
+
+	// The common joint types are reserved at the size of the largest of them.
+	int32 jointSize = b2Max(sizeof(b2RevoluteJoint), b2Max(sizeof(b2PrismaticJoint), sizeof(b2WeldJoint)));
+	m_blockAllocator.Reserve(jointSize, capacity.jointCount - m_jointCount);
+	m_jointHandles.Reserve(capacity.jointCount);
+
+	int32 proxyCount = m_contactManager.m_broadPhase.GetProxyCount();
+	m_fixtureAllocator.Reserve(sizeof(b2Fixture), capacity.proxyCount - proxyCount);
+	m_fixtureAllocator.Reserve(sizeof(b2FixtureProxy), capacity.proxyCount - proxyCount);
+	m_fixtureHandles.Reserve(capacity.proxyCount);
+
+	m_contactAllocator.Reserve(sizeof(b2Contact), capacity.contactCount - m_contactManager.m_contactCount);
+	m_contactManager.Reserve(capacity.proxyCount, capacity.contactCount);
+	m_toiQueue.Reserve(capacity.contactCount);
+}
+
+void b2World::SetStepAllocationCheck(bool flag)
+{
+	m_stepAllocationCheck = flag;
+}
+
+b2BlockAllocatorStats b2World::GetBlockAllocatorStats(b2MemoryCategory category) const
+{
+	switch (category)
+	{
+	case b2_fixtureMemory:
+		return m_fixtureAllocator.GetStats();
+
+	case b2_contactMemory:
+		return m_contactAllocator.GetStats();
+
+	case b2_userDataMemory:
+		return m_userDataAllocator.GetStats();
+
+	default:
+		b2Assert(category == b2_generalMemory);
+		return m_blockAllocator.GetStats();
+	}
+}
+
+// Get a slot in the body storage. Growing the storage moves the state of all
+// bodies, so this must not happen during a time step.
+int32 b2World::AllocateBodySlot()
+{
+	if (m_freeBodySlotCount > 0)
+	{
+		--m_freeBodySlotCount;
+		return m_freeBodySlots[m_freeBodySlotCount];
+	}
+
+	if (m_bodySlotCount == m_bodySlotCapacity)
+	{
+		GrowBodySlots(b2Max(16, 2 * m_bodySlotCapacity));
+	}
+
+	m_bodySlots[m_bodySlotCount] = NULL;
+	++m_bodySlotCount;
+	return m_bodySlotCount - 1;
+}
+
+// Grow the body storage. This moves the state of all bodies.
+void b2World::GrowBodySlots(int32 capacity)
+{
+	b2Assert(capacity > m_bodySlotCapacity);
+
+	b2Body** oldSlots = m_bodySlots;
+	b2Sweep* oldSweeps = m_bodySweeps;
+	b2Velocity* oldVelocities = m_bodyVelocities;
+
+	m_bodySlots = (b2Body**)m_allocator.Allocate(capacity * sizeof(b2Body*), b2_generalMemory);
+	m_bodySweeps = (b2Sweep*)m_allocator.Allocate(capacity * sizeof(b2Sweep), b2_generalMemory);
+	m_bodyVelocities = (b2Velocity*)m_allocator.Allocate(capacity * sizeof(b2Velocity), b2_generalMemory);
+
+	if (m_bodySlotCount > 0)
+	{
+		memcpy(m_bodySlots, oldSlots, m_bodySlotCount * sizeof(b2Body*));
+		memcpy(m_bodySweeps, oldSweeps, m_bodySlotCount * sizeof(b2Sweep));
+		memcpy(m_bodyVelocities, oldVelocities, m_bodySlotCount * sizeof(b2Velocity));
+	}
+
+	m_allocator.Free(oldVelocities, m_bodySlotCapacity * sizeof(b2Velocity), b2_generalMemory);
+	m_allocator.Free(oldSweeps, m_bodySlotCapacity * sizeof(b2Sweep), b2_generalMemory);
+	m_allocator.Free(oldSlots, m_bodySlotCapacity * sizeof(b2Body*), b2_generalMemory);
+
+	int32* oldFreeSlots = m_freeBodySlots;
+	m_freeBodySlots = (int32*)m_allocator.Allocate(capacity * sizeof(int32), b2_generalMemory);
+	if (m_freeBodySlotCount > 0)
+	{
+		memcpy(m_freeBodySlots, oldFreeSlots, m_freeBodySlotCount * sizeof(int32));
+	}
+	m_allocator.Free(oldFreeSlots, m_bodySlotCapacity * sizeof(int32), b2_generalMemory);
+	m_bodySlotCapacity = capacity;
+
+	// Point the bodies at their new state. Free slots hold no body.
+	for (int32 i = 0; i < m_bodySlotCount; ++i)
+	{
+		b2Body* b = m_bodySlots[i];
+		if (b)
+		{
+			b->m_sweep = m_bodySweeps + i;
+			b->m_velocity = m_bodyVelocities + i;
+		}
+	}
+}
+
+void b2World::FreeBodySlot(int32 slot)
+{
+	b2Assert(0 <= slot && slot < m_bodySlotCount);
+	b2Assert(m_freeBodySlotCount < m_bodySlotCapacity);
+	m_bodySlots[slot] = NULL;
+	m_freeBodySlots[m_freeBodySlotCount] = slot;
+	++m_freeBodySlotCount;
+}
+
 b2Body* b2World::CreateBody(const b2BodyDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -112,8 +323,13 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 		return NULL;
 	}
 
+	int32 slot = AllocateBodySlot();
 	void* mem = m_blockAllocator.Allocate(sizeof(b2Body));
-	b2Body* b = new (mem) b2Body(def, this);
+	b2Body* b = new (mem) b2Body(def, this, slot);
+	m_bodySlots[slot] = b;
+
+	b->m_id.index = m_bodyHandles.Create(b);
+	b->m_id.generation = m_bodyHandles.GetGeneration(b->m_id.index);
 
 	// Add to world doubly linked list.
 	b->m_prev = NULL;
@@ -128,6 +344,147 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	return b;
 }
 
+void b2World::CreateBodies(const b2BodyDef* bodyDefs, int32 bodyCount,
+						   const b2FixtureDef* fixtureDefs, int32 fixtureCount, b2Body** bodies)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked() || bodyCount == 0)
+	{
+		return;
+	}
+
+	b2Body** created = bodies;
+	if (created == NULL)
+	{
+		created = (b2Body**)m_stackAllocator.Allocate(bodyCount * sizeof(b2Body*));
+	}
+
+	bool hasDensity = false;
+	for (int32 i = 0; i < fixtureCount; ++i)
+	{
+		hasDensity = hasDensity || fixtureDefs[i].density > 0.0f;
+	}
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = CreateBody(bodyDefs + i);
+		for (int32 j = 0; j < fixtureCount; ++j)
+		{
+			b->AddFixture(fixtureDefs + j);
+		}
+
+		if (hasDensity)
+		{
+			b->ResetMassData();
+		}
+
+		created[i] = b;
+	}
+
+	if (fixtureCount > 0)
+	{
+		CreateFixtureProxies(created, bodyCount);
+
+		for (int32 i = 0; i < bodyCount; ++i)
+		{
+			created[i]->ResetCompoundProxy();
+		}
+
+		m_flags |= e_newFixture;
+	}
+
+	if (bodies == NULL)
+	{
+		m_stackAllocator.Free(created);
+	}
+}
+
+void b2World::CreateFixtureProxies(b2Body* const* bodies, int32 bodyCount)
+{
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+
+	// Compound bodies keep their proxies in their own tree. Count the rest.
+	int32 proxyCount = 0;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+		if ((b->m_flags & b2Body::e_activeFlag) == 0)
+		{
+			continue;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			if (f->m_proxyCount > 0)
+			{
+				continue;
+			}
+
+			if (b->m_compoundTree)
+			{
+				f->CreateProxies(broadPhase, b->m_xf);
+			}
+			else
+			{
+				proxyCount += f->m_shape->GetChildCount();
+			}
+		}
+	}
+
+	if (proxyCount == 0)
+	{
+		return;
+	}
+
+	b2AABB* aabbs = (b2AABB*)m_stackAllocator.Allocate(proxyCount * sizeof(b2AABB));
+	void** userData = (void**)m_stackAllocator.Allocate(proxyCount * sizeof(void*));
+	int32* proxyIds = (int32*)m_stackAllocator.Allocate(proxyCount * sizeof(int32));
+
+	int32 count = 0;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+		if ((b->m_flags & b2Body::e_activeFlag) == 0 || b->m_compoundTree)
+		{
+			continue;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			if (f->m_proxyCount > 0)
+			{
+				continue;
+			}
+
+			f->m_proxyCount = f->m_shape->GetChildCount();
+
+			for (int32 k = 0; k < f->m_proxyCount; ++k)
+			{
+				b2FixtureProxy* proxy = f->m_proxies + k;
+				f->m_shape->ComputeAABB(&proxy->aabb, b->m_xf, k);
+				proxy->fixture = f;
+				proxy->body = b;
+				proxy->childIndex = k;
+
+				aabbs[count] = proxy->aabb;
+				userData[count] = proxy;
+				++count;
+			}
+		}
+	}
+
+	broadPhase->CreateProxies(aabbs, userData, count, proxyIds);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		((b2FixtureProxy*)userData[i])->proxyId = proxyIds[i];
+	}
+
+	m_stackAllocator.Free(proxyIds);
+	m_stackAllocator.Free(userData);
+	m_stackAllocator.Free(aabbs);
+}
+
 void b2World::DestroyBody(b2Body* b)
 {
 	b2Assert(m_bodyCount > 0);
@@ -178,9 +535,11 @@ void b2World::DestroyBody(b2Body* b)
 		}
 
 		f0->DestroyProxies(&m_contactManager.m_broadPhase);
-		f0->Destroy(&m_blockAllocator);
+		m_fixtureHandles.Destroy(f0->m_id.index);
+		DestroyUserData(f0);
+		f0->Destroy(&m_fixtureAllocator);
 		f0->~b2Fixture();
-		m_blockAllocator.Free(f0, sizeof(b2Fixture));
+		m_fixtureAllocator.Free(f0, sizeof(b2Fixture));
 
 		b->m_fixtureList = f;
 		b->m_fixtureCount -= 1;
@@ -188,6 +547,9 @@ void b2World::DestroyBody(b2Body* b)
 	b->m_fixtureList = NULL;
 	b->m_fixtureCount = 0;
 
+	// Destroy the proxy of a compound body.
+	b->ResetCompoundProxy();
+
 	// Remove world body list.
 	if (b->m_prev)
 	{
@@ -205,6 +567,9 @@ void b2World::DestroyBody(b2Body* b)
 	}
 
 	--m_bodyCount;
+	FreeBodySlot(b->m_slot);
+	m_bodyHandles.Destroy(b->m_id.index);
+	DestroyUserData(b);
 	b->~b2Body();
 	m_blockAllocator.Free(b, sizeof(b2Body));
 }
@@ -218,6 +583,8 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 	}
 
 	b2Joint* j = b2Joint::Create(def, &m_blockAllocator);
+	j->m_id.index = m_jointHandles.Create(j);
+	j->m_id.generation = m_jointHandles.GetGeneration(j->m_id.index);
 
 	// Connect to the world list.
 	j->m_prev = NULL;
@@ -341,6 +708,7 @@ void b2World::DestroyJoint(b2Joint* j)
 	j->m_edgeB.prev = NULL;
 	j->m_edgeB.next = NULL;
 
+	m_jointHandles.Destroy(j->m_id.index);
 	b2Joint::Destroy(j, &m_blockAllocator);
 
 	b2Assert(m_jointCount > 0);
@@ -364,6 +732,137 @@ void b2World::DestroyJoint(b2Joint* j)
 	}
 }
 
+b2SharedShape* b2World::CreateSharedShape(const b2Shape* shape)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return NULL;
+	}
+
+	void* mem = m_fixtureAllocator.Allocate(sizeof(b2SharedShape));
+	b2SharedShape* s = new (mem) b2SharedShape;
+	s->Create(&m_fixtureAllocator, shape);
+
+	// Add to the world shared shape list.
+	s->m_prev = NULL;
+	s->m_next = m_sharedShapeList;
+	if (m_sharedShapeList)
+	{
+		m_sharedShapeList->m_prev = s;
+	}
+	m_sharedShapeList = s;
+
+	return s;
+}
+
+void b2World::DestroySharedShape(b2SharedShape* s)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	b2Assert(s->m_destroyed == false);
+
+	// Remove from the world shared shape list.
+	if (s->m_prev)
+	{
+		s->m_prev->m_next = s->m_next;
+	}
+
+	if (s->m_next)
+	{
+		s->m_next->m_prev = s->m_prev;
+	}
+
+	if (s == m_sharedShapeList)
+	{
+		m_sharedShapeList = s->m_next;
+	}
+
+	s->m_prev = NULL;
+	s->m_next = NULL;
+	s->m_destroyed = true;
+
+	// The last fixture frees a shape that is still in use.
+	if (s->m_refCount == 0)
+	{
+		s->Destroy(&m_fixtureAllocator);
+		m_fixtureAllocator.Free(s, sizeof(b2SharedShape));
+	}
+}
+
+// World-owned user data is preceded by a header that tells how to destroy it.
+struct b2UserDataHeader
+{
+	b2UserDataDestructor destructor;
+	int32 size;
+};
+
+// The header size keeps the user data aligned like b2Alloc.
+const int32 b2_userDataHeaderSize = 16;
+
+void* b2World::AllocateUserData(int32 size, b2UserDataDestructor destructor)
+{
+	b2Assert(sizeof(b2UserDataHeader) <= b2_userDataHeaderSize);
+	b2Assert(size >= 0);
+
+	uint8* mem = (uint8*)m_userDataAllocator.Allocate(b2_userDataHeaderSize + size);
+	b2UserDataHeader* header = (b2UserDataHeader*)mem;
+	header->destructor = destructor;
+	header->size = size;
+	return mem + b2_userDataHeaderSize;
+}
+
+void b2World::FreeUserData(void* data)
+{
+	uint8* mem = (uint8*)data - b2_userDataHeaderSize;
+	b2UserDataHeader* header = (b2UserDataHeader*)mem;
+	if (header->destructor)
+	{
+		header->destructor(data);
+	}
+	m_userDataAllocator.Free(mem, b2_userDataHeaderSize + header->size);
+}
+
+void* b2World::CreateUserData(b2Body* body, int32 size, b2UserDataDestructor destructor)
+{
+	DestroyUserData(body);
+	body->m_userData = AllocateUserData(size, destructor);
+	body->m_flags |= b2Body::e_userDataFlag;
+	return body->m_userData;
+}
+
+void* b2World::CreateUserData(b2Fixture* fixture, int32 size, b2UserDataDestructor destructor)
+{
+	DestroyUserData(fixture);
+	fixture->m_userData = AllocateUserData(size, destructor);
+	fixture->m_ownsUserData = true;
+	return fixture->m_userData;
+}
+
+void b2World::DestroyUserData(b2Body* body)
+{
+	if (body->m_flags & b2Body::e_userDataFlag)
+	{
+		FreeUserData(body->m_userData);
+		body->m_userData = NULL;
+		body->m_flags &= ~b2Body::e_userDataFlag;
+	}
+}
+
+void b2World::DestroyUserData(b2Fixture* fixture)
+{
+	if (fixture->m_ownsUserData)
+	{
+		FreeUserData(fixture->m_userData);
+		fixture->m_userData = NULL;
+		fixture->m_ownsUserData = false;
+	}
+}
+
 //
 void b2World::SetAllowSleeping(bool flag)
 {
@@ -388,18 +887,29 @@ void b2World::Solve(const b2TimeStep& step)
 	m_profile.solveInit = 0.0f;
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
+	m_profile.islandCount = 0;
+	m_profile.velocityIterations = 0;
+	m_profile.maxVelocityIterations = 0;
+	memset(m_profile.iterationHistogram, 0, sizeof(m_profile.iterationHistogram));
 
 	// Size the island for the worst case.
 	b2Island island(m_bodyCount,
 					m_contactManager.m_contactCount,
 					m_jointCount,
 					&m_stackAllocator,
-					m_contactManager.m_contactListener);
+					m_contactManager.m_contactListener,
+					m_bodySweeps,
+					m_bodyVelocities,
+					m_bodySlotCount);
 
 	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	for (int32 i = 0; i < m_bodySlotCount; ++i)
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		b2Body* b = m_bodySlots[i];
+		if (b != NULL)
+		{
+			b->m_flags &= ~b2Body::e_islandFlag;
+		}
 	}
 	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
 	{
@@ -413,9 +923,14 @@ void b2World::Solve(const b2TimeStep& step)
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+
+	// Seed the islands by descending slot. This matches the order of the body
+	// list only while no body has been destroyed, since CreateBody reuses the
+	// slots that DestroyBody frees.
+	for (int32 slot = m_bodySlotCount - 1; slot >= 0; --slot)
 	{
-		if (seed->m_flags & b2Body::e_islandFlag)
+		b2Body* seed = m_bodySlots[slot];
+		if (seed == NULL || (seed->m_flags & b2Body::e_islandFlag))
 		{
 			continue;
 		}
@@ -466,9 +981,9 @@ void b2World::Solve(const b2TimeStep& step)
 					continue;
 				}
 
-				// Is this contact solid and touching?
+				// Is this contact solid and touching, or about to touch?
 				if (contact->IsEnabled() == false ||
-					contact->IsTouching() == false)
+					(contact->m_flags & (b2Contact::e_touchingFlag | b2Contact::e_speculativeFlag)) == 0)
 				{
 					continue;
 				}
@@ -532,6 +1047,11 @@ void b2World::Solve(const b2TimeStep& step)
 		m_profile.solveInit += profile.solveInit;
 		m_profile.solveVelocity += profile.solveVelocity;
 		m_profile.solvePosition += profile.solvePosition;
+		m_profile.islandCount += 1;
+		m_profile.velocityIterations += profile.velocityIterations;
+		m_profile.maxVelocityIterations = b2Max(m_profile.maxVelocityIterations, profile.velocityIterations);
+		int32 bucket = b2Clamp(profile.velocityIterations - 1, 0, b2_iterationHistogramSize - 1);
+		m_profile.iterationHistogram[bucket] += 1;
 
 		// Post solve cleanup.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -550,10 +1070,11 @@ void b2World::Solve(const b2TimeStep& step)
 	{
 		b2Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		for (int32 slot = m_bodySlotCount - 1; slot >= 0; --slot)
 		{
 			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			b2Body* b = m_bodySlots[slot];
+			if (b == NULL || (b->m_flags & b2Body::e_islandFlag) == 0)
 			{
 				continue;
 			}
@@ -573,145 +1094,317 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 }
 
-// Find TOI contacts and solve them.
-void b2World::SolveTOI(const b2TimeStep& step)
+// Can a shape moving along the remaining sweep pass through thin geometry? This
+// compares a bound on the motion of any point of the shape with half of its
+// thickness. Below that the contact is still found at the end of the step and
+// pushed out to the correct side.
+static bool b2CanTunnel(const b2DistanceProxy& proxy, const b2Sweep& sweep)
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	float32 translation = b2Distance(sweep.c0, sweep.c);
+	float32 rotation = b2Abs(sweep.a - sweep.a0);
+	if (translation == 0.0f && rotation == 0.0f)
+	{
+		return false;
+	}
 
-	if (m_stepComplete)
+	b2Vec2 centroid = b2Vec2_zero;
+	float32 maxExtent = 0.0f;
+	for (int32 i = 0; i < proxy.m_count; ++i)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		centroid += proxy.m_vertices[i];
+		maxExtent = b2Max(maxExtent, b2Distance(proxy.m_vertices[i], sweep.localCenter));
+	}
+	maxExtent += proxy.m_radius;
+
+	float32 motion = translation + rotation * maxExtent;
+
+	// The thickness is the radius plus the inradius of the core polygon.
+	float32 minExtent = proxy.m_radius;
+	if (proxy.m_count >= 3)
+	{
+		centroid *= 1.0f / proxy.m_count;
+
+		float32 inradius = b2_maxFloat;
+		for (int32 i = 0; i < proxy.m_count; ++i)
 		{
-			b->m_flags &= ~b2Body::e_islandFlag;
-			b->m_sweep.alpha0 = 0.0f;
+			b2Vec2 v1 = proxy.m_vertices[i];
+			b2Vec2 v2 = proxy.m_vertices[i + 1 < proxy.m_count ? i + 1 : 0];
+			b2Vec2 e = v2 - v1;
+			float32 length = e.Length();
+			if (length > b2_epsilon)
+			{
+				inradius = b2Min(inradius, b2Abs(b2Cross(e, centroid - v1)) / length);
+			}
 		}
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		if (inradius < b2_maxFloat)
 		{
-			// Invalidate TOI
-			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
-			c->m_toiCount = 0;
-			c->m_toi = 1.0f;
+			minExtent += inradius;
 		}
 	}
 
-	// Find TOI events and solve them.
-	for (;;)
+	return motion > 0.5f * minExtent;
+}
+
+// A contact whose time of impact is computed as part of a batch. The input holds
+// distance proxies that may point into their own buffers, so candidates are
+// built in place and never copied.
+struct b2TOICandidate
+{
+	b2Contact* contact;
+	b2TOIInput input;
+	b2TOIOutput output;
+	float32 alpha0;
+};
+
+// Finds the time of impact of a range of candidates. Every candidate only reads
+// its own input and the shapes, so ranges may run on different threads.
+class b2TOITask : public b2Task
+{
+public:
+	b2TOITask(b2TOICandidate* candidates)
 	{
-		// Find the first TOI.
-		b2Contact* minContact = NULL;
-		float32 minAlpha = 1.0f;
+		m_candidates = candidates;
+	}
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	void Execute(int32 begin, int32 end)
+	{
+		for (int32 i = begin; i < end; ++i)
 		{
-			// Is this contact disabled?
-			if (c->IsEnabled() == false)
-			{
-				continue;
-			}
+			b2TimeOfImpact(&m_candidates[i].output, &m_candidates[i].input);
+		}
+	}
 
-			// Prevent excessive sub-stepping.
-			if (c->m_toiCount > b2_maxSubSteps)
-			{
-				continue;
-			}
+	b2TOICandidate* m_candidates;
+};
 
-			float32 alpha = 1.0f;
-			if (c->m_flags & b2Contact::e_toiFlag)
-			{
-				// This contact has a valid cached TOI.
-				alpha = c->m_toi;
-			}
-			else
-			{
-				b2Fixture* fA = c->GetFixtureA();
-				b2Fixture* fB = c->GetFixtureB();
+// Set up the time of impact query of a contact. Returns false if the contact is
+// not a TOI candidate, in which case its TOI is 1. Otherwise the contact is
+// marked as cached and the caller must run the query and store the result. The
+// bodies are left untouched so that candidates can be prepared in any order.
+bool b2World::PrepareTOI(b2TOICandidate* candidate)
+{
+	b2Contact* c = candidate->contact;
+	b2Fixture* fA = c->GetFixtureA();
+	b2Fixture* fB = c->GetFixtureB();
 
-				// Is there a sensor?
-				if (fA->IsSensor() || fB->IsSensor())
-				{
-					continue;
-				}
+	// Is there a sensor?
+	if (fA->IsSensor() || fB->IsSensor())
+	{
+		return false;
+	}
 
-				b2Body* bA = fA->GetBody();
-				b2Body* bB = fB->GetBody();
+	b2Body* bA = fA->GetBody();
+	b2Body* bB = fB->GetBody();
 
-				b2BodyType typeA = bA->m_type;
-				b2BodyType typeB = bB->m_type;
-				b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
+	b2BodyType typeA = bA->m_type;
+	b2BodyType typeB = bB->m_type;
+	b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
 
-				bool activeA = bA->IsAwake() && typeA != b2_staticBody;
-				bool activeB = bB->IsAwake() && typeB != b2_staticBody;
+	bool activeA = bA->IsAwake() && typeA != b2_staticBody;
+	bool activeB = bB->IsAwake() && typeB != b2_staticBody;
 
-				// Is at least one body active (awake and dynamic or kinematic)?
-				if (activeA == false && activeB == false)
-				{
-					continue;
-				}
+	// Is at least one body active (awake and dynamic or kinematic)?
+	if (activeA == false && activeB == false)
+	{
+		return false;
+	}
 
-				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
-				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
+	bool collideA = bA->IsBullet() || fA->m_continuous == b2_continuousAlways || typeA != b2_dynamicBody;
+	bool collideB = bB->IsBullet() || fB->m_continuous == b2_continuousAlways || typeB != b2_dynamicBody;
 
-				// Are these two non-bullet dynamic bodies?
-				if (collideA == false && collideB == false)
-				{
-					continue;
-				}
+	// Are these two non-bullet dynamic bodies?
+	if (collideA == false && collideB == false)
+	{
+		return false;
+	}
 
-				// Compute the TOI for this contact.
-				// Put the sweeps onto the same time interval.
-				float32 alpha0 = bA->m_sweep.alpha0;
+	// Did one of the fixtures opt out?
+	if (fA->m_continuous == b2_continuousNever || fB->m_continuous == b2_continuousNever)
+	{
+		++m_profile.toiSkipped;
+		c->m_toi = 1.0f;
+		c->m_flags |= b2Contact::e_toiFlag;
+		return false;
+	}
 
-				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
-				{
-					alpha0 = bB->m_sweep.alpha0;
-					bA->m_sweep.Advance(alpha0);
-				}
-				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
-				{
-					alpha0 = bA->m_sweep.alpha0;
-					bB->m_sweep.Advance(alpha0);
-				}
+	// Put the sweeps onto the same time interval.
+	float32 alpha0 = b2Max(bA->m_sweep->alpha0, bB->m_sweep->alpha0);
+	b2Assert(alpha0 < 1.0f);
 
-				b2Assert(alpha0 < 1.0f);
+	b2TOIInput& input = candidate->input;
+	input.proxyA.Set(fA->m_shape, c->GetChildIndexA());
+	input.proxyB.Set(fB->m_shape, c->GetChildIndexB());
+	input.sweepA = *bA->m_sweep;
+	input.sweepB = *bB->m_sweep;
+	input.tMax = 1.0f;
 
-				int32 indexA = c->GetChildIndexA();
-				int32 indexB = c->GetChildIndexB();
+	if (input.sweepA.alpha0 < alpha0)
+	{
+		input.sweepA.Advance(alpha0);
+	}
 
-				// Compute the time of impact in interval [0, minTOI]
-				b2TOIInput input;
-				input.proxyA.Set(fA->GetShape(), indexA);
-				input.proxyB.Set(fB->GetShape(), indexB);
-				input.sweepA = bA->m_sweep;
-				input.sweepB = bB->m_sweep;
-				input.tMax = 1.0f;
+	if (input.sweepB.alpha0 < alpha0)
+	{
+		input.sweepB.Advance(alpha0);
+	}
 
-				b2TOIOutput output;
-				b2TimeOfImpact(&output, &input);
+	// The discrete solver handles shapes that cannot tunnel.
+	if (b2CanTunnel(input.proxyA, input.sweepA) == false && b2CanTunnel(input.proxyB, input.sweepB) == false)
+	{
+		++m_profile.toiSkipped;
+		c->m_toi = 1.0f;
+		c->m_flags |= b2Contact::e_toiFlag;
+		return false;
+	}
 
-				// Beta is the fraction of the remaining portion of the .
-				float32 beta = output.t;
-				if (output.state == b2TOIOutput::e_touching)
-				{
-					alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
-				}
-				else
-				{
-					alpha = 1.0f;
-				}
+	++m_profile.toiComputed;
+
+	candidate->alpha0 = alpha0;
+	c->m_toi = 1.0f;
+	c->m_flags |= b2Contact::e_toiFlag;
+	return true;
+}
 
-				c->m_toi = alpha;
-				c->m_flags |= b2Contact::e_toiFlag;
+// Compute the time of impact of the given contacts and update the TOI queue.
+// A contact may be listed more than once. The queries run on the task scheduler
+// when there is one. The queue only depends on the results, so the outcome does
+// not depend on the scheduler.
+void b2World::UpdateTOIs(b2Contact** contacts, int32 count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	b2TOICandidate* candidates = (b2TOICandidate*)m_stackAllocator.Allocate(count * sizeof(b2TOICandidate));
+	int32 candidateCount = 0;
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Contact* c = contacts[i];
+
+		// Is this contact disabled? Prevent excessive sub-stepping.
+		if (c->IsEnabled() == false || c->m_toiCount > b2_maxSubSteps)
+		{
+			m_toiQueue.Remove(c);
+			continue;
+		}
+
+		if (c->m_flags & b2Contact::e_toiFlag)
+		{
+			// This contact has a valid cached TOI or is already in this batch.
+			if (c->m_toi < 1.0f)
+			{
+				m_toiQueue.Update(c);
 			}
+			continue;
+		}
+
+		b2TOICandidate* candidate = candidates + candidateCount;
+		candidate->contact = c;
+		if (PrepareTOI(candidate))
+		{
+			++candidateCount;
+		}
+		else
+		{
+			m_toiQueue.Remove(c);
+		}
+	}
+
+	b2TOITask task(candidates);
+	if (m_taskScheduler && candidateCount > 1)
+	{
+		m_taskScheduler->ParallelFor(&task, candidateCount);
+	}
+	else
+	{
+		task.Execute(0, candidateCount);
+	}
+
+	for (int32 i = 0; i < candidateCount; ++i)
+	{
+		b2TOICandidate* candidate = candidates + i;
+		b2Contact* c = candidate->contact;
+
+		// Beta is the fraction of the remaining portion of the step.
+		float32 alpha = 1.0f;
+		if (candidate->output.state == b2TOIOutput::e_touching)
+		{
+			float32 alpha0 = candidate->alpha0;
+			alpha = b2Min(alpha0 + (1.0f - alpha0) * candidate->output.t, 1.0f);
+		}
+
+		c->m_toi = alpha;
+
+		if (alpha < 1.0f)
+		{
+			m_toiQueue.Update(c);
+		}
+		else
+		{
+			m_toiQueue.Remove(c);
+		}
+	}
+
+	m_stackAllocator.Free(candidates);
+}
+
+// Find TOI contacts and solve them.
+void b2World::SolveTOI(const b2TimeStep& step)
+{
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener,
+					m_bodySweeps, m_bodyVelocities, m_bodySlotCount);
 
-			if (alpha < minAlpha)
+	if (m_stepComplete)
+	{
+		for (int32 i = 0; i < m_bodySlotCount; ++i)
+		{
+			b2Body* b = m_bodySlots[i];
+			if (b != NULL)
 			{
-				// This is the minimum TOI found so far.
-				minContact = c;
-				minAlpha = alpha;
+				b->m_flags &= ~b2Body::e_islandFlag;
+				b->m_sweep->alpha0 = 0.0f;
 			}
 		}
 
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		{
+			// Invalidate TOI
+			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+			c->m_toiCount = 0;
+			c->m_toi = 1.0f;
+		}
+	}
+
+	// Compute the TOI candidates once. After each event only the contacts of
+	// the displaced bodies are evaluated again.
+	m_toiQueue.m_operationCount = 0;
+
+	b2Contact** contacts = (b2Contact**)m_stackAllocator.Allocate(b2Max(m_contactManager.m_contactCount, 1) * sizeof(b2Contact*));
+	int32 contactCount = 0;
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		contacts[contactCount++] = c;
+	}
+
+	UpdateTOIs(contacts, contactCount);
+	m_stackAllocator.Free(contacts);
+
+	// Solve the TOI events in order.
+	for (;;)
+	{
+		// Find the first TOI.
+		b2Contact* minContact = NULL;
+		float32 minAlpha = 1.0f;
+
+		if (m_toiQueue.GetCount() > 0)
+		{
+			minContact = m_toiQueue.GetMin();
+			minAlpha = minContact->m_toi;
+		}
+
 		if (minContact == NULL || 1.0f - 10.0f * b2_epsilon < minAlpha)
 		{
 			// No more TOI events. Done!
@@ -725,8 +1418,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		b2Body* bA = fA->GetBody();
 		b2Body* bB = fB->GetBody();
 
-		b2Sweep backup1 = bA->m_sweep;
-		b2Sweep backup2 = bB->m_sweep;
+		b2Sweep backup1 = *bA->m_sweep;
+		b2Sweep backup2 = *bB->m_sweep;
 
 		bA->Advance(minAlpha);
 		bB->Advance(minAlpha);
@@ -736,13 +1429,16 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
+		m_toiQueue.Remove(minContact);
+		++m_profile.toiEvents;
+
 		// Is the contact solid?
 		if (minContact->IsEnabled() == false || minContact->IsTouching() == false)
 		{
 			// Restore the sweeps.
 			minContact->SetEnabled(false);
-			bA->m_sweep = backup1;
-			bB->m_sweep = backup2;
+			*bA->m_sweep = backup1;
+			*bB->m_sweep = backup2;
 			bA->SynchronizeTransform();
 			bB->SynchronizeTransform();
 			continue;
@@ -788,10 +1484,13 @@ void b2World::SolveTOI(const b2TimeStep& step)
 						continue;
 					}
 
-					// Only add static, kinematic, or bullet bodies.
+					// Only add static, kinematic, or bullet bodies, or bodies
+					// that a fixture wants continuous collision against.
 					b2Body* other = ce->other;
 					if (other->m_type == b2_dynamicBody &&
-						body->IsBullet() == false && other->IsBullet() == false)
+						body->IsBullet() == false && other->IsBullet() == false &&
+						contact->m_fixtureA->m_continuous != b2_continuousAlways &&
+						contact->m_fixtureB->m_continuous != b2_continuousAlways)
 					{
 						continue;
 					}
@@ -805,7 +1504,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					}
 
 					// Tentatively advance the body to the TOI.
-					b2Sweep backup = other->m_sweep;
+					b2Sweep backup = *other->m_sweep;
 					if ((other->m_flags & b2Body::e_islandFlag) == 0)
 					{
 						other->Advance(minAlpha);
@@ -817,7 +1516,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
 					{
-						other->m_sweep = backup;
+						*other->m_sweep = backup;
 						other->SynchronizeTransform();
 						continue;
 					}
@@ -825,7 +1524,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					// Are there contact points?
 					if (contact->IsTouching() == false)
 					{
-						other->m_sweep = backup;
+						*other->m_sweep = backup;
 						other->SynchronizeTransform();
 						continue;
 					}
@@ -858,9 +1557,14 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.inv_dt = 1.0f / subStep.dt;
 		subStep.dtRatio = 1.0f;
 		subStep.positionIterations = 20;
+		subStep.minVelocityIterations = step.velocityIterations;
 		subStep.velocityIterations = step.velocityIterations;
+		subStep.substepCount = 0;
 		subStep.warmStarting = false;
-		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
+		subStep.directJointSolver = false;
+		subStep.integrateRotation = false;
+		subStep.syncRotation = false;
+		island.SolveTOI(subStep, bA->m_slot, bB->m_slot);
 
 		// Reset island flags and synchronize broad-phase proxies.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -891,12 +1595,73 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			m_stepComplete = false;
 			break;
 		}
+
+		// Evaluate the invalidated contacts of the island again. This also
+		// picks up the contacts that were just created.
+		int32 invalidCount = 0;
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* body = island.m_bodies[i];
+			if (body->m_type == b2_staticBody)
+			{
+				continue;
+			}
+
+			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+			{
+				// Is the cached TOI still valid? Then the queue is up to date.
+				if ((ce->contact->m_flags & b2Contact::e_toiFlag) == 0)
+				{
+					++invalidCount;
+				}
+			}
+		}
+
+		b2Contact** invalid = (b2Contact**)m_stackAllocator.Allocate(b2Max(invalidCount, 1) * sizeof(b2Contact*));
+		invalidCount = 0;
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* body = island.m_bodies[i];
+			if (body->m_type == b2_staticBody)
+			{
+				continue;
+			}
+
+			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+			{
+				if ((ce->contact->m_flags & b2Contact::e_toiFlag) == 0)
+				{
+					invalid[invalidCount++] = ce->contact;
+				}
+			}
+		}
+
+		UpdateTOIs(invalid, invalidCount);
+		m_stackAllocator.Free(invalid);
 	}
+
+	m_profile.toiQueueOperations = m_toiQueue.m_operationCount;
+	m_toiQueue.Clear();
 }
 
 void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations)
 {
+	Step(dt, velocityIterations, velocityIterations, positionIterations);
+}
+
+void b2World::Step(float32 dt, int32 minVelocityIterations, int32 maxVelocityIterations, int32 positionIterations)
+{
+	b2Assert(0 <= minVelocityIterations && minVelocityIterations <= maxVelocityIterations);
+
 	b2Timer stepTimer;
+	int32 allocationCount = m_allocator.GetStats().allocationCount;
+	int32 fallbackCount = m_stackAllocator.GetFallbackCount();
+
+	// The TOI counters stay zero when the TOI pass does not run.
+	m_profile.toiEvents = 0;
+	m_profile.toiComputed = 0;
+	m_profile.toiSkipped = 0;
+	m_profile.toiQueueOperations = 0;
 
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & e_newFixture)
@@ -909,8 +1674,10 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 
 	b2TimeStep step;
 	step.dt = dt;
-	step.velocityIterations	= velocityIterations;
+	step.minVelocityIterations = minVelocityIterations;
+	step.velocityIterations	= maxVelocityIterations;
 	step.positionIterations = positionIterations;
+	step.substepCount = m_substepCount;
 	if (dt > 0.0f)
 	{
 		step.inv_dt = 1.0f / dt;
@@ -923,7 +1690,40 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.directJointSolver = m_directJointSolver;
+	step.integrateRotation = m_rotationIntegration;
+	step.syncRotation = m_stepCount % b2_rotationSyncInterval == 0;
+	++m_stepCount;
 	
+	// Speculative contacts look ahead over this step. The proxies are extended
+	// over the coming motion first, so that the contacts exist before the shapes
+	// get there. Velocities may have changed since the last step.
+	bool speculative = m_continuousPhysics && m_speculativeContacts;
+	m_contactManager.m_speculativeTime = speculative ? dt : 0.0f;
+	if (speculative && dt > 0.0f)
+	{
+		for (int32 slot = m_bodySlotCount - 1; slot >= 0; --slot)
+		{
+			b2Body* b = m_bodySlots[slot];
+			if (b == NULL || b->IsAwake() == false || b->m_type == b2_staticBody)
+			{
+				continue;
+			}
+
+			if (b->m_velocity->v.x == 0.0f && b->m_velocity->v.y == 0.0f && b->m_velocity->w == 0.0f)
+			{
+				continue;
+			}
+
+			b2Transform xf2;
+			xf2.q.Set(b->m_sweep->a + dt * b->m_velocity->w);
+			xf2.p = b->m_sweep->c + dt * b->m_velocity->v - b2Mul(xf2.q, b->m_sweep->localCenter);
+			b->SynchronizeFixtures(b->m_xf, xf2);
+		}
+
+		m_contactManager.FindNewContacts();
+	}
+
 	// Update contacts. This is where some contacts are destroyed.
 	{
 		b2Timer timer;
@@ -940,7 +1740,7 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	}
 
 	// Handle TOI events.
-	if (m_continuousPhysics && step.dt > 0.0f)
+	if (m_continuousPhysics && speculative == false && step.dt > 0.0f)
 	{
 		b2Timer timer;
 		SolveTOI(step);
@@ -957,30 +1757,76 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 		ClearForces();
 	}
 
+	// Trim once per step rather than in the middle of the solver.
+	m_blockAllocator.AutoTrim();
+	m_fixtureAllocator.AutoTrim();
+	m_contactAllocator.AutoTrim();
+	m_userDataAllocator.AutoTrim();
+
 	m_flags &= ~e_locked;
 
 	m_profile.step = stepTimer.GetMilliseconds();
+	m_profile.allocations = m_allocator.GetStats().allocationCount - allocationCount;
+	m_profile.stackMaxAllocation = m_stackAllocator.GetMaxAllocation();
+	m_profile.stackFallbacks = m_stackAllocator.GetFallbackCount() - fallbackCount;
+
+	// A warmed up world steps without touching the heap.
+	b2Assert(m_stepAllocationCheck == false || m_profile.allocations == 0);
 }
 
 void b2World::ClearForces()
 {
-	for (b2Body* body = m_bodyList; body; body = body->GetNext())
+	for (int32 i = 0; i < m_bodySlotCount; ++i)
 	{
-		body->m_force.SetZero();
-		body->m_torque = 0.0f;
+		b2Body* body = m_bodySlots[i];
+		if (body != NULL)
+		{
+			body->m_force.SetZero();
+			body->m_torque = 0.0f;
+		}
 	}
 }
 
+// Reports the fixtures in the body-space tree of a compound body.
+struct b2WorldTreeQueryWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)tree->GetUserData(proxyId);
+		proceed = callback->ReportFixture(proxy->fixture);
+		return proceed;
+	}
+
+	const b2DynamicTree* tree;
+	b2QueryCallback* callback;
+	bool proceed;
+};
+
 struct b2WorldQueryWrapper
 {
 	bool QueryCallback(int32 proxyId)
 	{
 		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		if (proxy->fixture == NULL)
+		{
+			b2Body* body = proxy->body;
+			b2AABB localAABB;
+			b2InvTransformAABB(&localAABB, body->m_xf, aabb);
+
+			b2WorldTreeQueryWrapper wrapper;
+			wrapper.tree = body->m_compoundTree;
+			wrapper.callback = callback;
+			wrapper.proceed = true;
+			body->m_compoundTree->Query(&wrapper, localAABB);
+			return wrapper.proceed;
+		}
+
 		return callback->ReportFixture(proxy->fixture);
 	}
 
 	const b2BroadPhase* broadPhase;
 	b2QueryCallback* callback;
+	b2AABB aabb;
 };
 
 void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
@@ -988,15 +1834,52 @@ void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
 	b2WorldQueryWrapper wrapper;
 	wrapper.broadPhase = &m_contactManager.m_broadPhase;
 	wrapper.callback = callback;
+	wrapper.aabb = aabb;
 	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
 }
 
+struct b2WorldRayCastWrapper;
+
+// Ray casts the body-space tree of a compound body. The fixtures are still
+// ray cast in world space so the reported fractions match the world ray.
+struct b2WorldTreeRayCastWrapper
+{
+	float32 RayCastCallback(const b2RayCastInput& localInput, int32 proxyId);
+
+	const b2DynamicTree* tree;
+	b2WorldRayCastWrapper* wrapper;
+	b2RayCastInput input;
+	float32 fraction;
+};
+
 struct b2WorldRayCastWrapper
 {
 	float32 RayCastCallback(const b2RayCastInput& input, int32 proxyId)
 	{
 		void* userData = broadPhase->GetUserData(proxyId);
 		b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
+		if (proxy->fixture == NULL)
+		{
+			b2Body* body = proxy->body;
+			b2RayCastInput localInput;
+			localInput.p1 = b2MulT(body->m_xf, input.p1);
+			localInput.p2 = b2MulT(body->m_xf, input.p2);
+			localInput.maxFraction = input.maxFraction;
+
+			b2WorldTreeRayCastWrapper wrapper;
+			wrapper.tree = body->m_compoundTree;
+			wrapper.wrapper = this;
+			wrapper.input = input;
+			wrapper.fraction = input.maxFraction;
+			body->m_compoundTree->RayCast(&wrapper, localInput);
+			return wrapper.fraction;
+		}
+
+		return ReportProxy(input, proxy);
+	}
+
+	float32 ReportProxy(const b2RayCastInput& input, b2FixtureProxy* proxy)
+	{
 		b2Fixture* fixture = proxy->fixture;
 		int32 index = proxy->childIndex;
 		b2RayCastOutput output;
@@ -1016,6 +1899,21 @@ struct b2WorldRayCastWrapper
 	b2RayCastCallback* callback;
 };
 
+float32 b2WorldTreeRayCastWrapper::RayCastCallback(const b2RayCastInput& localInput, int32 proxyId)
+{
+	b2FixtureProxy* proxy = (b2FixtureProxy*)tree->GetUserData(proxyId);
+	input.maxFraction = localInput.maxFraction;
+	float32 value = wrapper->ReportProxy(input, proxy);
+
+	// Carry the clipping back to the broad-phase ray cast.
+	if (value >= 0.0f)
+	{
+		fraction = value;
+	}
+
+	return value;
+}
+
 void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const
 {
 	b2WorldRayCastWrapper wrapper;
@@ -1034,7 +1932,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 	{
 	case b2Shape::e_circle:
 		{
-			b2CircleShape* circle = (b2CircleShape*)fixture->GetShape();
+			b2CircleShape* circle = (b2CircleShape*)fixture->m_shape;
 
 			b2Vec2 center = b2Mul(xf, circle->m_p);
 			float32 radius = circle->m_radius;
@@ -1046,7 +1944,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 
 	case b2Shape::e_edge:
 		{
-			b2EdgeShape* edge = (b2EdgeShape*)fixture->GetShape();
+			b2EdgeShape* edge = (b2EdgeShape*)fixture->m_shape;
 			b2Vec2 v1 = b2Mul(xf, edge->m_vertex1);
 			b2Vec2 v2 = b2Mul(xf, edge->m_vertex2);
 			m_debugDraw->DrawSegment(v1, v2, color);
@@ -1055,7 +1953,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 
 	case b2Shape::e_chain:
 		{
-			b2ChainShape* chain = (b2ChainShape*)fixture->GetShape();
+			b2ChainShape* chain = (b2ChainShape*)fixture->m_shape;
 			int32 count = chain->m_count;
 			const b2Vec2* vertices = chain->m_vertices;
 
@@ -1072,7 +1970,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 
 	case b2Shape::e_polygon:
 		{
-			b2PolygonShape* poly = (b2PolygonShape*)fixture->GetShape();
+			b2PolygonShape* poly = (b2PolygonShape*)fixture->m_shape;
 			int32 vertexCount = poly->m_count;
 			b2Assert(vertexCount <= b2_maxPolygonVertices);
 			b2Vec2 vertices[b2_maxPolygonVertices];
@@ -1085,6 +1983,39 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
 		}
 		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* capsule = (b2CapsuleShape*)fixture->m_shape;
+			b2Vec2 v1 = b2Mul(xf, capsule->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf, capsule->m_vertex2);
+			float32 radius = capsule->m_radius;
+
+			b2Vec2 axis = v2 - v1;
+			axis.Normalize();
+			b2Vec2 normal(axis.y, -axis.x);
+
+			// Outline the caps with half circles, counter-clockwise.
+			const int32 k_segments = 8;
+			const float32 k_increment = b2_pi / k_segments;
+			b2Vec2 vertices[2 * (k_segments + 1)];
+			int32 vertexCount = 0;
+
+			for (int32 i = 0; i <= k_segments; ++i)
+			{
+				float32 angle = i * k_increment;
+				vertices[vertexCount++] = v2 + radius * (cosf(angle) * normal + sinf(angle) * axis);
+			}
+
+			for (int32 i = 0; i <= k_segments; ++i)
+			{
+				float32 angle = i * k_increment;
+				vertices[vertexCount++] = v1 - radius * (cosf(angle) * normal + sinf(angle) * axis);
+			}
+
+			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
+		}
+		break;
             
     default:
         break;
@@ -1207,6 +2138,23 @@ void b2World::DrawDebugData()
 				continue;
 			}
 
+			// A compound body has one broad-phase proxy for all of its fixtures.
+			if (b->m_compoundTree)
+			{
+				if (b->m_compoundProxy->proxyId != b2BroadPhase::e_nullProxy)
+				{
+					b2AABB aabb = bp->GetFatAABB(b->m_compoundProxy->proxyId);
+					b2Vec2 vs[4];
+					vs[0].Set(aabb.lowerBound.x, aabb.lowerBound.y);
+					vs[1].Set(aabb.upperBound.x, aabb.lowerBound.y);
+					vs[2].Set(aabb.upperBound.x, aabb.upperBound.y);
+					vs[3].Set(aabb.lowerBound.x, aabb.upperBound.y);
+
+					m_debugDraw->DrawPolygon(vs, 4, color);
+				}
+				continue;
+			}
+
 			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
 			{
 				for (int32 i = 0; i < f->m_proxyCount; ++i)
@@ -1267,8 +2215,8 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
 		b->m_xf.p -= newOrigin;
-		b->m_sweep.c0 -= newOrigin;
-		b->m_sweep.c -= newOrigin;
+		b->m_sweep->c0 -= newOrigin;
+		b->m_sweep->c -= newOrigin;
 	}
 
 	for (b2Joint* j = m_jointList; j; j = j->m_next)
@@ -1289,17 +2237,15 @@ void b2World::Dump()
 	b2Log("b2Vec2 g(%.15lef, %.15lef);\n", m_gravity.x, m_gravity.y);
 	b2Log("m_world->SetGravity(g);\n");
 
-	b2Log("b2Body** bodies = (b2Body**)b2Alloc(%d * sizeof(b2Body*));\n", m_bodyCount);
+	// The bodies are dumped by slot.
+	b2Log("b2Body** bodies = (b2Body**)b2Alloc(%d * sizeof(b2Body*));\n", m_bodySlotCount);
 	b2Log("b2Joint** joints = (b2Joint**)b2Alloc(%d * sizeof(b2Joint*));\n", m_jointCount);
-	int32 i = 0;
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
-		b->m_islandIndex = i;
 		b->Dump();
-		++i;
 	}
 
-	i = 0;
+	int32 i = 0;
 	for (b2Joint* j = m_jointList; j; j = j->m_next)
 	{
 		j->m_index = i;
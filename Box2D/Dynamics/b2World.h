@@ -25,15 +25,48 @@
 #include <Dynamics/b2ContactManager.h>
 #include <Dynamics/b2WorldCallbacks.h>
 #include <Dynamics/b2TimeStep.h>
+#include <Dynamics/b2TOIQueue.h>
+#include <Dynamics/b2Id.h>
+#include <Common/b2HandleTable.h>
+#include <new>
 
 struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
+struct b2FixtureDef;
 struct b2JointDef;
 class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2Shape;
+class b2SharedShape;
+struct b2TOICandidate;
+
+/// Expected sizes of a world. b2World::Reserve uses these to allocate storage
+/// up front, so that filling and stepping the world need not grow anything.
+struct b2WorldCapacity
+{
+	b2WorldCapacity()
+	{
+		bodyCount = 0;
+		jointCount = 0;
+		proxyCount = 0;
+		contactCount = 0;
+	}
+
+	/// The number of bodies.
+	int32 bodyCount;
+
+	/// The number of joints.
+	int32 jointCount;
+
+	/// The number of broad-phase proxies. A fixture has one proxy per child.
+	int32 proxyCount;
+
+	/// The number of contacts, including those that are not touching.
+	int32 contactCount;
+};
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -43,7 +76,9 @@ class b2World
 public:
 	/// Construct a world object.
 	/// @param gravity the world gravity vector.
-	b2World(const b2Vec2& gravity);
+	/// @param allocator the allocator that all heap memory of the world is taken
+	/// from, or NULL to use b2Alloc. It is owned by you and must outlive the world.
+	b2World(const b2Vec2& gravity, b2Allocator* allocator = NULL);
 
 	/// Destruct the world. All physics entities are destroyed and all heap memory is released.
 	~b2World();
@@ -66,11 +101,28 @@ public:
 	/// by you and must remain in scope.
 	void SetDebugDraw(b2Draw* debugDraw);
 
+	/// Register a task scheduler so that time of impact candidates are computed on
+	/// worker threads. The simulation result is the same with or without it. The
+	/// scheduler is owned by you and must remain in scope.
+	void SetTaskScheduler(b2TaskScheduler* scheduler);
+
 	/// Create a rigid body given a definition. No reference to the definition
 	/// is retained.
 	/// @warning This function is locked during callbacks.
 	b2Body* CreateBody(const b2BodyDef* def);
 
+	/// Create many bodies that share a list of fixture definitions, such as a burst
+	/// of particles. Each body gets one fixture per fixture definition. The mass of
+	/// each body is computed once and all broad-phase proxies are inserted together.
+	/// @param bodyDefs the body definitions.
+	/// @param bodyCount the number of bodies.
+	/// @param fixtureDefs the fixture definitions given to every body.
+	/// @param fixtureCount the number of fixture definitions.
+	/// @param bodies optional, receives the bodies in the order of the definitions.
+	/// @warning This function is locked during callbacks.
+	void CreateBodies(const b2BodyDef* bodyDefs, int32 bodyCount,
+					  const b2FixtureDef* fixtureDefs, int32 fixtureCount, b2Body** bodies = NULL);
+
 	/// Destroy a rigid body given a definition. No reference to the definition
 	/// is retained. This function is locked during callbacks.
 	/// @warning This automatically deletes all associated shapes and joints.
@@ -86,6 +138,58 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyJoint(b2Joint* joint);
 
+	/// Get a body from its handle.
+	/// @return the body, or NULL if it has been destroyed.
+	b2Body* GetBody(b2BodyId id);
+	const b2Body* GetBody(b2BodyId id) const;
+
+	/// Get a fixture from its handle.
+	/// @return the fixture, or NULL if it has been destroyed.
+	b2Fixture* GetFixture(b2FixtureId id);
+	const b2Fixture* GetFixture(b2FixtureId id) const;
+
+	/// Get a joint from its handle.
+	/// @return the joint, or NULL if it has been destroyed.
+	b2Joint* GetJoint(b2JointId id);
+	const b2Joint* GetJoint(b2JointId id) const;
+
+	/// Create a shared shape from a copy of the given shape. Fixtures created with
+	/// b2FixtureDef::sharedShape reference it instead of cloning their own shape.
+	/// @warning This function is locked during callbacks.
+	b2SharedShape* CreateSharedShape(const b2Shape* shape);
+
+	/// Destroy a shared shape. No new fixtures may use it. Fixtures that still
+	/// reference it keep it alive until they are destroyed.
+	/// @warning This function is locked during callbacks.
+	void DestroySharedShape(b2SharedShape* shape);
+
+	/// Create user data owned by the world and make it the user data of a body.
+	/// The memory is pooled by the world and uninitialized. The destructor, which
+	/// may be NULL, runs when the data is destroyed: by DestroyUserData, when the
+	/// body is destroyed, or with the world. The destruction listener is called
+	/// for the fixtures of a body before their data is destroyed.
+	/// This replaces any user data the body owns already.
+	/// @return the user data.
+	void* CreateUserData(b2Body* body, int32 size, b2UserDataDestructor destructor);
+
+	/// Create user data owned by the world and make it the user data of a fixture.
+	/// It is destroyed with the fixture, like the user data of a body.
+	void* CreateUserData(b2Fixture* fixture, int32 size, b2UserDataDestructor destructor);
+
+	/// Create a copy of value as user data owned by the world. The copy is
+	/// destroyed with its body or fixture.
+	template <typename T>
+	T* CreateUserData(b2Body* body, const T& value);
+	template <typename T>
+	T* CreateUserData(b2Fixture* fixture, const T& value);
+
+	/// Destroy the user data that a body owns and clear the user data pointer.
+	/// This does nothing if the user data of the body is not owned by the world.
+	void DestroyUserData(b2Body* body);
+
+	/// Destroy the user data that a fixture owns and clear the user data pointer.
+	void DestroyUserData(b2Fixture* fixture);
+
 	/// Take a time step. This performs collision detection, integration,
 	/// and constraint solution.
 	/// @param timeStep the amount of time to simulate, this should not vary.
@@ -95,6 +199,20 @@ public:
 				int32 velocityIterations,
 				int32 positionIterations);
 
+	/// Take a time step with an adaptive velocity solver. Each island runs at least
+	/// minVelocityIterations and at most maxVelocityIterations velocity iterations. Between
+	/// the two it stops once an iteration changes no body velocity by more than
+	/// b2_linearVelocityTolerance and b2_angularVelocityTolerance. The iterations used are
+	/// reported in the profile.
+	/// @param timeStep the amount of time to simulate, this should not vary.
+	/// @param minVelocityIterations lower bound for the velocity constraint solver.
+	/// @param maxVelocityIterations upper bound for the velocity constraint solver.
+	/// @param positionIterations for the position constraint solver.
+	void Step(	float32 timeStep,
+				int32 minVelocityIterations,
+				int32 maxVelocityIterations,
+				int32 positionIterations);
+
 	/// Manually clear the force buffer on all bodies. By default, forces are cleared automatically
 	/// after each call to Step. The default behavior is modified by calling SetAutoClearForces.
 	/// The purpose of this function is to support sub-stepping. Sub-stepping is often used to maintain
@@ -157,6 +275,39 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Use speculative contacts instead of time of impact sub-stepping for continuous
+	/// physics. Manifolds then include points that the shapes can reach during the step
+	/// and the solver lets the shapes approach up to them. This keeps the cost of a step
+	/// predictable. Restitution only applies once the shapes touch, and PreSolve is also
+	/// called for contacts whose shapes are about to touch.
+	void SetSpeculativeContacts(bool flag) { m_speculativeContacts = flag; }
+	bool GetSpeculativeContacts() const { return m_speculativeContacts; }
+
+	/// Use the soft step solver with this many substeps per step, or 0 for the iterative
+	/// solver. Each substep integrates the bodies and runs a single relaxed iteration with
+	/// soft contacts, which keeps stiff mechanisms with large mass ratios stable for few
+	/// iterations in total. The iteration counts passed to Step are then ignored. Joint and
+	/// contact impulses are those of the last substep.
+	void SetSubstepCount(int32 count) { m_substepCount = count; }
+	int32 GetSubstepCount() const { return m_substepCount; }
+
+	/// Solve the joints of small islands exactly. The velocity rows of revolute and
+	/// prismatic joints without motor or limit are factored once per step, so closed
+	/// loops such as a crank-slider are satisfied in one pass instead of needing many
+	/// iterations. Position drift is projected out the same way, with the rows
+	/// linearized again in each position iteration. Other joints, and islands with
+	/// more than b2_maxDirectJointRows rows, are solved iteratively as usual.
+	void SetDirectJointSolver(bool flag) { m_directJointSolver = flag; }
+	bool GetDirectJointSolver() const { return m_directJointSolver; }
+
+	/// Integrate the rotations of the body transforms instead of computing them
+	/// from the body angles. After a step each rotation is turned by the angle its
+	/// body moved, which needs no sine and cosine. The angles remain the position
+	/// state of the solver. The rotations are set from the angles again every
+	/// b2_rotationSyncInterval steps, so rounding cannot accumulate.
+	void SetRotationIntegration(bool flag) { m_rotationIntegration = flag; }
+	bool GetRotationIntegration() const { return m_rotationIntegration; }
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -205,6 +356,43 @@ public:
 	/// Get the current profile.
 	const b2Profile& GetProfile() const;
 
+	/// Get the heap memory held by the world per category and the number of
+	/// heap allocations made so far.
+	const b2MemoryStats& GetMemoryStats() const;
+
+	/// Release the chunks of the small object pools that have no object in use.
+	/// Chunks held for Reserve are kept. Returns the number of bytes released.
+	int32 TrimMemory();
+
+	/// Trim a small object pool automatically at the end of a step once it holds
+	/// this many more idle bytes than the least it held since its last trim. Zero
+	/// disables this, which is the default. Idle memory held for Reserve does not
+	/// count toward the threshold and is not released.
+	void SetMemoryTrimThreshold(int32 bytes);
+
+	/// Get the statistics of the small object pool of a category. The pools are
+	/// b2_generalMemory, b2_fixtureMemory, b2_contactMemory and b2_userDataMemory.
+	b2BlockAllocatorStats GetBlockAllocatorStats(b2MemoryCategory category) const;
+
+	/// Size the step memory for the given number of bytes, so that the first steps
+	/// of a large scene need not fall back to the heap. The step memory also grows
+	/// by itself to the most it has needed.
+	/// @warning This function is locked during callbacks.
+	void ReserveStepMemory(int32 bytes);
+
+	/// Size the body storage, the broad-phase, the contact arrays and the small
+	/// object pools for the given capacity. Shapes and joints other than revolute,
+	/// prismatic and weld joints are not pooled ahead. Trimming, automatic or by
+	/// TrimMemory, leaves the reserved pool memory in place.
+	/// @warning This function is locked during callbacks.
+	void Reserve(const b2WorldCapacity& capacity);
+
+	/// Assert that a step makes no heap allocation. Turn this on once the world
+	/// has warmed up or has been sized with Reserve. It only has an effect when
+	/// asserts are enabled.
+	void SetStepAllocationCheck(bool flag);
+	bool GetStepAllocationCheck() const { return m_stepAllocationCheck; }
+
 	/// Dump the world into the log file.
 	/// @warning this should be called outside of a time step.
 	void Dump();
@@ -223,31 +411,74 @@ private:
 	friend class b2Fixture;
 	friend class b2ContactManager;
 	friend class b2Controller;
+	friend class b2Scene;
+
+	int32 AllocateBodySlot();
+	void GrowBodySlots(int32 capacity);
+	void FreeBodySlot(int32 slot);
+
+	// Create the proxies of the fixtures of each body that have none yet.
+	void CreateFixtureProxies(b2Body* const* bodies, int32 bodyCount);
 
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
+	bool PrepareTOI(b2TOICandidate* candidate);
+	void UpdateTOIs(b2Contact** contacts, int32 count);
+
+	void* AllocateUserData(int32 size, b2UserDataDestructor destructor);
+	void FreeUserData(void* data);
 
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
+	// Counts all heap memory of the world. This comes first so that it is built
+	// before and destroyed after everything that allocates through it.
+	b2TrackingAllocator m_allocator;
+
+	// Small objects are pooled by category: bodies, joints and compound trees,
+	// fixtures with their shapes and proxies, contacts, and user data.
 	b2BlockAllocator m_blockAllocator;
+	b2BlockAllocator m_fixtureAllocator;
+	b2BlockAllocator m_contactAllocator;
+	b2BlockAllocator m_userDataAllocator;
 	b2StackAllocator m_stackAllocator;
 
 	int32 m_flags;
 
 	b2ContactManager m_contactManager;
 
+	// Contacts with a pending time of impact, earliest first.
+	b2TOIQueue m_toiQueue;
+
+	// Handles of the bodies, fixtures and joints.
+	b2HandleTable m_bodyHandles;
+	b2HandleTable m_fixtureHandles;
+	b2HandleTable m_jointHandles;
+
 	b2Body* m_bodyList;
 	b2Joint* m_jointList;
+	b2SharedShape* m_sharedShapeList;
 
 	int32 m_bodyCount;
 	int32 m_jointCount;
 
+	// Body storage. The simulation state of the bodies is kept in arrays indexed
+	// by body slot. A body keeps its slot until it is destroyed. Free slots are
+	// reused and hold no body.
+	b2Body** m_bodySlots;
+	b2Sweep* m_bodySweeps;
+	b2Velocity* m_bodyVelocities;
+	int32* m_freeBodySlots;
+	int32 m_freeBodySlotCount;
+	int32 m_bodySlotCount;
+	int32 m_bodySlotCapacity;
+
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
 
 	b2DestructionListener* m_destructionListener;
 	b2Draw* m_debugDraw;
+	b2TaskScheduler* m_taskScheduler;
 
 	// This is used to compute the time step ratio to
 	// support a variable time step.
@@ -257,8 +488,14 @@ private:
 	bool m_warmStarting;
 	bool m_continuousPhysics;
 	bool m_subStepping;
+	bool m_speculativeContacts;
+	int32 m_substepCount;
+	bool m_directJointSolver;
+	bool m_rotationIntegration;
 
 	bool m_stepComplete;
+	int32 m_stepCount;
+	bool m_stepAllocationCheck;
 
 	b2Profile m_profile;
 };
@@ -351,4 +588,53 @@ inline const b2Profile& b2World::GetProfile() const
 	return m_profile;
 }
 
+inline b2Body* b2World::GetBody(b2BodyId id)
+{
+	return (b2Body*)m_bodyHandles.GetObject(id.index, id.generation);
+}
+
+inline const b2Body* b2World::GetBody(b2BodyId id) const
+{
+	return (const b2Body*)m_bodyHandles.GetObject(id.index, id.generation);
+}
+
+inline b2Fixture* b2World::GetFixture(b2FixtureId id)
+{
+	return (b2Fixture*)m_fixtureHandles.GetObject(id.index, id.generation);
+}
+
+inline const b2Fixture* b2World::GetFixture(b2FixtureId id) const
+{
+	return (const b2Fixture*)m_fixtureHandles.GetObject(id.index, id.generation);
+}
+
+inline b2Joint* b2World::GetJoint(b2JointId id)
+{
+	return (b2Joint*)m_jointHandles.GetObject(id.index, id.generation);
+}
+
+inline const b2Joint* b2World::GetJoint(b2JointId id) const
+{
+	return (const b2Joint*)m_jointHandles.GetObject(id.index, id.generation);
+}
+
+inline const b2MemoryStats& b2World::GetMemoryStats() const
+{
+	return m_allocator.GetStats();
+}
+
+template <typename T>
+inline T* b2World::CreateUserData(b2Body* body, const T& value)
+{
+	void* mem = CreateUserData(body, sizeof(T), b2DestroyUserData<T>);
+	return new (mem) T(value);
+}
+
+template <typename T>
+inline T* b2World::CreateUserData(b2Fixture* fixture, const T& value)
+{
+	void* mem = CreateUserData(fixture, sizeof(T), b2DestroyUserData<T>);
+	return new (mem) T(value);
+}
+
 #endif
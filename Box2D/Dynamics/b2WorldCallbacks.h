@@ -30,6 +30,17 @@ class b2Contact;
 struct b2ContactResult;
 struct b2Manifold;
 
+/// Destroys user data owned by the world, see b2World::CreateUserData. The memory
+/// itself is freed by the world afterwards.
+typedef void (*b2UserDataDestructor)(void* data);
+
+/// Calls the destructor of a T created as world-owned user data.
+template <typename T>
+void b2DestroyUserData(void* data)
+{
+	((T*)data)->~T();
+}
+
 /// Joints and fixtures are destroyed when their associated
 /// body is destroyed. Implement this listener so that you
 /// may nullify references to these joints and shapes.
@@ -43,7 +54,8 @@ public:
 	virtual void SayGoodbye(b2Joint* joint) = 0;
 
 	/// Called when any fixture is about to be destroyed due
-	/// to the destruction of its parent body.
+	/// to the destruction of its parent body. User data owned by the
+	/// world is still valid here.
 	virtual void SayGoodbye(b2Fixture* fixture) = 0;
 };
 
@@ -130,6 +142,29 @@ public:
 	virtual bool ReportFixture(b2Fixture* fixture) = 0;
 };
 
+/// A set of independent work items that a b2TaskScheduler may run on any thread.
+class b2Task
+{
+public:
+	virtual ~b2Task() {}
+
+	/// Process the items in [begin, end). Ranges given to different threads
+	/// never overlap.
+	virtual void Execute(int32 begin, int32 end) = 0;
+};
+
+/// Implement this class to let the world run independent work on your own
+/// worker threads. Results do not depend on how the items are split.
+class b2TaskScheduler
+{
+public:
+	virtual ~b2TaskScheduler() {}
+
+	/// Run task items [0, count) and return when all of them are done. It is
+	/// fine to run small sets on the calling thread.
+	virtual void ParallelFor(b2Task* task, int32 count) = 0;
+};
+
 /// Callback class for ray casts.
 /// See b2World::RayCast
 class b2RayCastCallback
@@ -0,0 +1,250 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// Compares the wide circle kernels against the scalar routines on random
+// pairs. The wide kernels claim to produce the same manifold as the scalar
+// code, so every field is compared exactly.
+
+#include <Box2D/Box2D.h>
+#include <stdio.h>
+
+static uint32 s_seed = 12345;
+
+static float32 RandomFloat(float32 lo, float32 hi)
+{
+	s_seed = 1664525 * s_seed + 1013904223;
+	float32 r = float32(s_seed >> 8) / float32(1 << 24);
+	return lo + r * (hi - lo);
+}
+
+static b2Transform RandomTransform()
+{
+	b2Transform xf;
+	xf.Set(b2Vec2(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f)), RandomFloat(-b2_pi, b2_pi));
+	return xf;
+}
+
+static float32 RandomMargin()
+{
+	// Touching shapes use no margin, speculative contacts a small one.
+	return RandomFloat(0.0f, 1.0f) < 0.5f ? 0.0f : RandomFloat(0.0f, 0.2f);
+}
+
+static void RandomCircle(b2CircleShape* circle)
+{
+	circle->m_p.Set(RandomFloat(-0.5f, 0.5f), RandomFloat(-0.5f, 0.5f));
+	circle->m_radius = RandomFloat(0.05f, 1.0f);
+}
+
+static void RandomPolygon(b2PolygonShape* polygon)
+{
+	if (RandomFloat(0.0f, 1.0f) < 0.3f)
+	{
+		polygon->SetAsBox(RandomFloat(0.1f, 1.0f), RandomFloat(0.1f, 1.0f));
+		return;
+	}
+
+	// Points on a jittered circle are always a valid hull.
+	int32 count = 3 + int32(RandomFloat(0.0f, 1.0f) * (b2_maxPolygonVertices - 3));
+	b2Vec2 points[b2_maxPolygonVertices];
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 angle = 2.0f * b2_pi * (i + RandomFloat(0.0f, 0.5f)) / count;
+		float32 radius = RandomFloat(0.3f, 1.0f);
+		points[i].Set(radius * cosf(angle), radius * sinf(angle));
+	}
+	polygon->Set(points, count);
+}
+
+// Move circle B so its center is the given distance from a point of A. The
+// distance is jittered around the contact distance so that rounding in the
+// radius sum decides whether the pair touches.
+static void Graze(b2Transform* xfB, const b2CircleShape& circleB, const b2Vec2& point, const b2Vec2& normal, float32 distance)
+{
+	distance *= 1.0f + RandomFloat(-4.0f, 4.0f) * b2_epsilon;
+	b2Vec2 target = point + distance * normal;
+	xfB->p = target - b2Mul(xfB->q, circleB.m_p);
+}
+
+static bool Equal(const b2Vec2& a, const b2Vec2& b)
+{
+	return a.x == b.x && a.y == b.y;
+}
+
+static bool Equal(const b2Manifold& wide, const b2Manifold& scalar)
+{
+	if (wide.pointCount != scalar.pointCount)
+	{
+		return false;
+	}
+
+	if (scalar.pointCount == 0)
+	{
+		return true;
+	}
+
+	if (wide.type != scalar.type ||
+		Equal(wide.localPoint, scalar.localPoint) == false ||
+		Equal(wide.localNormal, scalar.localNormal) == false)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < scalar.pointCount; ++i)
+	{
+		if (Equal(wide.points[i].localPoint, scalar.points[i].localPoint) == false ||
+			wide.points[i].id.key != scalar.points[i].id.key)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int32 TestCircles(int32 rounds, int32* touching)
+{
+	int32 failures = 0;
+	for (int32 round = 0; round < rounds; ++round)
+	{
+		b2CircleShape circlesA[b2_simdLanes], circlesB[b2_simdLanes];
+		b2Transform xfA[b2_simdLanes], xfB[b2_simdLanes];
+		b2CircleLanes lanesA, lanesB;
+		b2TransformLanes xfLanesA, xfLanesB;
+		float32 margins[b2_simdLanes];
+		b2Manifold wide[b2_simdLanes];
+		b2Manifold* manifolds[b2_simdLanes];
+
+		for (int32 i = 0; i < b2_simdLanes; ++i)
+		{
+			RandomCircle(circlesA + i);
+			RandomCircle(circlesB + i);
+			xfA[i] = RandomTransform();
+			xfB[i] = RandomTransform();
+			margins[i] = RandomMargin();
+
+			if (round & 1)
+			{
+				float32 angle = RandomFloat(-b2_pi, b2_pi);
+				b2Vec2 normal(cosf(angle), sinf(angle));
+				float32 distance = circlesA[i].m_radius + circlesB[i].m_radius + margins[i];
+				Graze(xfB + i, circlesB[i], b2Mul(xfA[i], circlesA[i].m_p), normal, distance);
+			}
+
+			lanesA.Set(i, circlesA[i].m_p, circlesA[i].m_radius);
+			lanesB.Set(i, circlesB[i].m_p, circlesB[i].m_radius);
+			xfLanesA.Set(i, xfA[i]);
+			xfLanesB.Set(i, xfB[i]);
+			manifolds[i] = wide + i;
+		}
+
+		b2CollideCirclesWide(manifolds, lanesA, xfLanesA, lanesB, xfLanesB, margins);
+
+		for (int32 i = 0; i < b2_simdLanes; ++i)
+		{
+			b2Manifold scalar;
+			b2CollideCircles(&scalar, circlesA + i, xfA[i], circlesB + i, xfB[i], margins[i]);
+			*touching += scalar.pointCount;
+			if (Equal(wide[i], scalar) == false)
+			{
+				printf("circles: round %d lane %d differs\n", round, i);
+				++failures;
+			}
+		}
+	}
+
+	return failures;
+}
+
+static int32 TestPolygonAndCircle(int32 rounds, int32* touching)
+{
+	int32 failures = 0;
+	for (int32 round = 0; round < rounds; ++round)
+	{
+		b2PolygonShape polygonsA[b2_simdLanes];
+		b2CircleShape circlesB[b2_simdLanes];
+		b2Transform xfA[b2_simdLanes], xfB[b2_simdLanes];
+		const b2PolygonShape* polygons[b2_simdLanes];
+		b2CircleLanes lanesB;
+		b2TransformLanes xfLanesA, xfLanesB;
+		float32 margins[b2_simdLanes];
+		b2Manifold wide[b2_simdLanes];
+		b2Manifold* manifolds[b2_simdLanes];
+
+		for (int32 i = 0; i < b2_simdLanes; ++i)
+		{
+			RandomPolygon(polygonsA + i);
+			RandomCircle(circlesB + i);
+			xfA[i] = RandomTransform();
+			xfB[i] = RandomTransform();
+			margins[i] = RandomMargin();
+
+			if (round & 1)
+			{
+				// Graze the middle of a random face.
+				const b2PolygonShape& polygon = polygonsA[i];
+				int32 i1 = int32(RandomFloat(0.0f, 1.0f) * polygon.m_count) % polygon.m_count;
+				int32 i2 = i1 + 1 < polygon.m_count ? i1 + 1 : 0;
+				b2Vec2 point = b2Mul(xfA[i], 0.5f * (polygon.m_vertices[i1] + polygon.m_vertices[i2]));
+				b2Vec2 normal = b2Mul(xfA[i].q, polygon.m_normals[i1]);
+				float32 distance = polygon.m_radius + circlesB[i].m_radius + margins[i];
+				Graze(xfB + i, circlesB[i], point, normal, distance);
+			}
+
+			polygons[i] = polygonsA + i;
+			lanesB.Set(i, circlesB[i].m_p, circlesB[i].m_radius);
+			xfLanesA.Set(i, xfA[i]);
+			xfLanesB.Set(i, xfB[i]);
+			manifolds[i] = wide + i;
+		}
+
+		b2CollidePolygonAndCircleWide(manifolds, polygons, xfLanesA, lanesB, xfLanesB, margins);
+
+		for (int32 i = 0; i < b2_simdLanes; ++i)
+		{
+			b2Manifold scalar;
+			b2CollidePolygonAndCircle(&scalar, polygonsA + i, xfA[i], circlesB + i, xfB[i], margins[i]);
+			*touching += scalar.pointCount;
+			if (Equal(wide[i], scalar) == false)
+			{
+				printf("polygon and circle: round %d lane %d differs\n", round, i);
+				++failures;
+			}
+		}
+	}
+
+	return failures;
+}
+
+int main()
+{
+	const int32 rounds = 100000;
+	int32 circleHits = 0, polygonHits = 0;
+	int32 failures = TestCircles(rounds, &circleHits);
+	failures += TestPolygonAndCircle(rounds, &polygonHits);
+
+	printf("%d circle and %d polygon manifolds compared, %d failures\n", circleHits, polygonHits, failures);
+
+	// A test that never touches proves nothing.
+	if (circleHits == 0 || polygonHits == 0)
+	{
+		return 1;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,313 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// Writes a world as a scene and creates it again. The created world must
+// start in the state of the written one and write the same scene, and two
+// worlds created from the scene must step the same bit for bit. Also checks
+// that damaged scenes are refused.
+
+#include <Box2D/Box2D.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static const char* const s_path = "b2SceneTest.b2scene";
+static const char* const s_copyPath = "b2SceneTest2.b2scene";
+
+static void BuildWorld(b2World* world)
+{
+	b2BodyDef bd;
+	b2Body* ground = world->CreateBody(&bd);
+
+	b2PolygonShape floor;
+	floor.SetAsBox(40.0f, 1.0f, b2Vec2(0.0f, -1.0f), 0.0f);
+	ground->CreateFixture(&floor, 0.0f);
+
+	b2EdgeShape wall;
+	wall.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(-40.0f, 20.0f));
+	ground->CreateFixture(&wall, 0.0f);
+
+	b2Vec2 ramp[4] = { b2Vec2(40.0f, 20.0f), b2Vec2(40.0f, 5.0f), b2Vec2(30.0f, 0.0f), b2Vec2(25.0f, 0.0f) };
+	b2ChainShape chain;
+	chain.CreateChain(ramp, 4);
+	ground->CreateFixture(&chain, 0.0f);
+
+	bd.type = b2_dynamicBody;
+	b2Body* prev = ground;
+	for (int32 i = 0; i < 24; ++i)
+	{
+		bd.position.Set(-20.0f + 1.5f * i, 2.0f + float32(i % 5));
+		bd.angle = 0.1f * i;
+		bd.fixedRotation = (i == 3);
+		bd.bullet = (i == 4);
+		b2Body* body = world->CreateBody(&bd);
+
+		b2Vec2 points[5] = { b2Vec2(0.0f, 0.0f), b2Vec2(1.0f, 0.0f), b2Vec2(1.2f, 0.8f), b2Vec2(0.3f, 1.0f), b2Vec2(0.5f, 0.5f) };
+		b2PolygonShape polygon;
+		polygon.Set(points, 5);
+		b2FixtureDef fd;
+		fd.shape = &polygon;
+		fd.density = 1.0f + i;
+		fd.friction = 0.3f;
+		fd.filter.groupIndex = -(i % 3);
+		body->CreateFixture(&fd);
+
+		b2CircleShape circle;
+		circle.m_p.Set(0.5f, -0.5f);
+		circle.m_radius = 0.4f;
+		body->CreateFixture(&circle, 2.0f);
+
+		b2CapsuleShape capsule;
+		capsule.Set(b2Vec2(-1.0f, 0.0f), b2Vec2(-1.0f, 1.0f), 0.2f);
+		body->CreateFixture(&capsule, 1.0f);
+
+		switch (i % 4)
+		{
+		case 0:
+			{
+				b2RevoluteJointDef jd;
+				jd.Initialize(prev, body, body->GetPosition());
+				jd.enableLimit = true;
+				jd.lowerAngle = -0.5f;
+				jd.upperAngle = 0.5f;
+				world->CreateJoint(&jd);
+			}
+			break;
+
+		case 1:
+			{
+				b2PrismaticJointDef jd;
+				jd.Initialize(prev, body, body->GetPosition(), b2Vec2(1.0f, 1.0f));
+				jd.enableMotor = true;
+				jd.maxMotorForce = 10.0f;
+				jd.motorSpeed = 1.0f;
+				world->CreateJoint(&jd);
+			}
+			break;
+
+		case 2:
+			{
+				b2DistanceJointDef jd;
+				jd.Initialize(prev, body, prev->GetPosition(), body->GetPosition());
+				jd.frequencyHz = 3.0f;
+				jd.dampingRatio = 0.5f;
+				world->CreateJoint(&jd);
+			}
+			break;
+
+		default:
+			{
+				b2WeldJointDef jd;
+				jd.Initialize(prev, body, body->GetPosition());
+				world->CreateJoint(&jd);
+			}
+			break;
+		}
+
+		prev = body;
+	}
+}
+
+static bool ReadFile(const char* path, std::vector<uint32>* data, int32* size)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	*size = int32(ftell(file));
+	fseek(file, 0, SEEK_SET);
+
+	// Words keep the data 4 byte aligned for b2Scene::Open.
+	data->resize((*size + 3) / 4);
+	bool ok = fread(data->data(), 1, *size, file) == size_t(*size);
+	fclose(file);
+	return ok;
+}
+
+// The bodies of both worlds in list order must have the same state.
+static bool SameBodies(b2World* a, b2World* b)
+{
+	if (a->GetBodyCount() != b->GetBodyCount())
+	{
+		return false;
+	}
+
+	const b2Body* ba = a->GetBodyList();
+	const b2Body* bb = b->GetBodyList();
+	for (; ba && bb; ba = ba->GetNext(), bb = bb->GetNext())
+	{
+		const b2Transform& xfA = ba->GetTransform();
+		const b2Transform& xfB = bb->GetTransform();
+		b2Vec2 vA = ba->GetLinearVelocity();
+		b2Vec2 vB = bb->GetLinearVelocity();
+		if (memcmp(&xfA, &xfB, sizeof(b2Transform)) != 0 ||
+			vA.x != vB.x || vA.y != vB.y ||
+			ba->GetAngularVelocity() != bb->GetAngularVelocity() ||
+			ba->IsAwake() != bb->IsAwake())
+		{
+			return false;
+		}
+	}
+
+	return ba == NULL && bb == NULL;
+}
+
+static int32 TestRoundTrip()
+{
+	int32 failures = 0;
+
+	b2World original(b2Vec2(0.0f, -10.0f));
+	BuildWorld(&original);
+	if (b2Scene::Write(s_path, &original) == false)
+	{
+		printf("round trip: write failed\n");
+		return 1;
+	}
+
+	b2Scene scene;
+	if (scene.Open(s_path) == false)
+	{
+		printf("round trip: open failed\n");
+		return 1;
+	}
+
+	b2World loaded(b2Vec2(0.0f, -10.0f));
+	b2World other(b2Vec2(0.0f, -10.0f));
+	scene.Create(&loaded);
+	scene.Create(&other);
+	scene.Close();
+
+	if (SameBodies(&original, &loaded) == false)
+	{
+		printf("round trip: the loaded world starts in another state\n");
+		++failures;
+	}
+
+	// Writing the loaded world again gives the same file.
+	std::vector<uint32> data, copy;
+	int32 size = 0, copySize = 0;
+	if (b2Scene::Write(s_copyPath, &loaded) == false ||
+		ReadFile(s_path, &data, &size) == false ||
+		ReadFile(s_copyPath, &copy, &copySize) == false ||
+		size != copySize || memcmp(data.data(), copy.data(), size) != 0)
+	{
+		printf("round trip: the loaded world writes a different scene\n");
+		++failures;
+	}
+
+	const int32 steps = 300;
+	for (int32 i = 0; i < steps; ++i)
+	{
+		loaded.Step(1.0f / 60.0f, 8, 3);
+		other.Step(1.0f / 60.0f, 8, 3);
+		if (SameBodies(&loaded, &other) == false)
+		{
+			printf("round trip: the loaded worlds differ after step %d\n", i + 1);
+			++failures;
+			break;
+		}
+	}
+
+	if (loaded.GetContactCount() == 0 || loaded.GetContactCount() != other.GetContactCount())
+	{
+		printf("round trip: %d contacts against %d\n", loaded.GetContactCount(), other.GetContactCount());
+		++failures;
+	}
+
+	return failures;
+}
+
+static int32 TestRejects()
+{
+	int32 failures = 0;
+
+	std::vector<uint32> data;
+	int32 size = 0;
+	if (ReadFile(s_path, &data, &size) == false)
+	{
+		printf("rejects: no scene to damage\n");
+		return 1;
+	}
+
+	const b2SceneHeader* header = (const b2SceneHeader*)data.data();
+	const int32 bodyOffset = sizeof(b2SceneHeader);
+	const int32 jointOffset = bodyOffset + header->bodyCount * sizeof(b2SceneBody) + header->fixtureCount * sizeof(b2SceneFixture);
+
+	// Body 0 is the ground, body 1 the first dynamic body.
+	b2Scene scene;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		std::vector<uint32> damaged = data;
+		b2SceneBody* body = (b2SceneBody*)((char*)damaged.data() + bodyOffset) + 1;
+		b2SceneJoint* joint = (b2SceneJoint*)((char*)damaged.data() + jointOffset);
+
+		const char* name = "";
+		switch (i)
+		{
+		case 0:
+			name = "joint to itself";
+			joint->bodyB = joint->bodyA;
+			break;
+
+		case 1:
+			name = "zero mass";
+			body->mass = 0.0f;
+			break;
+
+		case 2:
+			name = "zero inverse mass";
+			body->invMass = 0.0f;
+			break;
+
+		default:
+			name = "negative mass";
+			body->mass = -1.0f;
+			break;
+		}
+
+		if (scene.Open(damaged.data(), size))
+		{
+			printf("rejects: opened a scene with a %s\n", name);
+			scene.Close();
+			++failures;
+		}
+	}
+
+	if (scene.Open(data.data(), size) == false)
+	{
+		printf("rejects: refused the undamaged scene\n");
+		++failures;
+	}
+
+	return failures;
+}
+
+int main()
+{
+	int32 failures = TestRoundTrip();
+	failures += TestRejects();
+
+	remove(s_path);
+	remove(s_copyPath);
+
+	printf("%d failures\n", failures);
+	return failures == 0 ? 0 : 1;
+}
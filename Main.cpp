@@ -3,9 +3,11 @@
 #include "B2Renderer.h"
 #include "CollisionListener.h"
 #include "CollisionFilter.h"
+#include "EngineSceneNamer.h"
 #include "FixtureUserDataContainer.h"
 #include "Globals.h"
 #include "RayCastClosestCallback.h"
+#include "TaskScheduler.h"
 
 #include <vector>
 #include <map>
@@ -20,6 +22,9 @@ void Update(sf::RenderWindow& window, b2World& world);
 void Draw(sf::RenderWindow& window, b2World& world);
 void WorldStep(b2World& world);
 
+void CreateEngineScene(b2World& world);
+bool CompileEngineScene(b2World& world, const char* path);
+bool LoadEngineScene(b2World& world, const char* path);
 
 void CreateEngineBodies(b2World& world);
 void CreateCorpus(b2World& world);
@@ -36,20 +41,22 @@ void CreateSensors(b2World& world);
 void SpawnFuelParticles(b2World& world, b2Vec2 position, int totalParticles);
 
 
-void PolygonMaker(b2Body* body, float density, b2Vec2 verts[], int size,  FixtureUserDataContainer* data);
-void AddPolygonVerts(std::vector<b2Vec2*>& vertVec, std::vector<int>& vertsSizeVec, int size, b2Vec2* verts);
+void PolygonMaker(b2Body* body, float density, const std::vector<b2Vec2>& verts, std::string name);
+void PolygonListMaker(b2Body* body, float density, const std::vector<std::vector<b2Vec2>>& vertsVec, int begin, int end, std::string name);
+void CapsuleMaker(b2Body* body, float density, b2Vec2 p1, b2Vec2 p2, float radius, std::string name);
+void AddPolygonVerts(std::vector<std::vector<b2Vec2>>& vertVec, const std::vector<b2Vec2>& verts);
 void AddRelativeJoint(b2World& world, b2Body* bodyA, b2Body* bodyB, std::string name, b2Vec2 jointPos, bool collideConnected,  bool testMotor = false);
 void AddPrismaticJoint(b2World& world, b2Body* bodyA, b2Body* bodyB,std::string name, b2Vec2 axis, bool collideConnected, bool enableMotor);
-void AddAirPressureArea(b2World& world, b2Vec2* verts, int size, std::string name);
-void AddSensor(b2World& world, b2Vec2* verts, int size, std::string name);
+void AddAirPressureArea(b2World& world, const std::vector<b2Vec2>& verts, std::string name);
+void AddSensor(b2World& world, const std::vector<b2Vec2>& verts, std::string name);
 
 
 void ForceUpdate(b2World& world);
 void UpdateAirPressureZonesState(b2World& world);
-void AffectBodiesInAirPressureZones();
+void AffectBodiesInAirPressureZones(b2World& world);
 void ParticleRemover(b2World& world);
 void EnginePhysics(b2World& world);
-void FuelPhysics();
+void FuelPhysics(b2World& world);
 
 // I-Force's methods (which I modified a bit) from explosion tutorial (mentioned here in case if I will forget to put him in LR)
 void ApplyBlastImpulse(b2Body* body, b2Vec2 blastCenter, b2Vec2 applyPoint, float blastPower);
@@ -59,24 +66,20 @@ void ExplodeRaycast(b2World& world, b2Body* body);
 
 // ----------------------------------------------------------------------------------------------------
 // Variables
-std::vector<b2Vec2*> m_corpusVertsVec;
-std::vector<b2Vec2*> m_crankshaftVertsVec;
-std::vector<b2Vec2*> m_pistonVertsVec;
-std::vector<b2Vec2*> m_conRodVertsVec;
+std::vector<std::vector<b2Vec2>> m_corpusVertsVec;
+std::vector<std::vector<b2Vec2>> m_crankshaftVertsVec;
+std::vector<std::vector<b2Vec2>> m_pistonVertsVec;
+std::vector<std::vector<b2Vec2>> m_conRodVertsVec;
 
-std::vector<int> m_corpusVertsSizeVec;
-std::vector<int> m_crankshaftVertsSizeVec;
-std::vector<int> m_pistonVertsSizeVec;
-std::vector<int> m_conRodVertsSizeVec;
 
-
-std::map<std::string, b2Body*> m_bodies;
-std::map<std::string, b2Joint*> m_joints;
+std::map<std::string, b2BodyId> m_bodies;
+std::map<std::string, b2JointId> m_joints;
 
 std::map <std::string, AirPressureArea*> m_airAreas;
 std::map <std::string, SensorArea*> m_sensorAreas;
 
-std::vector<b2Body*> m_fuelParticles;
+std::vector<b2BodyId> m_fuelParticles;
+b2SharedShape* m_fuelShape = NULL;
 
 bool m_engineOn = false;
 bool m_engineStarted = false;
@@ -92,8 +95,24 @@ const int c_conbustionForce = 1000;
 const int c_conbustionRadius = 400;
 const int c_conbustionSpreadDirs = 32;
 
-int main()
+const int c_workerThreads = 3;
+
+// Precompiled engine geometry, see CompileEngineScene. The file is not kept
+// with the sources, so it cannot fall behind the code; without it the engine
+// is built from code.
+const char* const c_sceneFile = "engine.b2scene";
+
+int main(int argc, char** argv)
 {
+    // Offline scene compiler: builds the engine from the hard-coded geometry and
+    // writes it as a scene file instead of running the simulation.
+    if(argc == 3 && std::string(argv[1]) == "--compile-scene")
+    {
+        b2World l_world(b2Vec2(0, 0));
+        CreateEngineScene(l_world);
+        return CompileEngineScene(l_world, argv[2]) ? 0 : 1;
+    }
+
     srand (time(NULL));
     // Set Screen.
     sf::RenderWindow l_window(sf::VideoMode(375, 547), "2 Stroke Engine| Press Enter to Start Engine", sf::Style::Close);
@@ -103,25 +122,23 @@ int main()
     l_debugDraw.SetFlags(b2Draw::e_shapeBit);
 
     // Set World.
+    TaskScheduler l_taskScheduler(c_workerThreads);
     b2Vec2 l_gravity(0, 0);
     b2World l_world(l_gravity);
     l_world.SetContactListener(new CollisionListener());
     l_world.SetContactFilter(new CollisionFilter());
+    l_world.SetTaskScheduler(&l_taskScheduler);
+    l_world.SetDirectJointSolver(true);
+    l_world.SetRotationIntegration(true);
+    l_world.SetMemoryTrimThreshold(64 * 1024);
     l_world.SetDebugDraw(&l_debugDraw);
 
 
-    // Hard-coded variables.
-    InitVertsList();
-
-    // Create Engine
-    CreateEngineBodies(l_world);
-    CreateJoints(l_world);
-
-    // Air Pressure Zones
-    CreateAirPressureZones(l_world);
-
-    // Sensors
-    CreateSensors(l_world);
+    // Load the precompiled engine, or build it if there is no scene file.
+    if(LoadEngineScene(l_world, c_sceneFile) == false)
+    {
+        CreateEngineScene(l_world);
+    }
 
     // Some oil leftovers spawn.
     SpawnFuelParticles(l_world, b2Vec2(25, 352), 35);
@@ -140,70 +157,170 @@ int main()
 
 
 
+void CreateEngineScene(b2World& world)
+{
+    // Hard-coded variables.
+    InitVertsList();
+
+    // Create Engine
+    CreateEngineBodies(world);
+    CreateJoints(world);
+
+    // Air Pressure Zones
+    CreateAirPressureZones(world);
+
+    // Sensors
+    CreateSensors(world);
+}
+
+// Writes the engine as a scene file. Run the program with
+// "--compile-scene engine.b2scene" to write it next to the program, and again
+// after changing the geometry.
+bool CompileEngineScene(b2World& world, const char* path)
+{
+    EngineSceneNamer l_namer(m_bodies, m_joints, m_airAreas, m_sensorAreas);
+    return b2Scene::Write(path, &world, &l_namer);
+}
+
+// Creates the engine from a scene file and restores the names and user data
+// that CreateEngineScene would have set up.
+bool LoadEngineScene(b2World& world, const char* path)
+{
+    b2Scene l_scene;
+    if(l_scene.Open(path) == false)
+    {
+        return false;
+    }
+
+    std::vector<b2Body*> l_bodies(l_scene.GetBodyCount());
+    std::vector<b2Fixture*> l_fixtures(l_scene.GetFixtureCount());
+    std::vector<b2Joint*> l_joints(l_scene.GetJointCount());
+    l_scene.Create(&world, l_bodies.data(), l_fixtures.data(), l_joints.data());
+
+    for(int i = 0; i < l_scene.GetFixtureCount(); i++)
+    {
+        const char* l_name = l_scene.GetFixtureName(i);
+        if(l_name != NULL)
+        {
+            world.CreateUserData(l_fixtures[i], FixtureUserDataContainer(l_name));
+        }
+    }
+
+    for(int i = 0; i < l_scene.GetBodyCount(); i++)
+    {
+        const char* l_name = l_scene.GetBodyName(i);
+        if(l_name == NULL)
+        {
+            continue;
+        }
+
+        // Areas keep their own name on their fixture.
+        b2Body* l_body = l_bodies[i];
+        b2Fixture* l_fixture = l_body->GetFixtureList();
+        std::string l_areaName;
+        if(l_fixture != NULL && l_fixture->GetUserData() != NULL)
+        {
+            l_areaName = ((FixtureUserDataContainer*)l_fixture->GetUserData())->GetName();
+        }
+
+        if(std::string(l_name) == EngineSceneNamer::c_airPressureArea)
+        {
+            AirPressureArea* l_area = world.CreateUserData(l_body, AirPressureArea());
+            l_area->awake = false;
+            l_area->name = l_areaName;
+            l_area->sensor = l_body;
+            m_airAreas[l_areaName] = l_area;
+        }
+        else if(std::string(l_name) == EngineSceneNamer::c_sensorArea)
+        {
+            SensorArea* l_area = world.CreateUserData(l_body, SensorArea());
+            l_area->touched = false;
+            l_area->name = l_areaName;
+            l_area->sensor = l_body;
+            m_sensorAreas[l_areaName] = l_area;
+        }
+        else
+        {
+            m_bodies[l_name] = l_body->GetId();
+        }
+    }
+
+    for(int i = 0; i < l_scene.GetJointCount(); i++)
+    {
+        const char* l_name = l_scene.GetJointName(i);
+        if(l_name != NULL)
+        {
+            m_joints[l_name] = l_joints[i]->GetId();
+        }
+    }
+
+    return true;
+}
+
 void InitVertsList()
 {
     // Engine Corpus
 
     // Upper Engine Corpus.
     {
-        /*01*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(2,329), b2Vec2(2, 340), b2Vec2(55, 340), b2Vec2(55, 329)});
-        /*02*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(55, 329), b2Vec2(55, 340), b2Vec2(69, 347), b2Vec2(69, 329)});
-        /*03*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(69, 347), b2Vec2(75, 357), b2Vec2(75, 347)});
-        /*04*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(69, 329), b2Vec2(69, 347), b2Vec2(102, 347), b2Vec2(102, 329)});
-        /*05*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(75, 347), b2Vec2(75, 365), b2Vec2(102, 365), b2Vec2(102, 347)});
-        /*06*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(75, 365), b2Vec2(75, 403), b2Vec2(93, 387), b2Vec2(102, 365)});
-        /*07*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(83, 329), b2Vec2(102, 329), b2Vec2(102, 320), b2Vec2(91, 320)});
-        /*08*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(91, 320), b2Vec2(102, 320), b2Vec2(102, 4), b2Vec2(91, 4)});
-        /*09*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(102, 66), b2Vec2(102, 179),  b2Vec2(112, 179), b2Vec2(112, 66)});
-        /*10*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 6, new b2Vec2[6]{b2Vec2(102, 66), b2Vec2(112, 66), b2Vec2(131, 60), b2Vec2(149, 42), b2Vec2(155, 22), b2Vec2(102, 22)});
-        /*11*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(102, 179), b2Vec2(102, 189), b2Vec2(112, 179)});
-        /*12*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(102, 4), b2Vec2(102, 22),  b2Vec2(315, 22), b2Vec2(315, 4)});
-        /*13*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 6, new b2Vec2[6]{b2Vec2(315, 22), b2Vec2(315, 66), b2Vec2(277, 66), b2Vec2(242, 57), b2Vec2(215, 45), b2Vec2(186, 22)});
-        /*14*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(294, 66), b2Vec2(294, 168), b2Vec2(315, 168), b2Vec2(315, 66)});
-        /*15*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(315, 156), b2Vec2(315, 168), b2Vec2(368, 168), b2Vec2(368, 156)});
+        /*01*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(2,329), b2Vec2(2, 340), b2Vec2(55, 340), b2Vec2(55, 329)});
+        /*02*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(55, 329), b2Vec2(55, 340), b2Vec2(69, 347), b2Vec2(69, 329)});
+        /*03*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(69, 347), b2Vec2(75, 357), b2Vec2(75, 347)});
+        /*04*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(69, 329), b2Vec2(69, 347), b2Vec2(102, 347), b2Vec2(102, 329)});
+        /*05*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(75, 347), b2Vec2(75, 365), b2Vec2(102, 365), b2Vec2(102, 347)});
+        /*06*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(75, 365), b2Vec2(75, 403), b2Vec2(93, 387), b2Vec2(102, 365)});
+        /*07*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(83, 329), b2Vec2(102, 329), b2Vec2(102, 320), b2Vec2(91, 320)});
+        /*08*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(91, 320), b2Vec2(102, 320), b2Vec2(102, 4), b2Vec2(91, 4)});
+        /*09*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(102, 66), b2Vec2(102, 179),  b2Vec2(112, 179), b2Vec2(112, 66)});
+        /*10*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(102, 66), b2Vec2(112, 66), b2Vec2(131, 60), b2Vec2(149, 42), b2Vec2(155, 22), b2Vec2(102, 22)});
+        /*11*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(102, 179), b2Vec2(102, 189), b2Vec2(112, 179)});
+        /*12*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(102, 4), b2Vec2(102, 22),  b2Vec2(315, 22), b2Vec2(315, 4)});
+        /*13*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(315, 22), b2Vec2(315, 66), b2Vec2(277, 66), b2Vec2(242, 57), b2Vec2(215, 45), b2Vec2(186, 22)});
+        /*14*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(294, 66), b2Vec2(294, 168), b2Vec2(315, 168), b2Vec2(315, 66)});
+        /*15*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(315, 156), b2Vec2(315, 168), b2Vec2(368, 168), b2Vec2(368, 156)});
     }
 
     // Lower Engine Corpus.
     {
-        /*16*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(2,363), b2Vec2(2, 374), b2Vec2(46, 374), b2Vec2(46, 363)});
-        /*17*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(42, 374), b2Vec2(42, 543),  b2Vec2(53, 543), b2Vec2(53, 374)});
-        /*18*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{ b2Vec2(46, 363), b2Vec2(46, 374), b2Vec2(53, 374), b2Vec2(51, 368)});
-        /*19*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(34, 374), b2Vec2(42, 374), b2Vec2(42, 385)});
-        /*20*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(53, 528), b2Vec2(53, 543), b2Vec2(316, 543), b2Vec2(316, 528)});
-        /*21*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(331, 363), b2Vec2(316, 363), b2Vec2(316, 543), b2Vec2(331, 543)});
-        /*22*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(294, 347), b2Vec2(315, 347), b2Vec2(315, 213), b2Vec2(294, 213)});
-        /*23*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(315, 213), b2Vec2(315, 224), b2Vec2(367, 224), b2Vec2(367, 213)});
-        /*24*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(315, 347), b2Vec2(314, 363), b2Vec2(331, 363)});
-        /*25*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(295, 347), b2Vec2(315, 400), b2Vec2(315, 347)});
-        /*26*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 6, new b2Vec2[6]{b2Vec2(53, 423), b2Vec2(53, 528), b2Vec2(93, 528), b2Vec2(93, 445), b2Vec2(75, 428), b2Vec2(63, 423)});
-        /*27*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(312, 445), b2Vec2(312, 528),b2Vec2(316, 528), b2Vec2(316, 426)});
-        /*28*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(93, 445), b2Vec2(93, 528), b2Vec2(116, 528), b2Vec2(116, 492)});
-        /*29*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(116, 492), b2Vec2(116, 528), b2Vec2(145, 528), b2Vec2(145, 517)});
-        /*30*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(145, 517), b2Vec2(145, 528),  b2Vec2(185, 528)});
-        /*31*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(258, 517),b2Vec2(218, 528), b2Vec2(258, 528)});
-        /*32*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(287, 492), b2Vec2(258, 517), b2Vec2(258, 528), b2Vec2(287, 528)});
-        /*33*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(312, 445), b2Vec2(287, 492), b2Vec2(287, 528), b2Vec2(312, 528)});
-        /*34*/AddPolygonVerts(m_corpusVertsVec, m_corpusVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(53, 411),b2Vec2(53, 423), b2Vec2(63, 423)});
+        /*16*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(2,363), b2Vec2(2, 374), b2Vec2(46, 374), b2Vec2(46, 363)});
+        /*17*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(42, 374), b2Vec2(42, 543),  b2Vec2(53, 543), b2Vec2(53, 374)});
+        /*18*/AddPolygonVerts(m_corpusVertsVec, { b2Vec2(46, 363), b2Vec2(46, 374), b2Vec2(53, 374), b2Vec2(51, 368)});
+        /*19*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(34, 374), b2Vec2(42, 374), b2Vec2(42, 385)});
+        /*20*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(53, 528), b2Vec2(53, 543), b2Vec2(316, 543), b2Vec2(316, 528)});
+        /*21*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(331, 363), b2Vec2(316, 363), b2Vec2(316, 543), b2Vec2(331, 543)});
+        /*22*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(294, 347), b2Vec2(315, 347), b2Vec2(315, 213), b2Vec2(294, 213)});
+        /*23*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(315, 213), b2Vec2(315, 224), b2Vec2(367, 224), b2Vec2(367, 213)});
+        /*24*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(315, 347), b2Vec2(314, 363), b2Vec2(331, 363)});
+        /*25*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(295, 347), b2Vec2(315, 400), b2Vec2(315, 347)});
+        /*26*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(53, 423), b2Vec2(53, 528), b2Vec2(93, 528), b2Vec2(93, 445), b2Vec2(75, 428), b2Vec2(63, 423)});
+        /*27*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(312, 445), b2Vec2(312, 528),b2Vec2(316, 528), b2Vec2(316, 426)});
+        /*28*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(93, 445), b2Vec2(93, 528), b2Vec2(116, 528), b2Vec2(116, 492)});
+        /*29*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(116, 492), b2Vec2(116, 528), b2Vec2(145, 528), b2Vec2(145, 517)});
+        /*30*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(145, 517), b2Vec2(145, 528),  b2Vec2(185, 528)});
+        /*31*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(258, 517),b2Vec2(218, 528), b2Vec2(258, 528)});
+        /*32*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(287, 492), b2Vec2(258, 517), b2Vec2(258, 528), b2Vec2(287, 528)});
+        /*33*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(312, 445), b2Vec2(287, 492), b2Vec2(287, 528), b2Vec2(312, 528)});
+        /*34*/AddPolygonVerts(m_corpusVertsVec, {b2Vec2(53, 411),b2Vec2(53, 423), b2Vec2(63, 423)});
     }
 
     // ----------------------------------------------------------------------------------------------------
     // Piston
     {
-        /*01*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(114, 78), b2Vec2(114, 184), b2Vec2(291, 184), b2Vec2(291, 78)});
-        /*02*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(114, 184), b2Vec2(114, 224),b2Vec2(123, 224), b2Vec2(123, 184)});
-        /*03*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(283, 184), b2Vec2(283, 224), b2Vec2(291, 224), b2Vec2(291, 184)});
-        /*04*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(123, 184), b2Vec2(123, 224), b2Vec2(153, 197), b2Vec2(153, 184)});
-        /*05*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(153, 184), b2Vec2(153, 197), b2Vec2(188, 184)});
-        /*06*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(283, 184), b2Vec2(253, 184), b2Vec2(253, 197), b2Vec2(283, 224)});
-        /*07*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(253, 184), b2Vec2(218, 184), b2Vec2(253, 197)});
-        /*08*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(114, 78), b2Vec2(131, 78), b2Vec2(131, 73)});
-        /*09*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(131, 73), b2Vec2(131, 78), b2Vec2(149, 78), b2Vec2(149, 60)});
-        /*10*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(149, 60), b2Vec2(149, 78), b2Vec2(158, 78), b2Vec2(158, 49)});
-        /*11*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(158, 49), b2Vec2(158, 78), b2Vec2(165, 78), b2Vec2(165, 33)});
-        /*12*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(165, 33), b2Vec2(165, 78), b2Vec2(181, 78), b2Vec2(181, 33)});
-        /*13*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(181, 33), b2Vec2(181, 78), b2Vec2(214, 78), b2Vec2(214, 57)});
-        /*14*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(214, 57), b2Vec2(214, 78), b2Vec2(243, 78), b2Vec2(243, 70)});
-        /*15*/AddPolygonVerts(m_pistonVertsVec, m_pistonVertsSizeVec, 3, new b2Vec2[3]{b2Vec2(243, 70), b2Vec2(243, 78), b2Vec2(291, 78)});
+        /*01*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(114, 78), b2Vec2(114, 184), b2Vec2(291, 184), b2Vec2(291, 78)});
+        /*02*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(114, 184), b2Vec2(114, 224),b2Vec2(123, 224), b2Vec2(123, 184)});
+        /*03*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(283, 184), b2Vec2(283, 224), b2Vec2(291, 224), b2Vec2(291, 184)});
+        /*04*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(123, 184), b2Vec2(123, 224), b2Vec2(153, 197), b2Vec2(153, 184)});
+        /*05*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(153, 184), b2Vec2(153, 197), b2Vec2(188, 184)});
+        /*06*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(283, 184), b2Vec2(253, 184), b2Vec2(253, 197), b2Vec2(283, 224)});
+        /*07*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(253, 184), b2Vec2(218, 184), b2Vec2(253, 197)});
+        /*08*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(114, 78), b2Vec2(131, 78), b2Vec2(131, 73)});
+        /*09*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(131, 73), b2Vec2(131, 78), b2Vec2(149, 78), b2Vec2(149, 60)});
+        /*10*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(149, 60), b2Vec2(149, 78), b2Vec2(158, 78), b2Vec2(158, 49)});
+        /*11*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(158, 49), b2Vec2(158, 78), b2Vec2(165, 78), b2Vec2(165, 33)});
+        /*12*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(165, 33), b2Vec2(165, 78), b2Vec2(181, 78), b2Vec2(181, 33)});
+        /*13*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(181, 33), b2Vec2(181, 78), b2Vec2(214, 78), b2Vec2(214, 57)});
+        /*14*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(214, 57), b2Vec2(214, 78), b2Vec2(243, 78), b2Vec2(243, 70)});
+        /*15*/AddPolygonVerts(m_pistonVertsVec, {b2Vec2(243, 70), b2Vec2(243, 78), b2Vec2(291, 78)});
     }
 
 
@@ -212,48 +329,22 @@ void InitVertsList()
 
     // Bridge
     {
-        AddPolygonVerts(m_conRodVertsVec, m_conRodVertsSizeVec, 4,
-                        new b2Vec2[4]{
+        AddPolygonVerts(m_conRodVertsVec,
+                        {
                         b2Vec2(186, 165),
                         b2Vec2(186, 317),
                         b2Vec2(220, 317),
                         b2Vec2(220, 165)});
     }
 
-    // Lower Head
-    {
-        int l_radius = 39;
-        b2Vec2* l_vertices = new b2Vec2[8];
-        l_vertices[0] =  b2Vec2(203,348);
-        for (int i = 0; i < 7; i++)
-        {
-            float l_angle = i / 3.0 * -180 * DEG_TO_RAD;
-            l_vertices[i+1] =  b2Vec2(  l_vertices[0].x + l_radius * cosf(l_angle),
-                                        l_vertices[0].y + l_radius * sinf(l_angle) );
-        }
-            AddPolygonVerts(m_conRodVertsVec, m_conRodVertsSizeVec, 8, l_vertices);
-    }
-
-    // Upper Head
-    {
-        int l_radius = 39;
-        b2Vec2* l_vertices = new b2Vec2[8];
-        l_vertices[0] =  b2Vec2(203,135);
-        for (int i = 0; i < 7; i++)
-        {
-            float l_angle = i / 3.0 * -180 * DEG_TO_RAD;
-            l_vertices[i+1] =  b2Vec2(  l_vertices[0].x + l_radius * cosf(l_angle),
-                                        l_vertices[0].y + l_radius * sinf(l_angle) );
-        }
-            AddPolygonVerts(m_conRodVertsVec, m_conRodVertsSizeVec, 8, l_vertices);
-    }
+    // Heads are made in CreateConnectRod.
 
     // Crankshaft
 
     // Lower Half - Circle
     {
         int l_radius = 92;
-        b2Vec2* l_vertices = new b2Vec2[8];
+        std::vector<b2Vec2> l_vertices(8);
         l_vertices[0] =  b2Vec2(203,417);
         for (int i = 0; i < 7; i++)
         {
@@ -261,27 +352,11 @@ void InitVertsList()
             l_vertices[i+1] =  b2Vec2(l_vertices[0].x + l_radius * cosf(l_angle),
                                       l_vertices[0].y + l_radius * sinf(l_angle) );
         }
-        AddPolygonVerts(m_crankshaftVertsVec, m_crankshaftVertsSizeVec, 8, l_vertices);
-    }
-
-
-    // Upper Half - Circle
-    {
-        int l_radius = 39;
-        b2Vec2* l_vertices = new b2Vec2[8];
-        l_vertices[0] =  b2Vec2(203,348);
-        for (int i = 0; i < 7; i++)
-        {
-            float l_angle = i / 6.0 * -180 * DEG_TO_RAD;
-            l_vertices[i+1] =  b2Vec2(l_vertices[0].x + l_radius * cosf(l_angle),
-                                      l_vertices[0].y + l_radius * sinf(l_angle) );
-        }
-        AddPolygonVerts(m_crankshaftVertsVec, m_crankshaftVertsSizeVec, 8, l_vertices);
+        AddPolygonVerts(m_crankshaftVertsVec, l_vertices);
     }
 
-    // Middle of Crankshaft.
-    AddPolygonVerts(m_crankshaftVertsVec, m_crankshaftVertsSizeVec, 4, new b2Vec2[4]{b2Vec2(164, 348), b2Vec2(164, 417), b2Vec2(242, 417), b2Vec2(242, 348)});
 
+    // Upper Half and Middle of Crankshaft are one capsule, made in CreateCrankshaft.
 }
 
 
@@ -324,11 +399,13 @@ void Draw(sf::RenderWindow& window, b2World& world)
 
 void WorldStep(b2World& world)
 {
-	int32 velocityIterations = 6;
+	int32 minVelocityIterations = 3;
+	int32 maxVelocityIterations = 8;
 	int32 positionIterations = 4;
 
 	world.Step( UPDATE_TICKS,
-                velocityIterations,
+                minVelocityIterations,
+                maxVelocityIterations,
                 positionIterations);
 }
 
@@ -349,16 +426,12 @@ void CreateCorpus(b2World& world)
     l_bodyDef.type = b2_kinematicBody;
     l_bodyDef.position.Set(0, 0);
     l_bodyDef.angle = 0;
-    FixtureUserDataContainer* l_data = new FixtureUserDataContainer("Corpus");
     l_bodyDef.fixedRotation = true;
     b2Body* l_body = world.CreateBody(&l_bodyDef);
 
-    for(int i = 0; i < m_corpusVertsSizeVec.size(); i++)
-    {
-        PolygonMaker(l_body, .05f, m_corpusVertsVec.at(i), m_corpusVertsSizeVec.at(i), l_data);
-    }
+    PolygonListMaker(l_body, .05f, m_corpusVertsVec, 0, m_corpusVertsVec.size(), "Corpus");
 
-    m_bodies["Corpus"] = l_body;
+    m_bodies["Corpus"] = l_body->GetId();
 }
 
 void CreatePiston(b2World& world)
@@ -371,19 +444,10 @@ void CreatePiston(b2World& world)
     l_bodyDef.fixedRotation = true;
     b2Body* l_body = world.CreateBody(&l_bodyDef);
 
-    for(int i = 0; i < m_pistonVertsVec.size(); i++)
-    {
-        if(i < c_startIndexOfPistonTop)
-        {
-            PolygonMaker(l_body, .005f, m_pistonVertsVec.at(i), m_pistonVertsSizeVec.at(i), new FixtureUserDataContainer("Piston"));
-        }
-        else
-        {
-            PolygonMaker(l_body, .005f, m_pistonVertsVec.at(i), m_pistonVertsSizeVec.at(i), new FixtureUserDataContainer("Piston Top"));
-        }
-    }
+    PolygonListMaker(l_body, .005f, m_pistonVertsVec, 0, c_startIndexOfPistonTop, "Piston");
+    PolygonListMaker(l_body, .005f, m_pistonVertsVec, c_startIndexOfPistonTop, m_pistonVertsVec.size(), "Piston Top");
 
-    m_bodies["Piston"] = l_body;
+    m_bodies["Piston"] = l_body->GetId();
 }
 
 void CreateCrankshaft(b2World& world)
@@ -392,15 +456,14 @@ void CreateCrankshaft(b2World& world)
     l_bodyDef.type = b2_dynamicBody;
     l_bodyDef.position.Set(0, 0);
     l_bodyDef.angle = 0;
-    FixtureUserDataContainer* l_data =  new FixtureUserDataContainer("Crankshaft");
     l_bodyDef.fixedRotation = false;
     b2Body* l_body = world.CreateBody(&l_bodyDef);
 
-    for(int i = 0; i < m_crankshaftVertsVec.size(); i++)
-    {
-        PolygonMaker(l_body, .005f, m_crankshaftVertsVec.at(i), m_crankshaftVertsSizeVec.at(i), l_data);
-    }
-    m_bodies["Crankshaft"] = l_body;
+    PolygonListMaker(l_body, .005f, m_crankshaftVertsVec, 0, m_crankshaftVertsVec.size(), "Crankshaft");
+
+    // Upper Half - Circle and Middle of Crankshaft.
+    CapsuleMaker(l_body, .005f, b2Vec2(203, 348), b2Vec2(203, 417), 39, "Crankshaft");
+    m_bodies["Crankshaft"] = l_body->GetId();
 }
 
 void CreateConnectRod(b2World& world)
@@ -409,15 +472,15 @@ void CreateConnectRod(b2World& world)
     l_bodyDef.type = b2_dynamicBody;
     l_bodyDef.position.Set(0, 0);
     l_bodyDef.angle = 0;
-    FixtureUserDataContainer* l_data =  new FixtureUserDataContainer("Connecting Rod");
     l_bodyDef.fixedRotation = false;
     b2Body* l_body = world.CreateBody(&l_bodyDef);
 
-    for(int i = 0; i < m_conRodVertsVec.size(); i++)
-    {
-        PolygonMaker(l_body, .0005f, m_conRodVertsVec.at(i), m_conRodVertsSizeVec.at(i), l_data);
-    }
-    m_bodies["Connecting Rod"] = l_body;
+    PolygonListMaker(l_body, .0005f, m_conRodVertsVec, 0, m_conRodVertsVec.size(), "Connecting Rod");
+
+    // Lower and Upper Head.
+    CapsuleMaker(l_body, .0005f, b2Vec2(203, 348), b2Vec2(203, 348), 39, "Connecting Rod");
+    CapsuleMaker(l_body, .0005f, b2Vec2(203, 135), b2Vec2(203, 135), 39, "Connecting Rod");
+    m_bodies["Connecting Rod"] = l_body->GetId();
 }
 
 void CreateReedValve(b2World& world)
@@ -429,53 +492,52 @@ void CreateReedValve(b2World& world)
     l_bodyDef.fixedRotation = false;
     b2Body* l_body = world.CreateBody(&l_bodyDef);
 
-    PolygonMaker(l_body, .001f, new b2Vec2[4]{b2Vec2(92, 393), b2Vec2(81, 404), b2Vec2(81, 427), b2Vec2(92, 436)}, 4, new FixtureUserDataContainer("ValveCover"));
-    PolygonMaker(l_body, .001f, new b2Vec2[4]{b2Vec2(35, 410), b2Vec2(35, 421), b2Vec2(81, 421), b2Vec2(81, 410)}, 4, new FixtureUserDataContainer("ValveBody"));
+    PolygonMaker(l_body, .001f, {b2Vec2(92, 393), b2Vec2(81, 404), b2Vec2(81, 427), b2Vec2(92, 436)}, "ValveCover");
+    PolygonMaker(l_body, .001f, {b2Vec2(35, 410), b2Vec2(35, 421), b2Vec2(81, 421), b2Vec2(81, 410)}, "ValveBody");
 
     // Valve Head
     {
         int l_radius = 9;
-        b2Vec2* l_vertices = new b2Vec2[8];
+        std::vector<b2Vec2> l_vertices(8);
         l_vertices[0] =  b2Vec2(35,415);
-
         for (int i = 0; i < 7; i++)
         {
-            float l_angle = (90 + (i / 6.0 * 180) )* DEG_TO_RAD;
-            l_vertices[i+1] =  b2Vec2(  l_vertices[0].x + l_radius * cosf(l_angle),
-                                        l_vertices[0].y + l_radius * sinf(l_angle) );
+            float l_angle = (90 + i / 6.0 * 180) * DEG_TO_RAD;
+            l_vertices[i+1] =  b2Vec2(l_vertices[0].x + l_radius * cosf(l_angle),
+                                      l_vertices[0].y + l_radius * sinf(l_angle) );
         }
-        PolygonMaker(l_body, .001f, l_vertices, 8, new FixtureUserDataContainer("ValveHead"));
+        PolygonMaker(l_body, .001f, l_vertices, "ValveHead");
     }
 
 
-    m_bodies["Reed Valve"] = l_body;
+    m_bodies["Reed Valve"] = l_body->GetId();
 }
 
 void CreateJoints(b2World& world)
 {
-    AddRelativeJoint(world, m_bodies["Corpus"], m_bodies["Crankshaft"], "Corpus-Crankshaft Joint", b2Vec2(203, 417), false);
-    AddRelativeJoint(world, m_bodies["Connecting Rod"], m_bodies["Crankshaft"], "Rod-Crankshaft Joint", b2Vec2(203,348), false);
-    AddRelativeJoint(world, m_bodies["Connecting Rod"], m_bodies["Piston"], "Rod-Piston Joint", b2Vec2(203,135), false);
-    AddPrismaticJoint(world, m_bodies["Piston"], m_bodies["Corpus"], "Piston Prismatic Joint",b2Vec2(0.0f, 1.0f), false, false);
-    AddPrismaticJoint(world, m_bodies["Reed Valve"], m_bodies["Corpus"], "Valve Prismatic Joint", b2Vec2(1.0f, 0.0f), true, false);
+    AddRelativeJoint(world, world.GetBody(m_bodies["Corpus"]), world.GetBody(m_bodies["Crankshaft"]), "Corpus-Crankshaft Joint", b2Vec2(203, 417), false);
+    AddRelativeJoint(world, world.GetBody(m_bodies["Connecting Rod"]), world.GetBody(m_bodies["Crankshaft"]), "Rod-Crankshaft Joint", b2Vec2(203,348), false);
+    AddRelativeJoint(world, world.GetBody(m_bodies["Connecting Rod"]), world.GetBody(m_bodies["Piston"]), "Rod-Piston Joint", b2Vec2(203,135), false);
+    AddPrismaticJoint(world, world.GetBody(m_bodies["Piston"]), world.GetBody(m_bodies["Corpus"]), "Piston Prismatic Joint",b2Vec2(0.0f, 1.0f), false, false);
+    AddPrismaticJoint(world, world.GetBody(m_bodies["Reed Valve"]), world.GetBody(m_bodies["Corpus"]), "Valve Prismatic Joint", b2Vec2(1.0f, 0.0f), true, false);
 }
 
 void CreateAirPressureZones(b2World& world)
 {
-    AddAirPressureArea(world, new b2Vec2[4]{b2Vec2(102,22),b2Vec2(102,215),b2Vec2(294,215),b2Vec2(294,22)}, 4, "Combustion Chamber");
-    AddAirPressureArea(world, new b2Vec2[4]{b2Vec2(2,340),b2Vec2(2,445),b2Vec2(93,445),b2Vec2(93,340)}, 4, "Intake Port");
-    AddAirPressureArea(world, new b2Vec2[4]{b2Vec2(102,179),b2Vec2(102,528),b2Vec2(112,528),b2Vec2(112,179)}, 4, "Air Suck Left");
-    AddAirPressureArea(world, new b2Vec2[4]{b2Vec2(112,220),b2Vec2(112, 445),b2Vec2(320, 445),b2Vec2(320,220)}, 4, "Air Suck Right");
-    AddAirPressureArea(world, new b2Vec2[4]{b2Vec2(112,445),b2Vec2(112, 528),b2Vec2(320, 528),b2Vec2(320,445)}, 4, "Air Suck Bottom");
+    AddAirPressureArea(world, {b2Vec2(102,22),b2Vec2(102,215),b2Vec2(294,215),b2Vec2(294,22)}, "Combustion Chamber");
+    AddAirPressureArea(world, {b2Vec2(2,340),b2Vec2(2,445),b2Vec2(93,445),b2Vec2(93,340)}, "Intake Port");
+    AddAirPressureArea(world, {b2Vec2(102,179),b2Vec2(102,528),b2Vec2(112,528),b2Vec2(112,179)}, "Air Suck Left");
+    AddAirPressureArea(world, {b2Vec2(112,220),b2Vec2(112, 445),b2Vec2(320, 445),b2Vec2(320,220)}, "Air Suck Right");
+    AddAirPressureArea(world, {b2Vec2(112,445),b2Vec2(112, 528),b2Vec2(320, 528),b2Vec2(320,445)}, "Air Suck Bottom");
 }
 
 void CreateSensors(b2World& world)
 {
-    AddSensor(world, new b2Vec2[4]{b2Vec2(285,167),b2Vec2(285, 170),b2Vec2(295, 170),b2Vec2(295,167)}, 4, "Exhaust Lock");
-    AddSensor(world, new b2Vec2[4]{b2Vec2(112,178),b2Vec2(112, 180),b2Vec2(116, 180),b2Vec2(116,178)}, 4, "Combustion Chamber Lock");
-    AddSensor(world, new b2Vec2[4]{b2Vec2(359,169),b2Vec2(359, 212),b2Vec2(367, 212),b2Vec2(367,169)}, 4, "Particle Remover Exhaust");
-    AddSensor(world, new b2Vec2[4]{b2Vec2(3,340),b2Vec2(3, 364),b2Vec2(5, 364),b2Vec2(5,340)}, 4, "Particle Remover Intake");
-    AddSensor(world, new b2Vec2[4]{b2Vec2(112,22),b2Vec2(112, 80),b2Vec2(293, 80),b2Vec2(293,22)}, 4, "Ignition Trigger");
+    AddSensor(world, {b2Vec2(285,167),b2Vec2(285, 170),b2Vec2(295, 170),b2Vec2(295,167)}, "Exhaust Lock");
+    AddSensor(world, {b2Vec2(112,178),b2Vec2(112, 180),b2Vec2(116, 180),b2Vec2(116,178)}, "Combustion Chamber Lock");
+    AddSensor(world, {b2Vec2(359,169),b2Vec2(359, 212),b2Vec2(367, 212),b2Vec2(367,169)}, "Particle Remover Exhaust");
+    AddSensor(world, {b2Vec2(3,340),b2Vec2(3, 364),b2Vec2(5, 364),b2Vec2(5,340)}, "Particle Remover Intake");
+    AddSensor(world, {b2Vec2(112,22),b2Vec2(112, 80),b2Vec2(293, 80),b2Vec2(293,22)}, "Ignition Trigger");
 }
 
 
@@ -487,12 +549,17 @@ void SpawnFuelParticles(b2World& world, b2Vec2 position, int totalParticles)
 
     l_bodyDef.angle = 0;
     l_bodyDef.fixedRotation = false;
-    b2CircleShape l_shape;
-    l_shape.m_radius = 4;
+    // All fuel particles reference one circle instead of a copy each.
+    if (m_fuelShape == NULL)
+    {
+        b2CircleShape l_shape;
+        l_shape.m_radius = 4;
+        m_fuelShape = world.CreateSharedShape(&l_shape);
+    }
+
     b2FixtureDef l_fixture;
 
-    l_fixture.shape = &l_shape;
-    l_fixture.userData = new FixtureUserDataContainer("Fuel");
+    l_fixture.sharedShape = m_fuelShape;
     l_fixture.density = .001f;
     l_fixture.friction = 0;
     l_fixture.restitution = 0;
@@ -502,48 +569,109 @@ void SpawnFuelParticles(b2World& world, b2Vec2 position, int totalParticles)
         totalParticles = m_fuelParticles.size() - c_maxParticles;
     }
 
+    if(totalParticles <= 0)
+    {
+        return;
+    }
 
+    // Create the whole burst in one go so the broad-phase gets a single insert.
+    std::vector<b2BodyDef> l_bodyDefs(totalParticles, l_bodyDef);
     for (int i = 0; i < totalParticles; ++i)
     {
-        Fuel* l_fuel = new Fuel();
-        l_fuel->burned = false;
-        l_fuel->burning = false;
-        l_bodyDef.position.Set( position.x + (-5 + rand() % 11),
-                                position.y + (-5 + rand() % 11));
+        l_bodyDefs[i].position.Set( position.x + (-5 + rand() % 11),
+                                    position.y + (-5 + rand() % 11));
+    }
 
-        l_bodyDef.userData = l_fuel;
+    std::vector<b2Body*> l_bodies(totalParticles);
+    world.CreateBodies(l_bodyDefs.data(), totalParticles, &l_fixture, 1, l_bodies.data());
 
-        l_shape.m_p.Set(0,0);
-        l_fixture.shape = &l_shape;
+    for (int i = 0; i < totalParticles; ++i)
+    {
+        b2Body* l_body = l_bodies[i];
+        world.CreateUserData(l_body->GetFixtureList(), FixtureUserDataContainer("Fuel"));
 
-        b2Body* l_body = world.CreateBody(&l_bodyDef);
-        l_body->CreateFixture(&l_fixture);
-        m_fuelParticles.push_back(l_body);
+        Fuel* l_fuel = world.CreateUserData(l_body, Fuel());
+        l_fuel->burned = false;
+        l_fuel->burning = false;
+        m_fuelParticles.push_back(l_body->GetId());
     }
 }
 
 
 
-void PolygonMaker(b2Body* body, float density, b2Vec2 verts[], int size, FixtureUserDataContainer* data)
+void PolygonMaker(b2Body* body, float density, const std::vector<b2Vec2>& verts, std::string name)
 {
 
     b2PolygonShape l_shape;
-    l_shape.Set(verts,size);
+    l_shape.Set(verts.data(), verts.size());
 
     b2FixtureDef l_fixture;
     l_fixture.shape = &l_shape;
     l_fixture.density = density;
     l_fixture.friction = 0;
     l_fixture.restitution = 0;
-    l_fixture.userData = data;
 
-    body->CreateFixture(&l_fixture);
+    b2Fixture* l_newFixture = body->CreateFixture(&l_fixture);
+    body->GetWorld()->CreateUserData(l_newFixture, FixtureUserDataContainer(name));
+}
+
+// Creates the polygons in [begin, end) of vertsVec on one body at once.
+void PolygonListMaker(b2Body* body, float density, const std::vector<std::vector<b2Vec2>>& vertsVec, int begin, int end, std::string name)
+{
+    int l_count = end - begin;
+    std::vector<b2PolygonShape> l_shapes(l_count);
+    std::vector<b2FixtureDef> l_fixtures(l_count);
+
+    for(int i = 0; i < l_count; i++)
+    {
+        const std::vector<b2Vec2>& l_verts = vertsVec.at(begin + i);
+        l_shapes[i].Set(l_verts.data(), l_verts.size());
+
+        l_fixtures[i].shape = &l_shapes[i];
+        l_fixtures[i].density = density;
+        l_fixtures[i].friction = 0;
+        l_fixtures[i].restitution = 0;
+    }
+
+    std::vector<b2Fixture*> l_newFixtures(l_count);
+    body->CreateFixtures(l_fixtures.data(), l_count, l_newFixtures.data());
+
+    for(int i = 0; i < l_count; i++)
+    {
+        body->GetWorld()->CreateUserData(l_newFixtures[i], FixtureUserDataContainer(name));
+    }
+}
+
+// Rounded part from p1 to p2. If both points are the same it is a full circle.
+void CapsuleMaker(b2Body* body, float density, b2Vec2 p1, b2Vec2 p2, float radius, std::string name)
+{
+    b2CapsuleShape l_capsule;
+    b2CircleShape l_circle;
+
+    b2FixtureDef l_fixture;
+    if(p1 == p2)
+    {
+        l_circle.m_p = p1;
+        l_circle.m_radius = radius;
+        l_fixture.shape = &l_circle;
+    }
+    else
+    {
+        l_capsule.Set(p1, p2, radius);
+        l_fixture.shape = &l_capsule;
+    }
+
+    l_fixture.density = density;
+    l_fixture.friction = 0;
+    l_fixture.restitution = 0;
+
+    b2Fixture* l_newFixture = body->CreateFixture(&l_fixture);
+    body->GetWorld()->CreateUserData(l_newFixture, FixtureUserDataContainer(name));
 }
 
-void AddPolygonVerts(std::vector<b2Vec2*>& vertVec, std::vector<int>& vertsSizeVec, int size, b2Vec2* verts)
+void AddPolygonVerts(std::vector<std::vector<b2Vec2>>& vertVec, const std::vector<b2Vec2>& verts)
 {
     vertVec.push_back(verts);
-    vertsSizeVec.push_back(size);
 }
 
 void AddRelativeJoint(b2World& world, b2Body* bodyA, b2Body* bodyB, std::string name, b2Vec2 jointPos, bool collideConnected, bool testMotor)
@@ -563,7 +691,7 @@ void AddRelativeJoint(b2World& world, b2Body* bodyA, b2Body* bodyB, std::string
     }
 
     b2RevoluteJoint* l_joint =  (b2RevoluteJoint*)world.CreateJoint( &l_jointDef );
-    m_joints[name] = l_joint;
+    m_joints[name] = l_joint->GetId();
 }
 
 void AddPrismaticJoint(b2World& world, b2Body* bodyA, b2Body* bodyB, std::string name, b2Vec2 axis, bool collideConnected, bool enableMotor)
@@ -578,15 +706,11 @@ void AddPrismaticJoint(b2World& world, b2Body* bodyA, b2Body* bodyB, std::string
 
 
     b2PrismaticJoint* l_prisJoint =  (b2PrismaticJoint*)world.CreateJoint( &l_prisJointDef );
-    m_joints[name] =l_prisJoint;
+    m_joints[name] = l_prisJoint->GetId();
 }
 
-void AddAirPressureArea(b2World& world, b2Vec2* verts, int size, std::string name)
+void AddAirPressureArea(b2World& world, const std::vector<b2Vec2>& verts, std::string name)
 {
-    AirPressureArea* l_area = new AirPressureArea();
-    l_area->awake = false;
-    l_area->name = name;
-
     b2BodyDef l_bodyDef;
     l_bodyDef.type = b2_staticBody;
     l_bodyDef.position.Set(0, 0);
@@ -595,27 +719,25 @@ void AddAirPressureArea(b2World& world, b2Vec2* verts, int size, std::string nam
     b2Body* l_body = world.CreateBody(&l_bodyDef);
 
     b2PolygonShape l_shape;
-    l_shape.Set(verts, size);
+    l_shape.Set(verts.data(), verts.size());
     b2FixtureDef l_fixture;
-    l_fixture.userData = new FixtureUserDataContainer(name);
     l_fixture.shape = &l_shape;
     l_fixture.density = 0;
     l_fixture.isSensor = true;
     l_fixture.friction = 0;
     l_fixture.restitution = 0;
-    l_body->CreateFixture(&l_fixture);
+    b2Fixture* l_newFixture = l_body->CreateFixture(&l_fixture);
+    world.CreateUserData(l_newFixture, FixtureUserDataContainer(name));
 
+    AirPressureArea* l_area = world.CreateUserData(l_body, AirPressureArea());
+    l_area->awake = false;
+    l_area->name = name;
     l_area->sensor = l_body;
-    l_body->SetUserData(l_area);
     m_airAreas[name] = l_area;
 }
 
-void AddSensor(b2World& world, b2Vec2* verts, int size, std::string name)
+void AddSensor(b2World& world, const std::vector<b2Vec2>& verts, std::string name)
 {
-    SensorArea* l_area = new SensorArea();
-    l_area->touched = false;
-    l_area->name = name;
-
     b2BodyDef l_bodyDef;
     l_bodyDef.type = b2_staticBody;
     l_bodyDef.position.Set(0, 0);
@@ -624,18 +746,20 @@ void AddSensor(b2World& world, b2Vec2* verts, int size, std::string name)
     b2Body* l_body = world.CreateBody(&l_bodyDef);
 
     b2PolygonShape l_shape;
-    l_shape.Set(verts, size);
+    l_shape.Set(verts.data(), verts.size());
     b2FixtureDef l_fixture;
-    l_fixture.userData = new FixtureUserDataContainer(name);
     l_fixture.shape = &l_shape;
     l_fixture.density = 0;
     l_fixture.isSensor = true;
     l_fixture.friction = 0;
     l_fixture.restitution = 0;
-    l_body->CreateFixture(&l_fixture);
+    b2Fixture* l_newFixture = l_body->CreateFixture(&l_fixture);
+    world.CreateUserData(l_newFixture, FixtureUserDataContainer(name));
 
+    SensorArea* l_area = world.CreateUserData(l_body, SensorArea());
+    l_area->touched = false;
+    l_area->name = name;
     l_area->sensor = l_body;
-    l_body->SetUserData(l_area);
     m_sensorAreas[name] = l_area;
 }
 
@@ -644,21 +768,21 @@ void AddSensor(b2World& world, b2Vec2* verts, int size, std::string name)
 void ForceUpdate(b2World& world)
 {
     // Constant force to Reed Valve
-    m_bodies["Reed Valve"]->ApplyForceToCenter(b2Vec2(-10,0), true);
+    world.GetBody(m_bodies["Reed Valve"])->ApplyForceToCenter(b2Vec2(-10,0), true);
 
     UpdateAirPressureZonesState(world);
-    AffectBodiesInAirPressureZones();
+    AffectBodiesInAirPressureZones(world);
     ParticleRemover(world);
 
     EnginePhysics(world);
-    FuelPhysics();
+    FuelPhysics(world);
 }
 
 void UpdateAirPressureZonesState(b2World& world)
 {
     // Manage Intake Port based on Piston Y Velocity.
     {
-        float l_pistonVelY = m_bodies["Piston"]->GetLinearVelocity().y;
+        float l_pistonVelY = world.GetBody(m_bodies["Piston"])->GetLinearVelocity().y;
 
         if(l_pistonVelY < -0.7f && m_airAreas["Intake Port"]->awake != true)
         {
@@ -706,13 +830,13 @@ void UpdateAirPressureZonesState(b2World& world)
     }
 }
 
-void AffectBodiesInAirPressureZones()
+void AffectBodiesInAirPressureZones(b2World& world)
 {
     // If Intake Port is awake.
     if(m_airAreas["Intake Port"]->awake)
     {
         // Move Valve and let all fuel in.
-        m_bodies["Reed Valve"]->ApplyForceToCenter(b2Vec2(15,0), true);
+        world.GetBody(m_bodies["Reed Valve"])->ApplyForceToCenter(b2Vec2(15,0), true);
 
         for (b2ContactEdge* ce = m_airAreas["Intake Port"]->sensor->GetContactList(); ce; ce = ce->next)
         {
@@ -781,20 +905,29 @@ void AffectBodiesInAirPressureZones()
 
 void ParticleRemover(b2World& world)
 {
+    // Collect the particles first, destroying a body also destroys its sensor contacts.
+    std::vector<b2BodyId> l_removed;
+
     for (b2ContactEdge* ce = m_sensorAreas["Particle Remover Exhaust"]->sensor->GetContactList(); ce; ce = ce->next)
     {
-        b2Body* l_body = ce->other;
-        world.DestroyBody(l_body);
-
-        m_fuelParticles.erase(std::remove(m_fuelParticles.begin(), m_fuelParticles.end(), l_body), m_fuelParticles.end());
+        l_removed.push_back(ce->other->GetId());
     }
 
     for (b2ContactEdge* ce = m_sensorAreas["Particle Remover Intake"]->sensor->GetContactList(); ce; ce = ce->next)
     {
-        b2Body* l_body = ce->other;
-        world.DestroyBody(l_body);
+        l_removed.push_back(ce->other->GetId());
+    }
+
+    for (b2BodyId l_id : l_removed)
+    {
+        // A particle can be listed twice, the second time its handle is stale.
+        b2Body* l_body = world.GetBody(l_id);
+        if (l_body != NULL)
+        {
+            world.DestroyBody(l_body);
+        }
 
-        m_fuelParticles.erase(std::remove(m_fuelParticles.begin(), m_fuelParticles.end(), l_body), m_fuelParticles.end());
+        m_fuelParticles.erase(std::remove(m_fuelParticles.begin(), m_fuelParticles.end(), l_id), m_fuelParticles.end());
     }
 }
 
@@ -831,11 +964,11 @@ void EnginePhysics(b2World& world)
     }
 }
 
-void FuelPhysics()
+void FuelPhysics(b2World& world)
 {
-    for( b2Body* body : m_fuelParticles)
+    for( b2BodyId id : m_fuelParticles)
     {
-        Fuel* l_fuel = (Fuel*)body->GetUserData();
+        Fuel* l_fuel = (Fuel*)world.GetBody(id)->GetUserData();
 
         if(l_fuel->burning &&  m_sensorAreas["Combustion Chamber Lock"]->touched == false)
         {
@@ -0,0 +1,41 @@
+#ifndef ENGINESCENENAMER_H
+#define ENGINESCENENAMER_H
+
+#include <Box2D.h>
+#include <list>
+#include <map>
+#include <string>
+#include "Globals.h"
+
+
+// Names the engine's bodies, fixtures and joints when the scene is compiled, so
+// they can be found again after loading. Air pressure areas and sensors are
+// marked by their body name and keep the area name on their fixture.
+class EngineSceneNamer : public b2SceneNamer
+{
+    public:
+        static const char* const c_airPressureArea;
+        static const char* const c_sensorArea;
+
+        EngineSceneNamer(const std::map<std::string, b2BodyId>& bodies,
+                         const std::map<std::string, b2JointId>& joints,
+                         const std::map<std::string, AirPressureArea*>& airAreas,
+                         const std::map<std::string, SensorArea*>& sensorAreas);
+        virtual ~EngineSceneNamer();
+
+        const char* GetName(b2Body* body) override;
+        const char* GetName(b2Fixture* fixture) override;
+        const char* GetName(b2Joint* joint) override;
+
+    protected:
+    private:
+        const std::map<std::string, b2BodyId>& m_bodies;
+        const std::map<std::string, b2JointId>& m_joints;
+        const std::map<std::string, AirPressureArea*>& m_airAreas;
+        const std::map<std::string, SensorArea*>& m_sensorAreas;
+
+        // Fixture names are copies, they must live until the scene is written.
+        std::list<std::string> m_fixtureNames;
+};
+
+#endif // ENGINESCENENAMER_H
@@ -0,0 +1,59 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <Box2D.h>
+#include <SFML/System.hpp>
+#include <vector>
+
+
+// Runs Box2D tasks on a fixed set of worker threads. The workers are started
+// once and stay parked between calls. The calling thread takes the first
+// range itself and waits for the workers to finish the rest.
+//
+// SFML has no condition variable, so each worker is parked on a ring of three
+// mutexes. The worker holds one gate and blocks on the next, which the
+// scheduler holds. Opening that gate starts the worker; the worker reports
+// back by unlocking the gate it held, which the scheduler then takes. Each
+// mutex is only ever unlocked by the thread that locked it.
+class TaskScheduler : public b2TaskScheduler
+{
+    public:
+        TaskScheduler(int threadCount);
+        virtual ~TaskScheduler();
+        void ParallelFor(b2Task* task, int32 count) override;
+
+    protected:
+    private:
+        struct Worker
+        {
+            Worker();
+
+            void Run();
+
+            // Lets the worker run its range. Set the range first.
+            void Start();
+
+            // Blocks until the worker has finished the range given to Start.
+            void Wait();
+
+            sf::Mutex m_gates[3];
+
+            // Index of the gate the worker holds. Only used by the scheduler.
+            int m_held;
+
+            // Set by the worker once it holds its first gate.
+            sf::Mutex m_readyMutex;
+            bool m_ready;
+
+            // Written by the scheduler before opening a gate.
+            b2Task* m_task;
+            int32 m_begin;
+            int32 m_end;
+            bool m_quit;
+        };
+
+        std::vector<Worker*> m_workers;
+        std::vector<sf::Thread*> m_threads;
+};
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,74 @@
+#include "EngineSceneNamer.h"
+#include "FixtureUserDataContainer.h"
+
+
+const char* const EngineSceneNamer::c_airPressureArea = "AirPressureArea";
+const char* const EngineSceneNamer::c_sensorArea = "SensorArea";
+
+EngineSceneNamer::EngineSceneNamer(const std::map<std::string, b2BodyId>& bodies,
+                                   const std::map<std::string, b2JointId>& joints,
+                                   const std::map<std::string, AirPressureArea*>& airAreas,
+                                   const std::map<std::string, SensorArea*>& sensorAreas)
+    : m_bodies(bodies), m_joints(joints), m_airAreas(airAreas), m_sensorAreas(sensorAreas)
+{
+    //ctor
+}
+
+EngineSceneNamer::~EngineSceneNamer()
+{
+    //dtor
+}
+
+const char* EngineSceneNamer::GetName(b2Body* body)
+{
+    for(auto& l_pair : m_bodies)
+    {
+        if(l_pair.second == body->GetId())
+        {
+            return l_pair.first.c_str();
+        }
+    }
+
+    for(auto& l_pair : m_airAreas)
+    {
+        if(l_pair.second->sensor == body)
+        {
+            return c_airPressureArea;
+        }
+    }
+
+    for(auto& l_pair : m_sensorAreas)
+    {
+        if(l_pair.second->sensor == body)
+        {
+            return c_sensorArea;
+        }
+    }
+
+    return NULL;
+}
+
+const char* EngineSceneNamer::GetName(b2Fixture* fixture)
+{
+    FixtureUserDataContainer* l_data = static_cast<FixtureUserDataContainer*>(fixture->GetUserData());
+    if(l_data == NULL)
+    {
+        return NULL;
+    }
+
+    m_fixtureNames.push_back(l_data->GetName());
+    return m_fixtureNames.back().c_str();
+}
+
+const char* EngineSceneNamer::GetName(b2Joint* joint)
+{
+    for(auto& l_pair : m_joints)
+    {
+        if(l_pair.second == joint->GetId())
+        {
+            return l_pair.first.c_str();
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,144 @@
+#include "TaskScheduler.h"
+
+
+// Below this many items per thread, waking the workers costs more than it saves.
+const int c_minItemsPerThread = 32;
+
+TaskScheduler::TaskScheduler(int threadCount)
+{
+    //ctor
+    for (int i = 0; i < threadCount; i++)
+    {
+        Worker* l_worker = new Worker();
+
+        // The scheduler holds the two gates the worker does not.
+        l_worker->m_gates[1].lock();
+        l_worker->m_gates[2].lock();
+
+        sf::Thread* l_thread = new sf::Thread(&Worker::Run, l_worker);
+        l_thread->launch();
+
+        m_workers.push_back(l_worker);
+        m_threads.push_back(l_thread);
+    }
+
+    // The first Wait must not take gate 0 before its worker does.
+    for (unsigned int i = 0; i < m_workers.size(); i++)
+    {
+        for (;;)
+        {
+            {
+                sf::Lock l_lock(m_workers[i]->m_readyMutex);
+                if (m_workers[i]->m_ready)
+                {
+                    break;
+                }
+            }
+            sf::sleep(sf::milliseconds(1));
+        }
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    //dtor
+    for (unsigned int i = 0; i < m_workers.size(); i++)
+    {
+        Worker* l_worker = m_workers[i];
+        l_worker->m_quit = true;
+        l_worker->Start();
+        m_threads[i]->wait();
+
+        // The worker released its gates on the way out; release ours.
+        l_worker->m_gates[(l_worker->m_held + 2) % 3].unlock();
+
+        delete m_threads[i];
+        delete l_worker;
+    }
+}
+
+void TaskScheduler::ParallelFor(b2Task* task, int32 count)
+{
+    int l_rangeCount = count / c_minItemsPerThread;
+    if (l_rangeCount > (int)m_workers.size() + 1)
+    {
+        l_rangeCount = m_workers.size() + 1;
+    }
+
+    if (l_rangeCount < 2)
+    {
+        task->Execute(0, count);
+        return;
+    }
+
+    // Range 0 runs here, range i on worker i - 1. Workers past the last
+    // range stay parked.
+    for (int i = 1; i < l_rangeCount; i++)
+    {
+        Worker* l_worker = m_workers[i - 1];
+        l_worker->m_task = task;
+        l_worker->m_begin = (count * i) / l_rangeCount;
+        l_worker->m_end = (count * (i + 1)) / l_rangeCount;
+        l_worker->Start();
+    }
+
+    task->Execute(0, count / l_rangeCount);
+
+    for (int i = 1; i < l_rangeCount; i++)
+    {
+        m_workers[i - 1]->Wait();
+        m_workers[i - 1]->m_task = NULL;
+    }
+}
+
+TaskScheduler::Worker::Worker()
+    : m_held(0)
+    , m_ready(false)
+    , m_task(NULL)
+    , m_begin(0)
+    , m_end(0)
+    , m_quit(false)
+{
+}
+
+void TaskScheduler::Worker::Start()
+{
+    m_gates[(m_held + 1) % 3].unlock();
+}
+
+void TaskScheduler::Worker::Wait()
+{
+    m_gates[m_held].lock();
+    m_held = (m_held + 1) % 3;
+}
+
+void TaskScheduler::Worker::Run()
+{
+    int l_held = 0;
+    m_gates[l_held].lock();
+    {
+        sf::Lock l_lock(m_readyMutex);
+        m_ready = true;
+    }
+
+    for (;;)
+    {
+        int l_next = (l_held + 1) % 3;
+
+        // Parked here until the scheduler opens the gate.
+        m_gates[l_next].lock();
+
+        if (m_quit)
+        {
+            m_gates[l_next].unlock();
+            m_gates[l_held].unlock();
+            return;
+        }
+
+        m_task->Execute(m_begin, m_end);
+
+        // Hands the held gate to the scheduler's Wait.
+        m_gates[l_held].unlock();
+        l_held = l_next;
+    }
+}